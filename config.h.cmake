@@ -92,6 +92,9 @@
 /* Build in libreadline */
 #cmakedefine WITH_GNU_READLINE 1
 
+/* Use the built-in deflate code of ziptool instead of zlib */
+#cmakedefine WITH_INTERNAL_DEFLATE 1
+
 /* Define to 1 if your processor stores words with the most significant byte
    first (like Motorola and SPARC, unlike Intel and VAX). */
 #cmakedefine WORDS_BIGENDIAN 1
@@ -10,6 +10,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include <2geom/circle.h>
@@ -23,6 +25,7 @@
 #include "page-manager.h"
 #include "preferences.h"
 #include "snap-enums.h"
+#include "snap-target-index.h"
 
 #include "object/sp-page.h"
 #include "object/sp-path.h"
@@ -33,6 +36,7 @@ Inkscape::AlignmentSnapper::AlignmentSnapper(SnapManager *sm, Geom::Coord const
     : Snapper(sm, d)
 {
     _points_to_snap_to = std::make_unique<std::vector<Inkscape::SnapCandidatePoint>>();
+    _point_index = std::make_unique<SnapTargetIndex>();
 }
 
 Inkscape::AlignmentSnapper::~AlignmentSnapper()
@@ -107,6 +111,11 @@ void Inkscape::AlignmentSnapper::_collectBBoxPoints(bool const &first_point) con
         }
     }
 
+    _point_index->clear(2 * getSnapperTolerance());
+    for (auto const &k : *_points_to_snap_to) {
+        _point_index->insert(k.getPoint());
+    }
+
     // Debug log
     //std::cout<<"----------"<<std::endl;
     //for (auto point : *_points_to_snap_to)
@@ -122,13 +131,6 @@ void Inkscape::AlignmentSnapper::_snapBBoxPoints(IntermSnapResults &isr,
 
     _collectBBoxPoints(p.getSourceNum() <= 0);
 
-    if (unselected_nodes != nullptr &&
-        unselected_nodes->size() > 0 &&
-        _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_ALIGNMENT_HANDLE)) {
-        g_assert(_points_to_snap_to != nullptr);
-        _points_to_snap_to->insert(_points_to_snap_to->end(), unselected_nodes->begin(), unselected_nodes->end());
-    }
-
     SnappedPoint sx;
     SnappedPoint sy;
     SnappedPoint si;
@@ -141,7 +143,7 @@ void Inkscape::AlignmentSnapper::_snapBBoxPoints(IntermSnapResults &isr,
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
     bool always = getSnapperAlwaysSnap(p.getSourceType());
 
-    for (const auto & k : *_points_to_snap_to) {
+    auto snap_to = [&] (SnapCandidatePoint const &k) {
         if (_allowSourceToSnapToTarget(p.getSourceType(), k.getTargetType(), strict_snapping)) {
             Geom::Point target_pt = k.getPoint();
             // (unconstrained) distance from HORIZONTAL guide 
@@ -211,6 +213,26 @@ void Inkscape::AlignmentSnapper::_snapBBoxPoints(IntermSnapResults &isr,
                 }
             }
         }
+    };
+
+    // Only points within tolerance of the horizontal or vertical line through p can be snapped to
+    auto const inf = std::numeric_limits<Geom::Coord>::infinity();
+    auto const tol = getSnapperTolerance();
+    auto ids = _point_index->query(Geom::Rect(-inf, p.getPoint().y() - tol, inf, p.getPoint().y() + tol));
+    auto const ids_y = _point_index->query(Geom::Rect(p.getPoint().x() - tol, -inf, p.getPoint().x() + tol, inf));
+    auto const mid = ids.size();
+    ids.insert(ids.end(), ids_y.begin(), ids_y.end());
+    std::inplace_merge(ids.begin(), ids.begin() + mid, ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    for (auto i : ids) {
+        snap_to((*_points_to_snap_to)[i]);
+    }
+
+    if (unselected_nodes != nullptr && _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_ALIGNMENT_HANDLE)) {
+        for (auto const &k : *unselected_nodes) {
+            snap_to(k);
+        }
     }
 
     if (intersection) {
@@ -27,6 +27,8 @@ class SPDesktop;
 namespace Inkscape
 {
 
+class SnapTargetIndex;
+
 /**
  * Snapping things to on-canvas alignment guides
  */
@@ -64,6 +66,7 @@ public:
 
 private:
     std::unique_ptr<std::vector<SnapCandidatePoint>> _points_to_snap_to;
+    std::unique_ptr<SnapTargetIndex> _point_index; ///< Spatial index over _points_to_snap_to.
 
     /** Collects and caches points on bounding boxes of the candidates
      * @param is the point first point in the selection?
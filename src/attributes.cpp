@@ -10,12 +10,14 @@
  */
 
 #include "attributes.h"
-#include <cstring>
-#include <map>
 
 #include <algorithm>
+#include <array>
+#include <string_view>
 #include <glib.h> // g_assert()
 
+#include "util/perfect-hash.h"
+
 
 struct SPStyleProp {
     SPAttr code;
@@ -26,7 +28,7 @@ struct SPStyleProp {
  * Lookup dictionary for attributes/properties.
  */
 
-static SPStyleProp const props[] = {
+static constexpr SPStyleProp props[] = {
     {SPAttr::INVALID, nullptr},
     /* SPObject */
     {SPAttr::ID, "id"},
@@ -602,44 +604,109 @@ static SPStyleProp const props[] = {
 static_assert(n_attrs == (int)SPAttr::SPAttr_SIZE, "");
 
 /**
- * Inverse to the \c props array for lookup by name.
+ * Inverse to the \c props array for lookup by name: the attribute names, followed by aliases.
  */
-class AttributeLookupImpl {
-    friend SPAttr sp_attribute_lookup(gchar const *key);
+static constexpr std::size_t n_keys = n_attrs; // props[1..n_attrs-1], plus "href"
 
-    struct cstrless {
-        bool operator()(char const *lhs, char const *rhs) const { return std::strcmp(lhs, rhs) < 0; }
-    };
+static constexpr std::array<std::string_view, n_keys> attribute_keys()
+{
+    std::array<std::string_view, n_keys> keys{};
+    for (std::size_t i = 1; i < n_attrs; i++) {
+        keys[i - 1] = props[i].name;
+    }
+    // SVG 2.0 alias for xlink:href
+    keys[n_keys - 1] = "href";
+    return keys;
+}
 
-    std::map<char const *, SPAttr, cstrless> m_map;
+static constexpr SPAttr attribute_key_code(std::size_t index)
+{
+    return index + 1 < n_attrs ? props[index + 1].code : SPAttr::XLINK_HREF;
+}
+
+static constexpr auto attribute_hash = Inkscape::Util::PerfectHash<n_keys>(attribute_keys());
 
-    AttributeLookupImpl()
+static_assert(attribute_hash.find("id") >= 0 && attribute_key_code(attribute_hash.find("id")) == SPAttr::ID);
+static_assert(attribute_key_code(attribute_hash.find("href")) == SPAttr::XLINK_HREF);
+static_assert(attribute_hash.find("no-such-attribute") == -1);
+
+/**
+ * Quark-indexed side table, so that attributes already interned by the XML layer can be
+ * resolved without going back through their string form or the global quark lock.
+ *
+ * All attribute names are interned when the table is built. A quark created later cannot be
+ * an attribute name, so it either lies beyond the end of the table or maps to INVALID.
+ */
+class AttributeQuarkTable
+{
+public:
+    static AttributeQuarkTable const &get()
+    {
+        static AttributeQuarkTable const instance;
+        return instance;
+    }
+
+    SPAttr lookup(GQuark key) const
     {
-        for (unsigned int i = 1; i < n_attrs; i++) {
+        return key < _codes.size() ? _codes[key] : SPAttr::INVALID;
+    }
+
+    GQuark quark(SPAttr id) const { return _quarks[(int)id]; }
+
+private:
+    std::vector<SPAttr> _codes;
+    std::array<GQuark, n_attrs> _quarks{};
+
+    AttributeQuarkTable()
+    {
+        std::array<GQuark, n_keys> key_quarks;
+        GQuark max = 0;
+        for (std::size_t i = 0; i < n_keys; i++) {
+            key_quarks[i] = g_quark_from_static_string(attribute_keys()[i].data());
+            max = std::max(max, key_quarks[i]);
+        }
+
+        _codes.resize(max + 1, SPAttr::INVALID);
+        for (std::size_t i = 0; i < n_keys; i++) {
+            _codes[key_quarks[i]] = attribute_key_code(i);
+        }
+        for (std::size_t i = 1; i < n_attrs; i++) {
             // sanity check: order of props array must match SPAttr
             g_assert( (int)(props[i].code) == i);
 
-            m_map[props[i].name] = props[i].code;
+            _quarks[i] = key_quarks[i - 1];
         }
-
-        // SVG 2.0 alias for xlink:href
-        m_map["href"] = SPAttr::XLINK_HREF;
     }
 };
 
 SPAttr
 sp_attribute_lookup(gchar const *key)
 {
-    static AttributeLookupImpl const _instance;
-    auto it = _instance.m_map.find(key);
-    if (it != _instance.m_map.end()) {
-        return it->second;
+    if (!key) {
+        return SPAttr::INVALID;
+    }
+    int const index = attribute_hash.find(key);
+    if (index >= 0) {
+        return attribute_key_code(index);
     }
     // std::cerr << "sp_attribute_lookup: invalid attribute: "
     //           << (key?key:"Null") << std::endl;
     return SPAttr::INVALID;
 }
 
+SPAttr
+sp_attribute_lookup(GQuark key)
+{
+    return AttributeQuarkTable::get().lookup(key);
+}
+
+GQuark
+sp_attribute_quark(SPAttr id)
+{
+    g_assert((int)id < n_attrs);
+    return AttributeQuarkTable::get().quark(id);
+}
+
 gchar const *
 sp_attribute_name(SPAttr id)
 {
@@ -613,6 +613,17 @@ bool SP_ATTRIBUTE_IS_CSS(SPAttr k);
  */
 SPAttr sp_attribute_lookup(gchar const *key);
 
+/**
+ * Get attribute id by interned name. Return INVALID for quarks that are not attribute names.
+ * Unlike the string version, this never hashes the name or takes the global quark lock.
+ */
+SPAttr sp_attribute_lookup(GQuark key);
+
+/**
+ * Get the interned name of an attribute id. Return 0 for INVALID.
+ */
+GQuark sp_attribute_quark(SPAttr id);
+
 /**
  * Get attribute name by id. Return NULL for invalid ids.
  */
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::ArenaHeap - heap statistics for document arenas
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DEBUG_ARENA_HEAP_H
+#define SEEN_INKSCAPE_DEBUG_ARENA_HEAP_H
+
+#include "inkgc/gc-arena.h"
+#include "debug/heap.h"
+
+namespace Inkscape {
+namespace Debug {
+
+/**
+ * Memory held by GC::Arena instances, e.g. XML documents opened with
+ * /options/document/arena enabled. This memory is also part of the libgc heap.
+ */
+class ArenaHeap : public Debug::Heap {
+public:
+    int features() const override {
+        return SIZE_AVAILABLE | USED_AVAILABLE | GARBAGE_COLLECTED;
+    }
+    char const *name() const override {
+        return "document arenas";
+    }
+    Heap::Stats stats() const override {
+        auto const totals = GC::Arena::total_stats();
+        Stats stats;
+        stats.size = totals.size;
+        stats.bytes_used = totals.bytes_used;
+        return stats;
+    }
+    void force_collect() override { GC::Core::gcollect(); }
+};
+
+}
+}
+
+#endif
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -11,6 +11,7 @@
  */
 
 #include "inkgc/gc-alloc.h"
+#include "debug/arena-heap.h"
 #include "debug/gc-heap.h"
 #include "debug/sysv-heap.h"
 #include <vector>
@@ -28,6 +29,7 @@ HeapCollection &heaps() {
     if (!is_initialized) {
         heaps.push_back(new SysVHeap());
         heaps.push_back(new GCHeap());
+        heaps.push_back(new ArenaHeap());
         is_initialized = true;
     }
     return heaps;
@@ -16,6 +16,7 @@
 #include "drawing-surface.h"
 #include "drawing-text.h"
 #include "drawing.h"
+#include "pick-index.h"
 #include "style.h"
 
 namespace Inkscape {
@@ -23,6 +24,8 @@ namespace Inkscape {
 DrawingGroup::DrawingGroup(Drawing &drawing)
     : DrawingItem(drawing) {}
 
+DrawingGroup::~DrawingGroup() = default;
+
 /**
  * Set whether the group returns children from pick calls.
  * Previously this feature was called "transparent groups".
@@ -62,6 +65,9 @@ unsigned DrawingGroup::_updateItem(Geom::IntRect const &area, UpdateContext cons
 
     _bbox = {};
 
+    // The children's boxes are about to change.
+    _dropPickIndex();
+
     for (auto &c : _children) {
         c.update(area, child_ctx, flags, reset);
         if (c.visible()) {
@@ -106,8 +112,43 @@ void DrawingGroup::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     }
 }
 
+void DrawingGroup::_dropPickIndex()
+{
+    _pick_index.reset();
+    _pick_index_children.clear();
+    _picks_since_update = 0;
+}
+
+void DrawingGroup::_buildPickIndex()
+{
+    std::vector<Geom::OptRect> boxes;
+    boxes.reserve(_children.size());
+    _pick_index_children.reserve(_children.size());
+    for (auto &c : _children) {
+        boxes.emplace_back(c.pickBounds());
+        _pick_index_children.emplace_back(&c);
+    }
+    _pick_index = std::make_unique<PickIndex>(boxes);
+}
+
 DrawingItem *DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigned flags)
 {
+    // Index large groups, but only once they are picked from more than once between updates;
+    // building the index costs a few linear searches.
+    if (!_pick_index && _children.size() >= PickIndex::MIN_ENTRIES && ++_picks_since_update > 1) {
+        _buildPickIndex();
+    }
+
+    if (_pick_index) {
+        // Candidates come in the same order as the children, so the same child wins.
+        for (auto i : _pick_index->query(p, delta)) {
+            if (auto picked = _pick_index_children[i]->pick(p, delta, flags)) {
+                return _pick_children ? picked : this;
+            }
+        }
+        return nullptr;
+    }
+
     for (auto &i : _children) {
         DrawingItem *picked = i.pick(p, delta, flags);
         if (picked) {
@@ -17,6 +17,8 @@
 
 namespace Inkscape {
 
+class PickIndex;
+
 class DrawingGroup
     : public DrawingItem
 {
@@ -30,15 +32,25 @@ public:
     void setChildTransform(Geom::Affine const &);
 
 protected:
-    ~DrawingGroup() override = default;
+    ~DrawingGroup() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
     void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
     bool _canClip() const override { return true; }
+    void _dropPickIndex() override;
 
     std::unique_ptr<Geom::Affine> _child_transform;
+
+private:
+    void _buildPickIndex();
+
+    // Spatial index over the children, for picking in large groups. Valid until the children or
+    // their boxes change.
+    std::unique_ptr<PickIndex> _pick_index;
+    std::vector<DrawingItem *> _pick_index_children;
+    unsigned _picks_since_update = 0;
 };
 
 } // namespace Inkscape
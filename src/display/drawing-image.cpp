@@ -10,6 +10,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <2geom/bezier-curve.h>
 
 #include "drawing.h"
@@ -17,6 +18,7 @@
 #include "drawing-image.h"
 #include "cairo-utils.h"
 #include "cairo-templates.h"
+#include "image-pyramid.h"
 
 namespace Inkscape {
 
@@ -26,10 +28,20 @@ DrawingImage::DrawingImage(Drawing &drawing)
 {
 }
 
+DrawingImage::~DrawingImage() = default;
+
 void DrawingImage::setPixbuf(std::shared_ptr<Inkscape::Pixbuf const> pixbuf)
 {
     defer([this, pixbuf = std::move(pixbuf)] () mutable {
+        _pyramid.reset();
         _pixbuf = std::move(pixbuf);
+        if (_pixbuf) {
+            auto const surface = const_cast<cairo_surface_t *>(_pixbuf->getSurfaceRaw());
+            auto const format = cairo_image_surface_get_format(surface);
+            if (format == CAIRO_FORMAT_ARGB32 || format == CAIRO_FORMAT_RGB24) {
+                _pyramid = std::make_unique<ImagePyramid>(surface);
+            }
+        }
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -116,10 +128,30 @@ unsigned DrawingImage::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
 
         dc.translate(_origin);
         dc.scale(_scale);
+
+        bool const smooth = style_image_rendering != SP_CSS_IMAGE_RENDERING_OPTIMIZESPEED &&
+                            style_image_rendering != SP_CSS_IMAGE_RENDERING_PIXELATED &&
+                            style_image_rendering != SP_CSS_IMAGE_RENDERING_CRISPEDGES;
+
         // const_cast required since Cairo needs to modify the internal refcount variable, but we do not want to give up the
         // benefits of const for the rest of our code. The underlying object is guaranteed to be non-const, so this is well-defined.
         // It is also thread-safe to modify the refcount in this way, since Cairo uses atomics internally.
-        dc.setSource(const_cast<cairo_surface_t*>(_pixbuf->getSurfaceRaw()), 0, 0);
+        auto source = const_cast<cairo_surface_t*>(_pixbuf->getSurfaceRaw());
+
+        // When zoomed out, draw from a reduced copy instead of resampling the whole bitmap.
+        if (smooth && _pyramid) {
+            cairo_matrix_t cm;
+            cairo_get_matrix(dc.raw(), &cm);
+            Geom::Affine device;
+            ink_matrix_to_2geom(device, cm);
+            auto const [surface, level] = _pyramid->get(std::max(device.expansionX(), device.expansionY()));
+            if (level > 0) {
+                source = surface;
+                dc.scale(1 << level, 1 << level);
+            }
+        }
+
+        dc.setSource(source, 0, 0);
         dc.patternSetExtend(CAIRO_EXTEND_PAD);
 
         // See: http://www.w3.org/TR/SVG/painting.html#ImageRenderingProperty
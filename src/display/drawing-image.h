@@ -21,6 +21,7 @@
 #include "display/drawing-item.h"
 
 namespace Inkscape {
+class ImagePyramid;
 class Pixbuf;
 
 class DrawingImage
@@ -39,13 +40,14 @@ public:
     Geom::Rect bounds() const;
 
 protected:
-    ~DrawingImage() override = default;
+    ~DrawingImage() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
 
     std::shared_ptr<Inkscape::Pixbuf const> _pixbuf;
+    std::unique_ptr<ImagePyramid> _pyramid; ///< reduced copies of _pixbuf for zoomed out views
 
     SPImageRendering style_image_rendering;
 
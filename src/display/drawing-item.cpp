@@ -148,6 +148,7 @@ void DrawingItem::appendChild(DrawingItem *item)
 
     defer([=, this] {
         _children.push_back(*item);
+        _dropPickIndex();
 
         // This ensures that _markForUpdate() called on the child will recurse to this item
         item->_state = STATE_ALL;
@@ -168,6 +169,7 @@ void DrawingItem::prependChild(DrawingItem *item)
 
     defer([=, this] {
         _children.push_front(*item);
+        _dropPickIndex();
         item->_state = STATE_ALL;
         item->_markForUpdate(STATE_ALL, true);
     });
@@ -180,6 +182,7 @@ void DrawingItem::clearChildren()
         if (_children.empty()) return;
         _markForRendering();
         _children.clear_and_dispose([] (auto c) { delete c; });
+        _dropPickIndex();
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -414,6 +417,7 @@ void DrawingItem::setZOrder(unsigned zorder)
         auto it2 = _parent->_children.begin();
         std::advance(it2, std::min<unsigned>(zorder, _parent->_children.size()));
         _parent->_children.insert(it2, *this);
+        _parent->_dropPickIndex();
         _markForRendering();
     });
 }
@@ -1038,6 +1042,23 @@ DrawingItem *DrawingItem::pick(Geom::Point const &p, double delta, unsigned flag
 
     bool outline = flags & PICK_OUTLINE;
 
+    // Check the box first: it rejects most items, and is much cheaper than picking the clip or mask.
+    Geom::OptIntRect box = outline || (flags & PICK_AS_CLIP) ? _bbox : _drawbox;
+    if (!box) {
+        return nullptr;
+    }
+
+    Geom::Rect expanded = *box;
+    expanded.expandBy(delta);
+    auto dglyps = cast<DrawingGlyphs>(this);
+    if (dglyps && !(flags & PICK_AS_CLIP)) {
+        expanded = dglyps->getPickBox();
+    }
+
+    if (!expanded.contains(p)) {
+        return nullptr;
+    }
+
     if (!outline) {
         // pick inside clipping path; if NULL, it means the object is clipped away there
         if (_clip) {
@@ -1055,22 +1076,30 @@ DrawingItem *DrawingItem::pick(Geom::Point const &p, double delta, unsigned flag
         }
     }
 
-    Geom::OptIntRect box = outline || (flags & PICK_AS_CLIP) ? _bbox : _drawbox;
-    if (!box) {
-        return nullptr;
-    }
+    return _pickItem(p, delta, flags);
+}
 
-    Geom::Rect expanded = *box;
-    expanded.expandBy(delta);
-    auto dglyps = cast<DrawingGlyphs>(this);
-    if (dglyps && !(flags & PICK_AS_CLIP)) {
-        expanded = dglyps->getPickBox();
+/**
+ * Return the area outside which pick() finds nothing, whatever the flags, before expanding it by
+ * the tolerance. Empty if the item cannot be picked at all in its current state.
+ */
+Geom::OptRect DrawingItem::pickBounds() const
+{
+    if (!(_state & STATE_BBOX) || !(_state & STATE_PICK)) {
+        return {};
     }
 
-    if (expanded.contains(p)) {
-        return _pickItem(p, delta, flags);
+    Geom::OptRect result;
+    if (_bbox) {
+        result.unionWith(Geom::Rect(*_bbox));
+    }
+    if (_drawbox) {
+        result.unionWith(Geom::Rect(*_drawbox));
     }
-    return nullptr;
+    if (auto dglyphs = cast<DrawingGlyphs>(this); dglyphs && result) {
+        result.unionWith(Geom::Rect(dglyphs->getPickBox()));
+    }
+    return result;
 }
 
 // For debugging
@@ -1169,6 +1198,8 @@ void DrawingItem::_invalidateFilterBackground(Geom::IntRect const &area)
  */
 void DrawingItem::_markForUpdate(unsigned flags, bool propagate)
 {
+    _dropPickIndex();
+
     if (propagate) {
         _propagate_state |= flags;
     }
@@ -1286,6 +1317,7 @@ void DrawingItem::unlink()
             case ChildType::NORMAL: {
                 auto it = _parent->_children.iterator_to(*this);
                 _parent->_children.erase(it);
+                _parent->_dropPickIndex();
                 break;
             }
             case ChildType::CLIP:
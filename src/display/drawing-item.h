@@ -161,6 +161,7 @@ public:
     unsigned render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0) const;
     void clip(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const;
     DrawingItem *pick(Geom::Point const &p, double delta, unsigned flags = 0);
+    Geom::OptRect pickBounds() const;
 
     Glib::ustring name() const; // For debugging
     void recursivePrintTree(unsigned level = 0) const;  // For debugging
@@ -195,6 +196,7 @@ protected:
     virtual DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) { return nullptr; }
     virtual bool _canClip() const { return false; }
     virtual void _dropPatternCache() {}
+    virtual void _dropPickIndex() {} ///< Called when the children or their boxes may change.
 
     Drawing &_drawing;
     DrawingItem *_parent;
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Reduced copies of a bitmap for drawing it zoomed out.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "image-pyramid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace Inkscape {
+
+namespace {
+
+std::atomic<std::size_t> total_bytes{0};
+
+} // namespace
+
+ImagePyramid::ImagePyramid(cairo_surface_t *base)
+{
+    _levels.push_back(cairo_surface_reference(base));
+}
+
+ImagePyramid::~ImagePyramid()
+{
+    for (auto s : _levels) {
+        cairo_surface_destroy(s);
+    }
+    total_bytes -= _bytes;
+}
+
+int ImagePyramid::level_for_scale(double scale)
+{
+    if (!(scale > 0.0) || scale > 0.5) {
+        return 0;
+    }
+    return std::min((int)std::floor(-std::log2(scale)), 30);
+}
+
+std::pair<cairo_surface_t *, int> ImagePyramid::get(double scale)
+{
+    int const wanted = level_for_scale(scale);
+
+    auto lock = std::lock_guard(_mutex);
+
+    while ((int)_levels.size() <= wanted) {
+        auto last = _levels.back();
+        if (cairo_image_surface_get_width(last) == 1 && cairo_image_surface_get_height(last) == 1) {
+            break;
+        }
+
+        // Reserve the memory before building the level, so that concurrent pyramids can't
+        // overshoot the budget together.
+        int const w = (cairo_image_surface_get_width(last) + 1) / 2;
+        int const h = (cairo_image_surface_get_height(last) + 1) / 2;
+        auto const bytes = (std::size_t)cairo_format_stride_for_width(cairo_image_surface_get_format(last), w) * h;
+        if (total_bytes.fetch_add(bytes) + bytes > BUDGET) {
+            total_bytes -= bytes;
+            break;
+        }
+
+        auto level = downsample(last);
+        if (cairo_surface_status(level) != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(level);
+            total_bytes -= bytes;
+            break;
+        }
+        _bytes += bytes;
+        _levels.push_back(level);
+    }
+
+    int const level = std::min(wanted, (int)_levels.size() - 1);
+    return {_levels[level], level};
+}
+
+cairo_surface_t *ImagePyramid::downsample(cairo_surface_t *src)
+{
+    cairo_surface_flush(src);
+
+    int const sw = cairo_image_surface_get_width(src);
+    int const sh = cairo_image_surface_get_height(src);
+    int const sstride = cairo_image_surface_get_stride(src);
+    auto const format = cairo_image_surface_get_format(src);
+    int const w = (sw + 1) / 2;
+    int const h = (sh + 1) / 2;
+
+    auto dst = cairo_image_surface_create(format, w, h);
+    if (cairo_surface_status(dst) != CAIRO_STATUS_SUCCESS) {
+        return dst;
+    }
+    int const dstride = cairo_image_surface_get_stride(dst);
+    auto const sdata = cairo_image_surface_get_data(src);
+    auto const ddata = cairo_image_surface_get_data(dst);
+
+    // The last row and column of an odd-sized image are paired with themselves, which is what
+    // CAIRO_EXTEND_PAD would show beyond the edge anyway. Averaging the channels of
+    // premultiplied pixels separately gives a valid premultiplied pixel.
+    for (int y = 0; y < h; y++) {
+        auto const row0 = reinterpret_cast<std::uint32_t const *>(sdata + 2 * y * sstride);
+        auto const row1 = reinterpret_cast<std::uint32_t const *>(sdata + std::min(2 * y + 1, sh - 1) * sstride);
+        auto const out = reinterpret_cast<std::uint32_t *>(ddata + y * dstride);
+        for (int x = 0; x < w; x++) {
+            int const x0 = 2 * x;
+            int const x1 = std::min(x0 + 1, sw - 1);
+            std::uint32_t const px[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+            std::uint32_t result = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                std::uint32_t sum = 2;
+                for (auto p : px) {
+                    sum += (p >> shift) & 0xff;
+                }
+                result |= (sum >> 2) << shift;
+            }
+            out[x] = result;
+        }
+    }
+
+    cairo_surface_mark_dirty(dst);
+    return dst;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Reduced copies of a bitmap for drawing it zoomed out.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_IMAGE_PYRAMID_H
+#define INKSCAPE_DISPLAY_IMAGE_PYRAMID_H
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cairo.h>
+
+namespace Inkscape {
+
+/**
+ * A mip pyramid for an image surface: level n is the image reduced by a factor of 2^n in
+ * each direction. Drawing a large bitmap at a small scale from the nearest level instead of the
+ * full-resolution surface keeps the resampling cost proportional to the size on screen.
+ *
+ * Levels are built on first use, each from the one above it, and are kept until the pyramid is
+ * destroyed. All pyramids together hold at most BUDGET bytes; once that is used up, requests
+ * are served from the deepest level that already exists.
+ *
+ * get() may be called from several rendering threads at once.
+ */
+class ImagePyramid
+{
+public:
+    /// Memory shared by the levels of all pyramids, in bytes.
+    static constexpr std::size_t BUDGET = 256 << 20;
+
+    /// Create an empty pyramid for @a base, which must be an ARGB32 or RGB24 image surface.
+    explicit ImagePyramid(cairo_surface_t *base);
+    ~ImagePyramid();
+    ImagePyramid(ImagePyramid const &) = delete;
+    ImagePyramid &operator=(ImagePyramid const &) = delete;
+
+    /**
+     * Return the surface to draw from at @a scale device pixels per image pixel, together with
+     * its level. The surface belongs to the pyramid.
+     */
+    std::pair<cairo_surface_t *, int> get(double scale);
+
+    /// The level whose resolution is just above @a scale; 0 unless @a scale is at most 1/2.
+    static int level_for_scale(double scale);
+
+    /// Halve @a src in both directions by averaging 2x2 blocks, rounding odd sizes up.
+    static cairo_surface_t *downsample(cairo_surface_t *src);
+
+private:
+    std::mutex _mutex;
+    std::vector<cairo_surface_t *> _levels; ///< level 0 is the base surface
+    std::size_t _bytes = 0;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_IMAGE_PYRAMID_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding box index used to narrow down pick candidates.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "pick-index.h"
+
+#include <algorithm>
+#include <iterator>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace Inkscape {
+
+namespace {
+
+using BoxPoint = bg::model::point<double, 2, bg::cs::cartesian>;
+using Box = bg::model::box<BoxPoint>;
+using Value = std::pair<Box, unsigned>;
+
+Box to_box(Geom::Rect const &rect)
+{
+    return { { rect.left(), rect.top() }, { rect.right(), rect.bottom() } };
+}
+
+} // namespace
+
+struct PickIndex::Tree
+{
+    // Constructing from a range uses the packing algorithm, which gives a better tree than
+    // inserting the entries one by one.
+    template <typename Range>
+    explicit Tree(Range const &values) : rtree(values) {}
+
+    bgi::rtree<Value, bgi::quadratic<16>> rtree;
+};
+
+PickIndex::PickIndex(std::vector<Geom::OptRect> const &boxes)
+{
+    std::vector<Value> values;
+    values.reserve(boxes.size());
+    for (unsigned i = 0; i < boxes.size(); i++) {
+        if (boxes[i]) {
+            values.emplace_back(to_box(*boxes[i]), i);
+        }
+    }
+    _tree = std::make_unique<Tree>(values);
+}
+
+PickIndex::~PickIndex() = default;
+
+std::vector<unsigned> PickIndex::query(Geom::Rect const &area) const
+{
+    std::vector<Value> hits;
+    _tree->rtree.query(bgi::intersects(to_box(area)), std::back_inserter(hits));
+
+    std::vector<unsigned> result;
+    result.reserve(hits.size());
+    for (auto const &hit : hits) {
+        result.push_back(hit.second);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<unsigned> PickIndex::query(Geom::Point const &p, double delta) const
+{
+    auto area = Geom::Rect(p, p);
+    area.expandBy(delta);
+    return query(area);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding box index used to narrow down pick candidates.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_PICK_INDEX_H
+#define INKSCAPE_DISPLAY_PICK_INDEX_H
+
+#include <memory>
+#include <vector>
+#include <2geom/point.h>
+#include <2geom/rect.h>
+
+namespace Inkscape {
+
+/**
+ * A static R-tree over a list of bounding boxes, built in one go from the whole list.
+ *
+ * Entries are numbered by their position in the list given to the constructor. Queries return
+ * these numbers in increasing order, so that a caller looking for the first item in z-order that
+ * passes some test can check the candidates in the same order as it would check all items.
+ * Empty boxes are left out.
+ */
+class PickIndex
+{
+public:
+    /// Don't bother with an index for fewer entries than this; a linear search is as fast.
+    static constexpr unsigned MIN_ENTRIES = 64;
+
+    explicit PickIndex(std::vector<Geom::OptRect> const &boxes);
+    ~PickIndex();
+    PickIndex(PickIndex const &) = delete;
+    PickIndex &operator=(PickIndex const &) = delete;
+
+    /// Return, in increasing order, the numbers of the entries whose boxes intersect @a area.
+    std::vector<unsigned> query(Geom::Rect const &area) const;
+    /// Return the entries whose boxes come within @a delta of @a p.
+    std::vector<unsigned> query(Geom::Point const &p, double delta) const;
+
+private:
+    struct Tree;
+    std::unique_ptr<Tree> _tree;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_PICK_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
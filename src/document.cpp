@@ -71,6 +71,7 @@
 #include "actions/actions-undo-document.h"
 #include "display/control/canvas-item-drawing.h"
 #include "display/drawing.h"
+#include "display/pick-index.h"
 #include "io/dir-util.h"
 #include "live_effects/lpeobject.h"
 #include "object/persp3d.h"
@@ -88,6 +89,7 @@
 #include "xml/croco-node-iface.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/simple-document.h"
+#include "xml/sync-tree.h"
 
 using Inkscape::DocumentUndo;
 using Inkscape::Util::UnitTable;
@@ -402,8 +404,7 @@ SPDocument *SPDocument::createDoc(Inkscape::XML::Document *rdoc,
     document->document_name = g_strdup(document_name);
 
     // Create SPRoot element
-    const std::string typeString = NodeTraits::get_type_string(*rroot);
-    SPObject* rootObj = SPFactory::createObject(typeString);
+    SPObject* rootObj = SPFactory::createObject(*rroot);
     document->root = cast<SPRoot>(rootObj);
 
     if (document->root == nullptr) {
@@ -523,7 +524,7 @@ SPDocument *SPDocument::createDoc(Inkscape::XML::Document *rdoc,
 std::unique_ptr<SPDocument> SPDocument::copy() const
 {
     // New SimpleDocument object where we will put all the same data
-    Inkscape::XML::Document *new_rdoc = new Inkscape::XML::SimpleDocument();
+    Inkscape::XML::Document *new_rdoc = new Inkscape::XML::SimpleDocument(rdoc->arena() != nullptr);
 
     // Duplicate the svg root node AND any PI and COMMENT nodes, this should be put
     // into xml/simple-document.h at some point to fix it's duplicate implementation.
@@ -571,10 +572,11 @@ void SPDocument::rebase(const gchar * file, bool keep_namedview)
             document and repinserts them into an emptied old document.
     \param  new_xmldoc  The root node to inject into.
 
-    This function first deletes all the root attributes in the old document followed
-    by copying all the root attributes from the new document to the old document.    
+    This function brings the children of the root in line with those of the new
+    XML::Document, changing only what differs unless most of it does; in that case it
+    deletes them all and copies in the new ones. Then it copies all the root attributes
+    from the new document to the old document.
 
-    Then, it copies all the element in the new XML::Document into the root of document.
     keep a diferent approach for namedview to not erase it and merge new value
 */
 void SPDocument::rebase(Inkscape::XML::Document * new_xmldoc, bool keep_namedview)
@@ -586,25 +588,51 @@ void SPDocument::rebase(Inkscape::XML::Document * new_xmldoc, bool keep_namedvie
     }
     emitReconstructionStart();
     Inkscape::XML::Document * origin_xmldoc = getReprDoc();
+    Inkscape::XML::Node *root = origin_xmldoc->root();
+
+    auto const is_kept_namedview = [=] (Inkscape::XML::Node const &node) {
+        return keep_namedview && !g_strcmp0(node.name(), "sodipodi:namedview");
+    };
+
+    // An extension usually changes only a small part of the document, so apply just the
+    // differences: unchanged objects, their display items and the undo history stay as they are.
+    // When the differences add up to a good part of the document, replacing it all is cheaper.
+    auto const max_changes = Inkscape::XML::count_nodes(*new_xmldoc->root()) / 2;
+    if (!Inkscape::XML::sync_children(*root, *new_xmldoc->root(), max_changes, is_kept_namedview)) {
+        for ( Inkscape::XML::Node *child = root->lastChild() ; child != nullptr ;)
+        {
+            Inkscape::XML::Node *prevchild = child->prev();
+            if (!is_kept_namedview(*child)) {
+                root->removeChild(child);
+            }
+            child = prevchild;
+        }
+        for ( Inkscape::XML::Node *child = new_xmldoc->root()->firstChild() ; child != nullptr ; child = child->next() )
+        {
+            if (!is_kept_namedview(*child)) {
+                Inkscape::XML::Node *new_child = child->duplicate(origin_xmldoc);
+                root->appendChild(new_child);
+                Inkscape::GC::release(new_child);
+            }
+        }
+    }
+
     Inkscape::XML::Node *namedview = nullptr;
-    for ( Inkscape::XML::Node *child = origin_xmldoc->root()->lastChild() ; child != nullptr ;)
-    {
-        Inkscape::XML::Node *prevchild = child->prev();
-        if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
+    for (auto child = root->firstChild(); child && !namedview; child = child->next()) {
+        if (is_kept_namedview(*child)) {
             namedview = child;
-        } else {
-            origin_xmldoc->root()->removeChild(child);
         }
-        child = prevchild;
     }
     for ( Inkscape::XML::Node *child = new_xmldoc->root()->firstChild() ; child != nullptr ; child = child->next() )
     {
-        if (!g_strcmp0(child->name(),"sodipodi:namedview") && keep_namedview) {
-            namedview->mergeFrom(child, "id", true, true);
-        } else {
-            Inkscape::XML::Node *new_child = child->duplicate(origin_xmldoc);
-            origin_xmldoc->root()->appendChild(new_child);
-            Inkscape::GC::release(new_child);
+        if (is_kept_namedview(*child)) {
+            if (namedview) {
+                namedview->mergeFrom(child, "id", true, true);
+            } else {
+                namedview = child->duplicate(origin_xmldoc);
+                root->appendChild(namedview);
+                Inkscape::GC::release(namedview);
+            }
         }
     }
     // Copy svg root attributes
@@ -685,7 +713,8 @@ SPDocument *SPDocument::createNewDoc(gchar const *filename, bool keepalive, bool
     if (filename) {
         Inkscape::XML::Node *rroot;
         /* Try to fetch repr from file */
-        rdoc = sp_repr_read_file(filename, SP_SVG_NS_URI);
+        bool const use_arena = Inkscape::Preferences::get()->getBool("/options/document/arena", false);
+        rdoc = sp_repr_read_file(filename, SP_SVG_NS_URI, false, use_arena);
         /* If file cannot be loaded, return NULL without warning */
         if (rdoc == nullptr) return nullptr;
         rroot = rdoc->root();
@@ -1671,7 +1700,8 @@ upwards in z-order and returns what it has found so far (i.e. the found items ar
 guaranteed to be lower than upto). Requires a list of nodes built by build_flat_item_list.
 If items_count > 0, it'll return the topmost (in z-order) items_count items.
  */
-static std::vector<SPItem*> find_items_at_point(std::deque<SPItem*> const &nodes, unsigned dkey,
+template <typename Nodes>
+static std::vector<SPItem*> find_items_at_point(Nodes const &nodes, unsigned dkey,
                                                 Geom::Point const &p, int items_count = 0, SPItem *upto = nullptr)
 {
     double const delta = Inkscape::Preferences::get()->getDouble("/options/cursortolerance/value", 1.0);
@@ -1793,14 +1823,39 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
         build_flat_item_list(key, this->root, true);
         _node_cache_valid=true;
     }
+
+    // For a long path over many items, first narrow down the items under each point by their
+    // bounding boxes. The candidates keep their order, so the result is the same.
+    std::unique_ptr<Inkscape::PickIndex> index;
+    if (points.size() > 1 && _node_cache.size() >= Inkscape::PickIndex::MIN_ENTRIES) {
+        std::vector<Geom::OptRect> boxes;
+        boxes.reserve(_node_cache.size());
+        for (auto node : _node_cache) {
+            auto di = node->get_arenaitem(key);
+            boxes.emplace_back(di ? di->pickBounds() : Geom::OptRect());
+        }
+        index = std::make_unique<Inkscape::PickIndex>(boxes);
+    }
+    double const delta = prefs->getDouble("/options/cursortolerance/value", 1.0);
+
     SPObject *current_layer = nullptr;
     SPDesktop *desktop = SP_ACTIVE_DESKTOP;
     if(desktop){
         current_layer = desktop->layerManager().currentLayer();
     }
     size_t item_counter = 0;
+    std::vector<SPItem*> candidates;
     for(auto point : points) {
-        std::vector<SPItem*> items = find_items_at_point(_node_cache, key, point, topmost_only);
+        std::vector<SPItem*> items;
+        if (index) {
+            candidates.clear();
+            for (auto i : index->query(point, delta)) {
+                candidates.push_back(_node_cache[i]);
+            }
+            items = find_items_at_point(candidates, key, point, topmost_only);
+        } else {
+            items = find_items_at_point(_node_cache, key, point, topmost_only);
+        }
         for (SPItem *item : items) {
             if (item && result.end()==find(result.begin(), result.end(), item))
                 if(all_layers || (desktop && desktop->layerManager().layerForObject(item) == current_layer)){
@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * A script extension process that is kept running between calls.
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "script-worker.h"
+
+#include <array>
+#include <charconv>
+#include <csignal>
+
+#include "helper/auto-connection.h"
+
+namespace Inkscape::Extension::Implementation {
+
+namespace {
+
+Glib::RefPtr<Glib::IOChannel> create_channel(int fd)
+{
+    auto channel = Glib::IOChannel::create_from_fd(fd);
+    channel->set_close_on_unref(true);
+    channel->set_encoding(); // binary
+    channel->set_buffered(false);
+    return channel;
+}
+
+void append_chunk(std::string &out, std::string const &data)
+{
+    out += std::to_string(data.size());
+    out += '\n';
+    out += data;
+}
+
+} // namespace
+
+ScriptWorker::ScriptWorker(std::vector<std::string> argv, std::string const &working_directory)
+{
+    argv.emplace_back("--worker");
+
+    int stdin_pipe, stdout_pipe, stderr_pipe;
+    Glib::spawn_async_with_pipes(working_directory, argv, static_cast<Glib::SpawnFlags>(0), {}, &_pid,
+                                 &stdin_pipe, &stdout_pipe, &stderr_pipe);
+
+    _stdin = create_channel(stdin_pipe);
+    _stdout = create_channel(stdout_pipe);
+    _stderr = create_channel(stderr_pipe);
+
+    try {
+        _stdin->set_flags(Glib::IO_FLAG_NONBLOCK);
+    } catch (Glib::IOChannelError const &) {
+        // Writes block then; the worker reads all of each request before answering anyway.
+    }
+
+    // Only the worker's pipes are polled while waiting for a reply, as in Script::execute().
+    _context = Glib::MainContext::create();
+    _main_loop = Glib::MainLoop::create(_context, false);
+}
+
+ScriptWorker::~ScriptWorker()
+{
+    // Closing its input tells the worker to exit.
+    _stdin.reset();
+    _stdout.reset();
+    _stderr.reset();
+    Glib::spawn_close_pid(_pid);
+}
+
+std::optional<ScriptWorker::Reply> ScriptWorker::call(std::vector<std::string> const &args, std::string const &document)
+{
+    _request_sent = false;
+    if (_broken) {
+        return {};
+    }
+    if (!_received.empty()) {
+        g_warning("ScriptWorker: extension worker sent more than it was asked for");
+        _broken = true;
+        return {};
+    }
+
+    std::string request = std::to_string(args.size()) + '\n';
+    for (auto const &arg : args) {
+        append_chunk(request, arg);
+    }
+    append_chunk(request, document);
+
+    _reply.reset();
+    _reply_errors.reset();
+
+#if !defined(_WIN32) && !defined(__WIN32__)
+    // A worker that has died must not take Inkscape down with it.
+    auto const old_handler = signal(SIGPIPE, SIG_IGN);
+#endif
+
+    // Write the request piecewise from the loop, so that the worker can never block on a full
+    // output pipe while we are still writing.
+    std::size_t written = 0;
+    auto const write_request = [&, this] (Glib::IOCondition condition) {
+        if (condition & (Glib::IO_HUP | Glib::IO_ERR)) {
+            _broken = true;
+            _main_loop->quit();
+            return false;
+        }
+        gsize count = 0;
+        auto status = Glib::IO_STATUS_ERROR;
+        try {
+            status = _stdin->write(request.data() + written, request.size() - written, count);
+        } catch (Glib::Error const &) {
+        }
+        if (status == Glib::IO_STATUS_ERROR) {
+            _broken = true;
+            _main_loop->quit();
+            return false;
+        }
+        written += count;
+        _request_sent |= written > 0;
+        return written < request.size();
+    };
+
+    auto io = _context->signal_io();
+    auto_connection out_conn = io.connect(write_request, _stdin, Glib::IO_OUT | Glib::IO_HUP | Glib::IO_ERR);
+    auto_connection in_conn = io.connect(sigc::mem_fun(*this, &ScriptWorker::_readStdout), _stdout, Glib::IO_IN | Glib::IO_HUP | Glib::IO_ERR);
+    auto_connection err_conn = io.connect(sigc::mem_fun(*this, &ScriptWorker::_readStderr), _stderr, Glib::IO_IN | Glib::IO_HUP | Glib::IO_ERR);
+
+    _main_loop->run();
+
+#if !defined(_WIN32) && !defined(__WIN32__)
+    signal(SIGPIPE, old_handler);
+#endif
+
+    if (_broken || !_reply || !_reply_errors) {
+        _broken = true;
+        return {};
+    }
+
+    auto reply = std::move(*_reply);
+    _reply.reset();
+    reply.messages += *_reply_errors;
+    _reply_errors.reset();
+    return reply;
+}
+
+void ScriptWorker::cancel()
+{
+    _broken = true;
+    _main_loop->quit();
+}
+
+bool ScriptWorker::_readStdout(Glib::IOCondition condition)
+{
+    if (condition & Glib::IO_IN) {
+        std::array<char, 65536> buffer;
+        gsize count = 0;
+        auto status = Glib::IO_STATUS_ERROR;
+        try {
+            status = _stdout->read(buffer.data(), buffer.size(), count);
+        } catch (Glib::Error const &) {
+        }
+        _received.append(buffer.data(), count);
+
+        _parseReply();
+        if ((_reply && _reply_errors) || _broken) {
+            _main_loop->quit();
+            return true;
+        }
+        if (status == Glib::IO_STATUS_NORMAL || status == Glib::IO_STATUS_AGAIN) {
+            return true;
+        }
+    }
+
+    // The worker has closed its output before answering.
+    _broken = true;
+    _main_loop->quit();
+    return false;
+}
+
+bool ScriptWorker::_readStderr(Glib::IOCondition condition)
+{
+    if (condition & Glib::IO_IN) {
+        std::array<char, 4096> buffer;
+        gsize count = 0;
+        auto status = Glib::IO_STATUS_ERROR;
+        try {
+            status = _stderr->read(buffer.data(), buffer.size(), count);
+        } catch (Glib::Error const &) {
+        }
+        _errors.append(buffer.data(), count);
+
+        _parseErrors();
+        if (_reply && _reply_errors) {
+            _main_loop->quit();
+            return true;
+        }
+        if (status == Glib::IO_STATUS_NORMAL || status == Glib::IO_STATUS_AGAIN) {
+            return true;
+        }
+    }
+
+    // The worker has closed its standard error before finishing its reply.
+    _broken = true;
+    _main_loop->quit();
+    return false;
+}
+
+/// Take what the worker wrote to stderr during this call off the front, once it is all there.
+void ScriptWorker::_parseErrors()
+{
+    if (_reply_errors) {
+        return;
+    }
+    auto const end = _errors.find('\0');
+    if (end == std::string::npos) {
+        return;
+    }
+    _reply_errors = _errors.substr(0, end);
+    _errors.erase(0, end + 1);
+}
+
+/// Take the reply off the front of the received data, if it is all there.
+void ScriptWorker::_parseReply()
+{
+    std::array<std::string, 2> chunks;
+    std::size_t pos = 0;
+
+    for (auto &chunk : chunks) {
+        auto const newline = _received.find('\n', pos);
+        if (newline == std::string::npos) {
+            return;
+        }
+
+        std::size_t length = 0;
+        auto const [end, error] = std::from_chars(_received.data() + pos, _received.data() + newline, length);
+        if (error != std::errc() || end != _received.data() + newline) {
+            g_warning("ScriptWorker: malformed reply from extension worker");
+            _broken = true;
+            return;
+        }
+
+        if (_received.size() - (newline + 1) < length) {
+            return;
+        }
+        chunk = _received.substr(newline + 1, length);
+        pos = newline + 1 + length;
+    }
+
+    _received.erase(0, pos);
+    _reply = Reply{ std::move(chunks[0]), std::move(chunks[1]) };
+}
+
+} // namespace Inkscape::Extension::Implementation
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8 :
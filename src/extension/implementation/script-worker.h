@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * A script extension process that is kept running between calls.
+ *
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_EXTENSION_IMPLEMENTATION_SCRIPT_WORKER_H_SEEN
+#define INKSCAPE_EXTENSION_IMPLEMENTATION_SCRIPT_WORKER_H_SEEN
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <glibmm/iochannel.h>
+#include <glibmm/main.h>
+#include <glibmm/refptr.h>
+#include <glibmm/spawn.h>
+
+namespace Inkscape::Extension::Implementation {
+
+/**
+ * A script extension that stays alive between calls, for extensions that opt in with
+ * worker="true" on their command element. This saves starting the interpreter and importing
+ * its libraries on every run, and in particular on every live preview update.
+ *
+ * The worker is started once, with the single argument "--worker" in place of the usual
+ * parameters and input file. All data is then exchanged as chunks: a byte count in decimal
+ * and a newline, followed by that many bytes.
+ *
+ * For each call, Inkscape writes to the worker's standard input the number of arguments on a
+ * line of its own, the arguments as chunks (the parameters a one-shot run gets on its command
+ * line, without the input file), and the input document as a chunk.
+ *
+ * The worker answers on its standard output with the output document as a chunk (empty if it
+ * leaves the document unchanged), followed by a chunk of messages for the user, which take the
+ * place of what a one-shot run writes to its standard error. It then writes a NUL byte to its
+ * standard error, so that what it wrote there during the call is shown with this reply and not
+ * with the next one.
+ *
+ * The worker should exit when its standard input is closed. testfiles/data/script-worker.py is
+ * a worker that shows the protocol.
+ */
+class ScriptWorker
+{
+public:
+    /// Start the worker. Throws Glib::SpawnError if it cannot be started.
+    ScriptWorker(std::vector<std::string> argv, std::string const &working_directory);
+    ~ScriptWorker();
+    ScriptWorker(ScriptWorker const &) = delete;
+    ScriptWorker &operator=(ScriptWorker const &) = delete;
+
+    struct Reply
+    {
+        std::string document;
+        std::string messages;
+    };
+
+    /**
+     * Run one call, waiting for the reply. Returns nothing if the worker exited, broke the
+     * protocol, or the call was cancelled; the worker cannot be used any more after that.
+     */
+    std::optional<Reply> call(std::vector<std::string> const &args, std::string const &document);
+
+    /// Whether any of the request of the last call reached the worker, which may have acted on it.
+    bool requestSent() const { return _request_sent; }
+
+    /// Abandon the call in progress.
+    void cancel();
+
+private:
+    Glib::Pid _pid;
+    Glib::RefPtr<Glib::IOChannel> _stdin;
+    Glib::RefPtr<Glib::IOChannel> _stdout;
+    Glib::RefPtr<Glib::IOChannel> _stderr;
+    Glib::RefPtr<Glib::MainContext> _context;
+    Glib::RefPtr<Glib::MainLoop> _main_loop;
+
+    std::string _received;
+    std::string _errors;
+    std::optional<Reply> _reply;
+    std::optional<std::string> _reply_errors; // What the worker wrote to stderr up to the NUL byte
+    bool _request_sent = false;
+    bool _broken = false;
+
+    bool _readStdout(Glib::IOCondition condition);
+    bool _readStderr(Glib::IOCondition condition);
+    void _parseReply();
+    void _parseErrors();
+};
+
+} // namespace Inkscape::Extension::Implementation
+
+#endif // INKSCAPE_EXTENSION_IMPLEMENTATION_SCRIPT_WORKER_H_SEEN
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8 :
@@ -14,6 +14,7 @@
  */
 
 #include "script.h"
+#include "script-worker.h"
 
 #include <glib/gstdio.h>
 #include <glibmm/convert.h>
@@ -206,6 +207,9 @@ bool Script::load(Inkscape::Extension::Extension *module)
                         }
                         command.push_back(interpString);
                     }
+                    if (child_repr->attribute("worker") && !strcmp(child_repr->attribute("worker"), "true")) {
+                        _worker_mode = true;
+                    }
                     // TODO: we already parse commands as dependencies in extension.cpp
                     //       can can we optimize this to be less indirect?
                     const char *script_name = child_repr->firstChild()->content();
@@ -240,6 +244,8 @@ void Script::unload(Inkscape::Extension::Extension */*module*/)
 {
     command.clear();
     helper_extension = "";
+    _worker.reset();
+    _worker_mode = false;
 }
 
 
@@ -611,18 +617,37 @@ void Script::_change_extension(Inkscape::Extension::Extension *module, SPDocumen
               Inkscape::Extension::FILE_SAVE_METHOD_TEMPORARY);
     prefs->setBool("/options/svgoutput/disable_optimizations", false);
 
-    file_listener fileout;
-    int data_read = execute(command, params, tempfile_in.get_filename(), fileout, ignore_stderr);
-    if (data_read == 0) {
-        return;
+    Inkscape::XML::Document *new_xmldoc = nullptr;
+
+    std::optional<std::string> reply;
+    if (_worker_mode) {
+        bool run_once = false;
+        reply = _call_worker(params, tempfile_in.get_filename(), ignore_stderr, run_once);
+        if (!reply && !run_once) {
+            return;
+        }
     }
-    fileout.toFile(tempfile_out.get_filename());
 
-    pump_events();
-    Inkscape::XML::Document *new_xmldoc = nullptr;
-    if (data_read > 10) {
-        new_xmldoc = sp_repr_read_file(tempfile_out.get_filename().c_str(), SP_SVG_NS_URI);
-    } // data_read
+    if (reply) {
+        // The worker sends nothing back if it leaves the document alone.
+        if (reply->empty()) {
+            return;
+        }
+        pump_events();
+        new_xmldoc = sp_repr_read_mem(reply->data(), reply->size(), SP_SVG_NS_URI);
+    } else {
+        file_listener fileout;
+        int data_read = execute(command, params, tempfile_in.get_filename(), fileout, ignore_stderr);
+        if (data_read == 0) {
+            return;
+        }
+        fileout.toFile(tempfile_out.get_filename());
+
+        pump_events();
+        if (data_read > 10) {
+            new_xmldoc = sp_repr_read_file(tempfile_out.get_filename().c_str(), SP_SVG_NS_URI);
+        } // data_read
+    }
 
     pump_events();
 
@@ -637,6 +662,66 @@ void Script::_change_extension(Inkscape::Extension::Extension *module, SPDocumen
     return;
 }
 
+/**
+ * Run the extension in its worker process, starting the process if it is not running yet.
+ *
+ * Returns the output document, or nothing if the call was cancelled or failed. @a run_once is
+ * set if the worker never got the request, so that the caller can run the script once in the
+ * usual way instead; a worker that failed after getting it may have acted on it already.
+ */
+std::optional<std::string> Script::_call_worker(std::list<std::string> const &params,
+                                                std::string const &filein,
+                                                bool ignore_stderr, bool &run_once)
+{
+    _canceled = false;
+    run_once = true;
+
+    std::string document;
+    try {
+        document = Glib::file_get_contents(filein);
+    } catch (Glib::FileError const &e) {
+        g_warning("Script::_call_worker(): cannot read '%s': %s", filein.c_str(), e.what().c_str());
+        return {};
+    }
+
+    if (!_worker) {
+        std::vector<std::string> argv;
+        std::string working_directory;
+        if (!command_argv(command, argv, working_directory)) {
+            return {};
+        }
+        auto const program = argv.front();
+        try {
+            _worker = std::make_unique<ScriptWorker>(std::move(argv), working_directory);
+        } catch (Glib::Error const &e) {
+            g_critical("Script::_call_worker(): failed to start worker '%s'.\n\tReason: %s", program.c_str(), e.what().c_str());
+            // Don't try again on every call.
+            _worker_mode = false;
+            return {};
+        }
+    }
+
+    auto reply = _worker->call({params.begin(), params.end()}, document);
+    if (!reply) {
+        run_once = !_canceled && !_worker->requestSent();
+        _worker.reset();
+        if (_canceled) {
+            return {};
+        }
+        g_warning("Script::_call_worker(): extension worker failed, restarting it on the next call");
+        if (!run_once) {
+            Inkscape::UI::gui_warning(_("The extension stopped before it finished."), parent_window);
+        }
+        return {};
+    }
+
+    if (!reply->messages.empty() && !ignore_stderr) {
+        show_stderr(reply->messages);
+    }
+
+    return std::move(reply->document);
+}
+
 /**  \brief  This function checks the stderr file, and if it has data,
              shows it in a warning dialog to the user
      \param  filename  Filename of the stderr file
@@ -673,17 +758,72 @@ void Script::showPopupError (const Glib::ustring &data,
     Inkscape::UI::dialog_run(warning);
 }
 
+/** \brief  Show what a script wrote to stderr, in a dialog or on the console
+*/
+void Script::show_stderr(const Glib::ustring &data)
+{
+    if (INKSCAPE.use_gui()) {
+        showPopupError(data, Gtk::MESSAGE_INFO,
+                             _("Inkscape has received additional data from the script executed.  "
+                               "The script did not return an error, but this may indicate the results will not be as expected."));
+    } else {
+        std::cerr << "Script Error\n----\n" << data.c_str() << "\n----\n";
+    }
+}
+
 bool Script::cancelProcessing () {
     _canceled = true;
     if (_main_loop) {
         _main_loop->quit();
     }
+    if (_worker) {
+        _worker->cancel();
+    }
     Glib::spawn_close_pid(_pid);
 
     return true;
 }
 
 
+/** \brief    Start the argument list for running a script from the command
+              derived from the configuration file.
+    \param    in_command  The command to be executed
+    \param    argv        Receives the interpreter (if any) and the script
+    \param    working_directory  Receives the directory to run it in
+    \return   Whether the command can be run.
+*/
+bool Script::command_argv(const std::list<std::string> &in_command,
+                          std::vector<std::string> &argv,
+                          std::string &working_directory)
+{
+    bool interpreted = (in_command.size() == 2);
+    std::string program = in_command.front();
+    std::string script = interpreted ? in_command.back() : "";
+    working_directory = "";
+
+    // We should always have an absolute path here:
+    //  - For interpreted scripts, see Script::resolveInterpreterExecutable()
+    //  - For "normal" scripts this should be done as part of the dependency checking, see Dependency::check()
+    if (!Glib::path_is_absolute(program)) {
+        g_critical("Script::command_argv(): Got unexpected relative path '%s'. Please report a bug.", program.c_str());
+        return false;
+    }
+    argv.push_back(program);
+
+    if (interpreted) {
+        // On Windows, Python garbles Unicode command line parameters
+        // in an useless way. This means extensions fail when Inkscape
+        // is run from an Unicode directory.
+        // As a workaround, we set the working directory to the one
+        // containing the script.
+        working_directory = Glib::path_get_dirname(script);
+        script = Glib::path_get_basename(script);
+        argv.push_back(script);
+    }
+
+    return true;
+}
+
 /** \brief    This is the core of the extension file as it actually does
               the execution of the extension.
     \param    in_command  The command to be executed
@@ -720,31 +860,11 @@ int Script::execute (const std::list<std::string> &in_command,
     g_return_val_if_fail(!in_command.empty(), 0);
 
     std::vector<std::string> argv;
-
-    bool interpreted = (in_command.size() == 2);
-    std::string program = in_command.front();
-    std::string script = interpreted ? in_command.back() : "";
-    std::string working_directory = "";
-
-    // We should always have an absolute path here:
-    //  - For interpreted scripts, see Script::resolveInterpreterExecutable()
-    //  - For "normal" scripts this should be done as part of the dependency checking, see Dependency::check()
-    if (!Glib::path_is_absolute(program)) {
-        g_critical("Script::execute(): Got unexpected relative path '%s'. Please report a bug.", program.c_str());
+    std::string working_directory;
+    if (!command_argv(in_command, argv, working_directory)) {
         return 0;
     }
-    argv.push_back(program);
-
-    if (interpreted) {
-        // On Windows, Python garbles Unicode command line parameters
-        // in an useless way. This means extensions fail when Inkscape
-        // is run from an Unicode directory.
-        // As a workaround, we set the working directory to the one
-        // containing the script.
-        working_directory = Glib::path_get_dirname(script);
-        script = Glib::path_get_basename(script);
-        argv.push_back(script);
-    }
+    std::string const &program = argv.front();
 
     // assemble the rest of argv
     std::copy(in_params.begin(), in_params.end(), std::back_inserter(argv));
@@ -802,13 +922,7 @@ int Script::execute (const std::list<std::string> &in_command,
 
     Glib::ustring stderr_data = fileerr.string();
     if (!stderr_data.empty() && !ignore_stderr) {
-        if (INKSCAPE.use_gui()) {
-            showPopupError(stderr_data, Gtk::MESSAGE_INFO,
-                                 _("Inkscape has received additional data from the script executed.  "
-                                   "The script did not return an error, but this may indicate the results will not be as expected."));
-        } else {
-            std::cerr << "Script Error\n----\n" << stderr_data.c_str() << "\n----\n";
-        }
+        show_stderr(stderr_data);
     }
 
     Glib::ustring stdout_data = fileout.string();
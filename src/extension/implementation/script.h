@@ -16,6 +16,8 @@
 
 #include <list>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <glibmm/iochannel.h>
@@ -44,6 +46,8 @@ class Node;
 
 namespace Extension::Implementation {
 
+class ScriptWorker;
+
 /**
  * Utility class used for loading and launching script extensions
  */
@@ -74,6 +78,16 @@ private:
 
     void _change_extension(Inkscape::Extension::Extension *mod, SPDocument *doc, std::list<std::string> &params, bool ignore_stderr);
 
+    /**
+     * Whether the extension asked to be kept running between calls, and the process
+     * if it is running.
+     */
+    bool _worker_mode = false;
+    std::unique_ptr<ScriptWorker> _worker;
+
+    std::optional<std::string> _call_worker(std::list<std::string> const &params, std::string const &filein,
+                                            bool ignore_stderr, bool &run_once);
+
     /**
      * The command that has been derived from
      * the configuration file with appropriate directories
@@ -96,6 +110,7 @@ private:
     Gtk::Window *parent_window;
 
     void showPopupError (Glib::ustring const& filename, Gtk::MessageType type, Glib::ustring const& message);
+    void show_stderr(Glib::ustring const &data);
 
     class file_listener {
         Glib::ustring _string;
@@ -115,6 +130,10 @@ private:
         bool toFile(const std::string &name);
     };
 
+    bool command_argv(const std::list<std::string> &in_command,
+                      std::vector<std::string> &argv,
+                      std::string &working_directory);
+
     int execute (const std::list<std::string> &in_command,
                  const std::list<std::string> &in_params,
                  const Glib::ustring &filein,
@@ -33,6 +33,7 @@
 
 #include "display/curve.h"
 
+#include "object/sp-image.h"
 #include "object/sp-item.h"
 #include "object/sp-root.h"
 
@@ -73,6 +74,7 @@ ps_print_document_to_file(SPDocument *doc, gchar const *filename, unsigned int l
         Inkscape::convert_text_to_curves(doc);
     }
 
+    sp_image_finish_decoding(doc);
     doc->ensureUpToDate();
 
     SPRoot *root = doc->getRoot();
@@ -29,6 +29,8 @@
 
 #include <csignal>
 #include <cerrno>
+#include <algorithm>
+#include <cstring>
 #include <2geom/pathvector.h>
 
 #include <glib.h>
@@ -219,6 +221,36 @@ CairoRenderContext* CairoRenderContext::cloneMe() const
     return cloneMe(_width, _height);
 }
 
+/**
+ * Create a context drawing into an unbounded recording surface, with the same output settings
+ * as this one and an identity transform. What it records can be painted into this context any
+ * number of times, which vector targets store only once.
+ */
+CairoRenderContext *CairoRenderContext::cloneRecording() const
+{
+    g_assert( _is_valid );
+
+    CairoRenderContext *new_context = _renderer->createContext();
+    cairo_surface_t *surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    new_context->_cr = cairo_create(surface);
+    new_context->_surface = surface;
+    new_context->_width = _width;
+    new_context->_height = _height;
+    new_context->_dpi = _dpi;
+    new_context->_target = _target;
+    new_context->_pdf_level = _pdf_level;
+    new_context->_ps_level = _ps_level;
+    new_context->_is_pdf = _is_pdf;
+    new_context->_is_ps = _is_ps;
+    new_context->_is_texttopath = _is_texttopath;
+    new_context->_is_filtertobitmap = _is_filtertobitmap;
+    new_context->_bitmapresolution = _bitmapresolution;
+    new_context->_vector_based_target = _vector_based_target;
+    new_context->_is_valid = TRUE;
+
+    return new_context;
+}
+
 bool CairoRenderContext::setImageTarget(cairo_format_t format)
 {
     // format cannot be set on an already initialized surface
@@ -980,6 +1012,16 @@ CairoRenderContext::nextPage(double width, double height, char const *label)
     _height = height;
     _is_show_page = false;
 
+    if (_recorded_page) {
+        // The output is resized by writeRecordedPage().
+        _recorded_page->width = width;
+        _recorded_page->height = height;
+        if (label) {
+            _recorded_page->label = label;
+        }
+        return true;
+    }
+
     if (_is_pdf) {
         cairo_pdf_surface_set_size(_surface, width, height);
 
@@ -1000,6 +1042,94 @@ CairoRenderContext::nextPage(double width, double height, char const *label)
 }
 
 
+void CairoRenderContext::beginRecordingPages()
+{
+    g_assert(_is_valid && _vector_based_target && !_output_cr);
+
+    _output_cr = _cr;
+    _cr = nullptr;
+    cairo_get_matrix(_output_cr, &_page_matrix);
+}
+
+void CairoRenderContext::beginRecordingPage()
+{
+    g_assert(_output_cr && !_cr);
+
+    cairo_surface_t *recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    _cr = cairo_create(recording);
+    cairo_surface_destroy(recording);
+    cairo_set_matrix(_cr, &_page_matrix);
+    _recorded_page = RecordedPage{nullptr, _width, _height, {}};
+}
+
+/**
+ * Finish drawing the current page. The returned recording is released by writeRecordedPage().
+ */
+CairoRenderContext::RecordedPage CairoRenderContext::endRecordingPage()
+{
+    g_assert(_cr && _recorded_page);
+
+    auto page = std::move(*_recorded_page);
+    _recorded_page.reset();
+    page.recording = cairo_surface_reference(cairo_get_target(_cr));
+    cairo_destroy(_cr);
+    _cr = nullptr;
+    return page;
+}
+
+/**
+ * Write a recorded page to the output and release its recording. Pages must be written one at
+ * a time and in order, but not necessarily on the main thread.
+ */
+bool CairoRenderContext::writeRecordedPage(RecordedPage const &page, char const *dest)
+{
+    g_assert(_output_cr);
+
+    if (_is_pdf) {
+        cairo_pdf_surface_set_size(_surface, page.width, page.height);
+        if (page.label) {
+            cairo_pdf_surface_set_page_label(_surface, page.label->c_str());
+        }
+    }
+    if (_is_ps) {
+        cairo_ps_surface_set_size(_surface, page.width, page.height);
+    }
+
+    // The recording is in device space already.
+    cairo_save(_output_cr);
+    cairo_identity_matrix(_output_cr);
+    cairo_set_source_surface(_output_cr, page.recording, 0, 0);
+    cairo_paint(_output_cr);
+    cairo_restore(_output_cr);
+    cairo_surface_destroy(page.recording);
+
+    // Create a page dest for any anchor tags that link to this page.
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 15, 4)
+    char *attributes = g_strdup_printf("name='%s'", dest);
+    cairo_tag_begin(_output_cr, CAIRO_TAG_DEST, attributes);
+    cairo_tag_end(_output_cr, CAIRO_TAG_DEST);
+    g_free(attributes);
+#endif
+
+    cairo_show_page(_output_cr);
+
+    auto status = cairo_status(_output_cr);
+    if (status != CAIRO_STATUS_SUCCESS) {
+        g_critical("error while rendering page: %s", cairo_status_to_string(status));
+        return false;
+    }
+    return true;
+}
+
+void CairoRenderContext::endRecordingPages()
+{
+    g_assert(_output_cr && !_cr);
+
+    _cr = _output_cr;
+    _output_cr = nullptr;
+    _is_show_page = true;
+}
+
 bool
 CairoRenderContext::finish(bool finish_surface)
 {
@@ -1706,6 +1836,55 @@ CairoRenderContext::renderPathVector(Geom::PathVector const & pathv, SPStyle con
     return true;
 }
 
+/**
+ * Tag an image surface with a digest of its contents, which the PDF and PS backends use to write
+ * identical images only once, however many surfaces hold them. JPEG and JPEG 2000 images with
+ * their original file attached are identified by that file, which is shorter than the pixels and
+ * is what gets embedded. Everything else, PNG included, is embedded from the pixels, which may
+ * differ from the attached file after a color profile was applied, so the pixels are hashed.
+ * Changing the pixels drops the tag, so a tag from an earlier export can be kept.
+ */
+static void set_image_unique_id(cairo_surface_t *surface)
+{
+    unsigned char const *data = nullptr;
+    unsigned long length = 0;
+    cairo_surface_get_mime_data(surface, CAIRO_MIME_TYPE_UNIQUE_ID, &data, &length);
+    if (data) {
+        return;
+    }
+
+    int const width = cairo_image_surface_get_width(surface);
+    int const height = cairo_image_surface_get_height(surface);
+    auto const checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    auto const size = Glib::ustring::compose("%1x%2;", width, height);
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(size.c_str()), size.bytes());
+
+    for (auto mimetype : {CAIRO_MIME_TYPE_JPEG, CAIRO_MIME_TYPE_JP2}) {
+        cairo_surface_get_mime_data(surface, mimetype, &data, &length);
+        if (data) {
+            g_checksum_update(checksum, reinterpret_cast<guchar const *>(mimetype), -1);
+            g_checksum_update(checksum, data, length);
+            break;
+        }
+    }
+    if (!data) {
+        // Only the pixels count, not the padding at the end of the rows.
+        cairo_surface_flush(surface);
+        int const stride = cairo_image_surface_get_stride(surface);
+        int const format = cairo_image_surface_get_format(surface);
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>(&format), sizeof(format));
+        unsigned char const *pixels = cairo_image_surface_get_data(surface);
+        for (int y = 0; y < height; y++) {
+            g_checksum_update(checksum, pixels + y * stride, std::min(stride, 4 * width));
+        }
+    }
+
+    auto const id = g_strconcat("inkscape-image:", g_checksum_get_string(checksum), nullptr);
+    g_checksum_free(checksum);
+    cairo_surface_set_mime_data(surface, CAIRO_MIME_TYPE_UNIQUE_ID, reinterpret_cast<unsigned char *>(id),
+                                strlen(id), g_free, id);
+}
+
 bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
                                      Geom::Affine const &image_transform, SPStyle const *style)
 {
@@ -1728,13 +1907,17 @@ bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
         return false;
     }
 
+    if (_vector_based_target) {
+        set_image_unique_id(const_cast<cairo_surface_t *>(image_surface));
+    }
+
     cairo_save(_cr);
 
     // scaling by width & height is not needed because it will be done by Cairo
     transform(image_transform);
 
     // cairo_set_source_surface only modifies refcount of 'image_surface', which is an implementation detail
-    cairo_set_source_surface(_cr, const_cast<cairo_surface_t*>(image_surface), 0.0, 0.0);
+    cairo_set_source_surface(_cr, _renderer->imageForPage(const_cast<cairo_surface_t*>(image_surface)), 0.0, 0.0);
 
     // set clip region so that the pattern will not be repeated (bug in Cairo-PDF)
     if (_vector_based_target) {
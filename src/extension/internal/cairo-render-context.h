@@ -15,6 +15,7 @@
  */
 
 #include "extension/extension.h"
+#include <optional>
 #include <set>
 #include <string>
 
@@ -81,10 +82,28 @@ class CairoRenderContext {
 public:
     CairoRenderContext *cloneMe() const;
     CairoRenderContext *cloneMe(double width, double height) const;
+    CairoRenderContext *cloneRecording() const;
     bool finish(bool finish_surface = true);
     bool finishPage();
     bool nextPage(double width, double height, char const *label);
 
+    /** A page drawn into a recording, waiting to be written to the output. */
+    struct RecordedPage
+    {
+        cairo_surface_t *recording;
+        double width;
+        double height;
+        std::optional<std::string> label;
+    };
+    /* Draw pages into recordings instead of the output, so that they can be written out on
+       another thread while the next ones are drawn. Only writeRecordedPage() may use the output
+       until endRecordingPages(). */
+    void beginRecordingPages();
+    void beginRecordingPage();
+    RecordedPage endRecordingPage();
+    bool writeRecordedPage(RecordedPage const &page, char const *dest);
+    void endRecordingPages();
+
     CairoRenderer *getRenderer() const;
     cairo_t *getCairoContext() const;
 
@@ -231,6 +250,10 @@ protected:
 
     CairoRenderContextMetadata _metadata;
 
+    cairo_t *_output_cr = nullptr;  // the output while recording pages
+    cairo_matrix_t _page_matrix;    // the transform that recorded pages start with
+    std::optional<RecordedPage> _recorded_page; // the page being recorded
+
     cairo_pattern_t *_createPatternForPaintServer(SPPaintServer const *const paintserver,
                                                   Geom::OptRect const &pbox, float alpha);
     cairo_pattern_t *_createPatternPainter(SPPaintServer const *const paintserver, Geom::OptRect const &pbox);
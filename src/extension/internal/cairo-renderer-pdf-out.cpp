@@ -32,6 +32,7 @@
 #include "display/drawing.h"
 #include "display/curve.h"
 
+#include "object/sp-image.h"
 #include "object/sp-item.h"
 #include "object/sp-root.h"
 #include "object/sp-page.h"
@@ -70,6 +71,7 @@ pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int
         Inkscape::convert_text_to_curves(doc);
     }
 
+    sp_image_finish_decoding(doc);
     doc->ensureUpToDate();
 
     SPRoot *root = doc->getRoot();
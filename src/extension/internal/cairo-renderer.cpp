@@ -26,8 +26,18 @@
 #endif
 
 
+#include <algorithm>
 #include <csignal>
 #include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 
 #include <2geom/transforms.h>
@@ -48,6 +58,7 @@
 #include "cairo-renderer.h"
 #include "document.h"
 #include "inkscape-version.h"
+#include "preferences.h"
 #include "rdf.h"
 #include "style-internal.h"
 #include "display/cairo-utils.h"
@@ -76,6 +87,7 @@
 #include "object/sp-text.h"
 #include "object/sp-use.h"
 
+#include "util/scope_exit.h"
 #include "util/units.h"
 
 //#define TRACE(_args) g_printf _args
@@ -92,6 +104,8 @@ CairoRenderer::CairoRenderer(void)
 
 CairoRenderer::~CairoRenderer()
 {
+    _releasePageSources();
+
     /* restore default signal handling for SIGPIPE */
 #if !defined(_WIN32) && !defined(__WIN32__)
     (void) signal(SIGPIPE, SIG_DFL);
@@ -385,7 +399,7 @@ static void sp_use_render(SPUse const *use, CairoRenderContext *ctx, SPPage cons
         translated = true;
     }
 
-    if (use->child) {
+    if (use->child && !renderer->renderRecordedClone(ctx, use, page)) {
         // Padding in the use object as the origin here ensures markers
         // are rendered with their correct context-fill.
         renderer->renderItem(ctx, use->child, use, page);
@@ -515,15 +529,9 @@ static void sp_root_render(SPRoot const *root, CairoRenderContext *ctx)
     ctx->popState();
 }
 
-/**
-    This function converts the item to a raster image and includes the image into the cairo renderer.
-    It is only used for filters and then only when rendering filters as bitmaps is requested.
-*/
-static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPage const *page)
+/** The resolution at which sp_asbitmap_render() rasterises filtered items. */
+static double asbitmap_resolution(CairoRenderContext *ctx)
 {
-
-    // The code was adapted from sp_selection_create_bitmap_copy in selection-chemistry.cpp
-
     // Calculate resolution
     /** @TODO reimplement the resolution stuff   (WHY?)
     */
@@ -531,14 +539,44 @@ static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPa
     if (res == 0) {
         res = Inkscape::Util::Quantity::convert(1, "in", "px");
     }
-    TRACE(("sp_asbitmap_render: resolution: %f\n", res ));
+    return res;
+}
 
+/** The area in document coordinates that sp_asbitmap_render() rasterises, if any. */
+static Geom::OptRect asbitmap_area(SPItem const *item, double res, SPPage const *page)
+{
     // Get the bounding box of the selection in document coordinates.
     Geom::OptRect bbox = item->documentVisualBounds();
 
     bbox &= (page ? page->getDocumentRect() : item->document->preferredBounds());
 
     // no bbox, e.g. empty group or item not overlapping its page
+    if (!bbox) {
+        return {};
+    }
+
+    // The bitmap must be at least one pixel wide and high
+    if (ceil(bbox->width() * Inkscape::Util::Quantity::convert(res, "px", "in")) == 0 ||
+        ceil(bbox->height() * Inkscape::Util::Quantity::convert(res, "px", "in")) == 0)
+    {
+        return {};
+    }
+    return bbox;
+}
+
+/**
+    This function converts the item to a raster image and includes the image into the cairo renderer.
+    It is only used for filters and then only when rendering filters as bitmaps is requested.
+*/
+static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPage const *page)
+{
+
+    // The code was adapted from sp_selection_create_bitmap_copy in selection-chemistry.cpp
+
+    double const res = asbitmap_resolution(ctx);
+    TRACE(("sp_asbitmap_render: resolution: %f\n", res ));
+
+    Geom::OptRect const bbox = asbitmap_area(item, res, page);
     if (!bbox) {
         return;
     }
@@ -547,8 +585,6 @@ static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPa
     unsigned width =  ceil(bbox->width() * Inkscape::Util::Quantity::convert(res, "px", "in"));
     unsigned height = ceil(bbox->height() * Inkscape::Util::Quantity::convert(res, "px", "in"));
 
-    if (width == 0 || height == 0) return;
-
     // Scale to exactly fit integer bitmap inside bounding box
     double scale_x = bbox->width() / width;
     double scale_y = bbox->height() / height;
@@ -572,8 +608,11 @@ static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPa
     Geom::Affine t_item =  item->i2doc_affine();
     Geom::Affine t = t_on_document * t_item.inverse();
 
-    // Do the export
-    std::unique_ptr<Inkscape::Pixbuf> pb(sp_generate_internal_bitmap(item->document, *bbox, res, {item}, true));
+    // Do the export, unless renderPages() already had it done on a worker thread
+    auto pb = ctx->getRenderer()->takePreparedBitmap(item, page, *bbox, res);
+    if (!pb) {
+        pb.reset(sp_generate_internal_bitmap(item->document, *bbox, res, {item}, true));
+    }
 
     if (pb) {
         //TEST(gdk_pixbuf_save( pb, "bitmap.png", "png", NULL, NULL ));
@@ -712,6 +751,91 @@ void CairoRenderer::renderItem(CairoRenderContext *ctx, SPItem const *item, SPIt
     ctx->popState();
 }
 
+/**
+ * Whether @a item draws the same wherever it is placed, so that one recording of it can stand
+ * in for all clones of it. Masks are rasterised in page coordinates, filters may be, hairlines
+ * can depend on the device scale, and links need their position on the page.
+ */
+static bool renders_independently_of_position(SPItem const *item)
+{
+    if (item->getMaskObject() || item->isFiltered() || item->style->stroke_extensions.hairline || is<SPAnchor>(item)) {
+        return false;
+    }
+    for (auto link : item->getLinked(SPObject::LinkedObjectNature::DEPENDENT)) {
+        if (is<SPAnchor>(link)) {
+            return false;
+        }
+    }
+    if (auto shape = cast<SPShape>(item)) {
+        for (auto marker : shape->_marker) {
+            auto const marker_item = marker ? sp_item_first_item_child(marker) : nullptr;
+            if (marker_item && !renders_independently_of_position(marker_item)) {
+                return false;
+            }
+        }
+    }
+    for (auto const &child : item->children) {
+        if (auto child_item = cast<SPItem>(&child); child_item && !renders_independently_of_position(child_item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void append_affine(std::string &key, Geom::Affine const &affine)
+{
+    char buf[32];
+    for (int i = 0; i < 6; i++) {
+        g_ascii_formatd(buf, sizeof(buf), "%.17g", affine[i]);
+        key += buf;
+        key += ',';
+    }
+}
+
+bool CairoRenderer::renderRecordedClone(CairoRenderContext *ctx, SPUse const *use, SPPage const *page)
+{
+    // Recordings only pay off on vector targets, and clip paths must add to the current path.
+    auto const child = use->child;
+    auto const original = use->get_original();
+    if (!ctx->_vector_based_target || ctx->getRenderMode() != CairoRenderContext::RENDER_MODE_NORMAL ||
+        ctx->getOmitText() || !child || !original || !renders_independently_of_position(child))
+    {
+        return false;
+    }
+
+    // The clone's subtree is a copy of the original that only differs in what it inherits from
+    // the <use>, which also supplies context-fill and context-stroke.
+    auto key = std::to_string(reinterpret_cast<std::uintptr_t>(original));
+    key += ';';
+    append_affine(key, child->transform);
+    if (auto symbol = cast<SPSymbol>(child)) {
+        append_affine(key, symbol->c2p);
+    }
+    key += use->style->write(SP_STYLE_FLAG_ALWAYS);
+    key += ';';
+    key += child->style->write(SP_STYLE_FLAG_ALWAYS);
+
+    auto &recording = _clone_recordings[key];
+    if (!recording) {
+        CairoRenderContext *record_ctx = ctx->cloneRecording();
+        renderItem(record_ctx, child, use, page);
+        cairo_surface_t *surface = record_ctx->getSurface();
+        if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+            destroyContext(record_ctx);
+            _clone_recordings.erase(key);
+            return false;
+        }
+        recording = cairo_surface_reference(surface);
+        destroyContext(record_ctx);
+    }
+
+    cairo_save(ctx->_cr);
+    cairo_set_source_surface(ctx->_cr, recording, 0, 0);
+    cairo_paint(ctx->_cr);
+    cairo_restore(ctx->_cr);
+    return true;
+}
+
 void CairoRenderer::renderHatchPath(CairoRenderContext *ctx, SPHatchPath const &hatchPath, unsigned key) {
     ctx->pushState();
     ctx->setStateForStyle(hatchPath.style);
@@ -801,16 +925,171 @@ CairoRenderer::setupDocument(CairoRenderContext *ctx, SPDocument *doc, SPItem co
 /**
  * Handle multiple pages, pushing each out to cairo as needed using renderItem()
  */
+/**
+ * Filtered items being rasterised on worker threads ahead of sp_asbitmap_render(), in the order
+ * in which the export gets to them. Only a few jobs are started ahead, because each keeps the
+ * whole document shown in a drawing of its own until its bitmap is taken.
+ */
+struct CairoRenderer::BitmapQueue
+{
+    struct Job
+    {
+        SPItem const *item;
+        SPPage const *page;
+        Geom::Rect area;
+        double res;
+        std::unique_ptr<OffscreenBitmap> bitmap;
+        std::unique_ptr<Inkscape::Pixbuf> result;
+        bool done = false;
+    };
+
+    explicit BitmapQueue(int nthreads)
+        : pool(nthreads)
+        , window(2 * nthreads)
+    {}
+
+    ~BitmapQueue() { pool.join(); }
+
+    /// Start jobs from the front of the queue, up to the size of the window.
+    void launch()
+    {
+        while (launched < jobs.size() && launched < window) {
+            auto const job = jobs[launched++].get();
+            job->bitmap = std::make_unique<OffscreenBitmap>(job->item->document, job->area, job->res,
+                                                            std::vector<SPItem const *>{job->item}, true);
+            boost::asio::post(pool, [this, job] {
+                auto result = std::unique_ptr<Inkscape::Pixbuf>(job->bitmap->render());
+                auto lock = std::lock_guard(mutex);
+                job->result = std::move(result);
+                job->done = true;
+                done_cond.notify_all();
+            });
+        }
+    }
+
+    /// Remove the front job, waiting for it to finish if it was started.
+    std::unique_ptr<Job> pop()
+    {
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        if (launched > 0) {
+            launched--;
+            auto lock = std::unique_lock(mutex);
+            done_cond.wait(lock, [&] { return job->done; });
+        }
+        return job;
+    }
+
+    boost::asio::thread_pool pool;
+    std::size_t const window;
+    std::deque<std::unique_ptr<Job>> jobs;
+    std::size_t launched = 0; ///< Jobs at the front of the queue that were started.
+    std::mutex mutex;
+    std::condition_variable done_cond;
+};
+
+std::unique_ptr<Inkscape::Pixbuf> CairoRenderer::takePreparedBitmap(SPItem const *item, SPPage const *page,
+                                                                    Geom::Rect const &area, double res)
+{
+    if (!_bitmaps) {
+        return {};
+    }
+
+    auto &jobs = _bitmaps->jobs;
+    auto const it = std::find_if(jobs.begin(), jobs.end(), [&] (auto const &job) {
+        return job->item == item && job->page == page && job->area == area && job->res == res;
+    });
+    if (it == jobs.end()) {
+        return {};
+    }
+
+    // Any jobs before this one were for items that didn't get rendered after all.
+    for (auto skip = it - jobs.begin(); skip > 0; skip--) {
+        _bitmaps->pop();
+    }
+    auto result = std::move(_bitmaps->pop()->result);
+    _bitmaps->launch();
+    return result;
+}
+
+void CairoRenderer::_collectBitmaps(CairoRenderContext *ctx, SPItem const *item, SPPage const *page, double res)
+{
+    // Follows what renderItem() gets to, apart from clip paths, masks, markers and patterns,
+    // whose filtered items are still rasterised when the export reaches them.
+    if (item->isHidden() || has_hidder_filter(item)) {
+        return;
+    }
+
+    if (_shouldRasterize(ctx, item)) {
+        if (auto area = asbitmap_area(item, res, page)) {
+            _bitmaps->jobs.push_back(std::make_unique<BitmapQueue::Job>(BitmapQueue::Job{item, page, *area, res}));
+        }
+    } else if (auto use = cast<SPUse>(item)) {
+        if (use->child) {
+            _collectBitmaps(ctx, use->child, page, res);
+        }
+    } else if (auto symbol = cast<SPSymbol>(item); (symbol && !symbol->cloned) || is<SPMarker>(item)) {
+        return;
+    } else if (auto group = cast<SPGroup>(item)) {
+        for (auto &child : group->children) {
+            if (auto child_item = cast<SPItem>(&child)) {
+                _collectBitmaps(ctx, child_item, page, res);
+            }
+        }
+    }
+}
+
+void CairoRenderer::_prepareBitmaps(CairoRenderContext *ctx, SPDocument *doc, std::vector<SPPage *> const &pages)
+{
+    if (!ctx->getFilterToBitmap()) {
+        return;
+    }
+
+    // The workers render drawings of the document, which must not be updated meanwhile.
+    doc->ensureUpToDate();
+
+    auto prefs = Inkscape::Preferences::get();
+    int const nthreads = prefs->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256);
+    _bitmaps = std::make_unique<BitmapQueue>(nthreads);
+
+    double const res = asbitmap_resolution(ctx);
+    if (pages.empty()) {
+        _collectBitmaps(ctx, doc->getRoot(), nullptr, res);
+    }
+    for (auto page : pages) {
+        for (auto child : page->getOverlappingItems(false, true, false)) {
+            _collectBitmaps(ctx, child, page, res);
+        }
+    }
+
+    if (_bitmaps->jobs.empty()) {
+        _bitmaps.reset();
+        return;
+    }
+    _bitmaps->launch();
+}
+
 bool
 CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretch_to_fit)
 {
     auto pages = doc->getPageManager().getPages();
+
+    // Rasterise filtered items on worker threads while the vector output is written.
+    _prepareBitmaps(ctx, doc, pages);
+    auto discard_bitmaps = scope_exit([this] { _bitmaps.reset(); });
+
     if (pages.size() == 0) {
         // Output the page bounding box as already set up in the initial setupDocument.
         renderItem(ctx, doc->getRoot());
         return true;
     }
 
+    auto prefs = Inkscape::Preferences::get();
+    int const nthreads = prefs->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256);
+    if (nthreads > 1 && pages.size() > 1 && _canRecordPages(ctx, doc)) {
+        return _renderRecordedPages(ctx, doc, pages, stretch_to_fit);
+    }
+
     for (auto &page : pages) {
         ctx->pushState();
         if (!renderPage(ctx, doc, page, stretch_to_fit)) {
@@ -829,6 +1108,135 @@ CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretc
     return true;
 }
 
+bool CairoRenderer::_canRecordPages(CairoRenderContext *ctx, SPDocument *doc)
+{
+    // Text omitted for LaTeX starts new pages by itself, and links would end up inside the
+    // recordings, where the PDF backend doesn't make annotations of them.
+    return ctx->_vector_based_target && (ctx->_is_pdf || ctx->_is_ps) && !ctx->getOmitText() &&
+           doc->getObjectsByElement("a").empty();
+}
+
+cairo_surface_t *CairoRenderer::imageForPage(cairo_surface_t *image)
+{
+    if (!_recording_pages) {
+        return image;
+    }
+    auto &copy = _page_images[image];
+    if (copy) {
+        return copy;
+    }
+    cairo_surface_reference(image);
+
+    cairo_surface_flush(image);
+    int const width = cairo_image_surface_get_width(image);
+    int const height = cairo_image_surface_get_height(image);
+    copy = cairo_image_surface_create(cairo_image_surface_get_format(image), width, height);
+    if (cairo_surface_status(copy) == CAIRO_STATUS_SUCCESS) {
+        int const src_stride = cairo_image_surface_get_stride(image);
+        int const dst_stride = cairo_image_surface_get_stride(copy);
+        auto const src = cairo_image_surface_get_data(image);
+        auto const dst = cairo_image_surface_get_data(copy);
+        for (int y = 0; y < height; y++) {
+            std::memcpy(dst + y * dst_stride, src + y * src_stride, std::min(src_stride, dst_stride));
+        }
+        cairo_surface_mark_dirty(copy);
+    }
+
+    // The unique id lets the output still store the image only once for all pages.
+    for (auto mimetype : {CAIRO_MIME_TYPE_UNIQUE_ID, CAIRO_MIME_TYPE_JPEG, CAIRO_MIME_TYPE_JP2, CAIRO_MIME_TYPE_PNG}) {
+        unsigned char const *data = nullptr;
+        unsigned long length = 0;
+        cairo_surface_get_mime_data(image, mimetype, &data, &length);
+        if (data) {
+            auto const data_copy = static_cast<unsigned char *>(g_malloc(length));
+            std::memcpy(data_copy, data, length);
+            cairo_surface_set_mime_data(copy, mimetype, data_copy, length, g_free, data_copy);
+        }
+    }
+    return copy;
+}
+
+/**
+ * Let go of the images and clone recordings of the page that was recorded last; the recording
+ * holds on to those it uses. Each page is recorded with sources of its own, which the thread
+ * writing the earlier pages doesn't touch: cairo changes a source surface while recording it as
+ * well as while writing it, which can't happen on two threads at once.
+ */
+void CairoRenderer::_releasePageSources()
+{
+    for (auto const &[image, copy] : _page_images) {
+        cairo_surface_destroy(copy);
+        cairo_surface_destroy(image);
+    }
+    _page_images.clear();
+    for (auto const &[key, recording] : _clone_recordings) {
+        cairo_surface_destroy(recording);
+    }
+    _clone_recordings.clear();
+}
+
+/**
+ * Draw each page into a recording on this thread and have a worker thread write the recordings
+ * to the output in order, which is where the PDF and PS backends spend most of their time. Fonts
+ * are still shared by all pages, as there is only one output surface.
+ */
+bool CairoRenderer::_renderRecordedPages(CairoRenderContext *ctx, SPDocument *doc,
+                                         std::vector<SPPage *> const &pages, bool stretch_to_fit)
+{
+    // Bounds the memory taken by the recordings when writing falls behind.
+    constexpr int MAX_PAGES_AHEAD = 4;
+
+    boost::asio::thread_pool writer(1);
+    std::mutex mutex;
+    std::condition_variable cond;
+    int queued = 0;
+    bool failed = false;
+
+    ctx->beginRecordingPages();
+    _recording_pages = true;
+    _releasePageSources();
+    for (auto &page : pages) {
+        {
+            auto lock = std::unique_lock(mutex);
+            cond.wait(lock, [&] { return queued < MAX_PAGES_AHEAD || failed; });
+            if (failed) {
+                break;
+            }
+            queued++;
+        }
+
+        ctx->beginRecordingPage();
+        ctx->pushState();
+        bool const rendered = renderPage(ctx, doc, page, stretch_to_fit);
+        ctx->popState();
+        auto recorded = ctx->endRecordingPage();
+        _releasePageSources();
+        if (!rendered) {
+            cairo_surface_destroy(recorded.recording);
+            auto lock = std::lock_guard(mutex);
+            failed = true;
+            break;
+        }
+
+        boost::asio::post(writer, [&, recorded = std::move(recorded), dest = page->getId()] {
+            bool const written = ctx->writeRecordedPage(recorded, dest);
+            auto lock = std::lock_guard(mutex);
+            queued--;
+            failed |= !written;
+            cond.notify_all();
+        });
+    }
+    writer.join();
+    ctx->endRecordingPages();
+    _recording_pages = false;
+
+    if (failed) {
+        g_warning("Couldn't render page in output!");
+        return false;
+    }
+    return true;
+}
+
 bool
 CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage const *page, bool stretch_to_fit)
 {
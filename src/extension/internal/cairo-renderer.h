@@ -16,8 +16,12 @@
  */
 
 #include "extension/extension.h"
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
+#include <2geom/forward.h>
 
 //#include "libnrtype/font-instance.h"
 #include <cairo.h>
@@ -27,8 +31,11 @@ class SPClipPath;
 class SPMask;
 class SPHatchPath;
 class SPPage;
+class SPUse;
 
 namespace Inkscape {
+class Pixbuf;
+
 namespace Extension {
 namespace Internal {
 
@@ -60,6 +67,21 @@ public:
     bool renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretch_to_fit);
     bool renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage const *page, bool stretch_to_fit);
 
+    /** Paints the object referenced by a clone from a recording that is made once for each
+    distinct object and style, so that vector targets store it once for all its clones.
+    Returns false if the clone has to be rendered inline instead. */
+    bool renderRecordedClone(CairoRenderContext *ctx, SPUse const *use, SPPage const *page = nullptr);
+
+    /** Hands over the bitmap of a filtered item that renderPages() had rasterised ahead of time
+    for this page, area and resolution, or nullptr if there is none. */
+    std::unique_ptr<Inkscape::Pixbuf> takePreparedBitmap(SPItem const *item, SPPage const *page,
+                                                         Geom::Rect const &area, double res);
+
+    /** While renderPages() records pages, returns a copy of the image that only the page being
+    recorded uses, since the earlier pages are written on another thread. Otherwise returns the
+    image itself. */
+    cairo_surface_t *imageForPage(cairo_surface_t *image);
+
 private:
     /** Extract metadata from doc and set it on ctx. */
     void setMetadata(CairoRenderContext *ctx, SPDocument *doc);
@@ -71,6 +93,26 @@ private:
     static void _doRender(SPItem const *item, CairoRenderContext *ctx, SPItem const *origin = nullptr,
                           SPPage const *page = nullptr);
 
+    /** Recordings of cloned objects by what they depend on, see renderRecordedClone(). */
+    std::map<std::string, cairo_surface_t *> _clone_recordings;
+
+    /** Start rasterising the filtered items of all pages on worker threads. */
+    void _prepareBitmaps(CairoRenderContext *ctx, SPDocument *doc, std::vector<SPPage *> const &pages);
+    void _collectBitmaps(CairoRenderContext *ctx, SPItem const *item, SPPage const *page, double res);
+
+    struct BitmapQueue;
+    std::unique_ptr<BitmapQueue> _bitmaps;
+
+    /** Whether renderPages() can write out pages on another thread, see _renderRecordedPages(). */
+    static bool _canRecordPages(CairoRenderContext *ctx, SPDocument *doc);
+    bool _renderRecordedPages(CairoRenderContext *ctx, SPDocument *doc, std::vector<SPPage *> const &pages,
+                              bool stretch_to_fit);
+    void _releasePageSources();
+
+    /** Whether renderPages() is recording pages, see imageForPage(). */
+    bool _recording_pages = false;
+    /** Copies of the images on the page being recorded, by the original, which they keep alive. */
+    std::map<cairo_surface_t *, cairo_surface_t *> _page_images;
 };
 
 // FIXME: this should be a static method of CairoRenderer
@@ -222,21 +222,30 @@ double Emf::current_rotation(PEMF_CALLBACK_DATA d){
     return -std::atan2(d->dc[d->level].worldTransform.eM12, d->dc[d->level].worldTransform.eM11);
 }
 
-/*  Add another 100 blank slots to the hatches array.
+/*  Add a copy of the string to the list, growing it by 100 slots at a time.  Return its position (1->n, not 1-n-1)
 */
-void Emf::enlarge_hatches(PEMF_CALLBACK_DATA d){
-    d->hatches.size += 100;
-    d->hatches.strings = (char **) realloc(d->hatches.strings,d->hatches.size * sizeof(char *));
+int Emf::add_string(EMF_STRINGS &list, const char *string){
+    if(list.count == list.size){
+        list.size += 100;
+        list.strings = (char **) realloc(list.strings,list.size * sizeof(char *));
+    }
+    list.strings[list.count] = strdup(string);
+    list.index.emplace(list.strings[list.count], list.count + 1);
+    return(++list.count);
+}
+
+/*  See if the string is already in the list.  If it is return its position (1->n, not 1-n-1)
+    This is a hash lookup, lists may hold many thousands of entries.
+*/
+int Emf::find_string(const EMF_STRINGS &list, const char *test){
+    auto found = list.index.find(test);
+    return(found == list.index.end() ? 0 : found->second);
 }
 
 /*  See if the pattern name is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Emf::in_hatches(PEMF_CALLBACK_DATA d, char *test){
-    int i;
-    for(i=0; i<d->hatches.count; i++){
-        if(strcmp(test,d->hatches.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->hatches, test));
 }
 
 /*  (Conditionally) add a hatch.  If a matching hatch already exists nothing happens.  If one
@@ -273,8 +282,7 @@ uint32_t Emf::add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
     idx = in_hatches(d,hpathname);
     auto & defs = d->defs;
     if(!idx){  // add path/color if not already present
-        if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-        d->hatches.strings[d->hatches.count++]=strdup(hpathname);
+        add_string(d->hatches, hpathname);
 
         defs += "\n";
         switch(hatchType){
@@ -397,8 +405,7 @@ uint32_t Emf::add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hpathname,"EMFhpath%d_%s",hatchType,tmpcolor);
         idx = in_hatches(d,hatchname);
         if(!idx){  // add it if not already present
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hatchname);
+            add_string(d->hatches, hatchname);
             defs += "\n";
             defs += "   <pattern id=\"";
             defs += hatchname;
@@ -414,8 +421,7 @@ uint32_t Emf::add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hbkname,"EMFhbkclr_%s",bkcolor);
         idx = in_hatches(d,hbkname);
         if(!idx){  // add path/color if not already present.  Hatchtype is not needed in the name.
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hbkname);
+            add_string(d->hatches, hbkname);
 
             defs += "\n";
             defs += "   <rect id=\"";
@@ -429,8 +435,7 @@ uint32_t Emf::add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hatchname,"EMFhatch%d_%s_%s",hatchType,tmpcolor,bkcolor);
         idx = in_hatches(d,hatchname);
         if(!idx){  // add it if not already present
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hatchname);
+            add_string(d->hatches, hatchname);
             defs += "\n";
             defs += "   <pattern id=\"";
             defs += hatchname;
@@ -446,21 +451,10 @@ uint32_t Emf::add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
     return(idx-1);
 }
 
-/*  Add another 100 blank slots to the images array.
-*/
-void Emf::enlarge_images(PEMF_CALLBACK_DATA d){
-    d->images.size += 100;
-    d->images.strings = (char **) realloc(d->images.strings,d->images.size * sizeof(char *));
-}
-
 /*  See if the image string is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Emf::in_images(PEMF_CALLBACK_DATA d, const char *test){
-    int i;
-    for(i=0; i<d->images.count; i++){
-        if(strcmp(test,d->images.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->images, test));
 }
 
 /*  (Conditionally) add an image.  If a matching image already exists nothing happens.  If one
@@ -485,7 +479,7 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
     const char      *px      = nullptr;     // DIB pixels
     const U_RGBQUAD *ct      = nullptr;     // DIB color table
     U_RGBQUAD        ct2[2];
-    uint32_t width, height, colortype, numCt, invert; // if needed these values will be set in get_DIB_params
+    uint32_t width = 0, height = 0, colortype = 0, numCt = 0, invert = 0; // if needed these values will be set in get_DIB_params
     if(cbBits && cbBmi  && (iUsage == U_DIB_RGB_COLORS)){
         // next call returns pointers and values, but allocates no memory
         dibparams = get_DIB_params((const char *)pEmr, offBits, offBmi, &px, (const U_RGBQUAD **) &ct,
@@ -502,7 +496,17 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
                     return(U_EMR_INVALID);
                 }
             }
+        }
+    }
 
+    /*  Look the image up by its bytes in the record, so that an image which is used many times is
+        only converted and encoded once.
+    */
+    std::string key = image_key(dibparams, px, ct, numCt, width, height, colortype, invert);
+    idx = in_images(d, key.c_str());
+    auto & defs = d->defs;
+    if(!idx){  // add it if not already present - we looked at the actual data for comparison
+        if(dibparams == U_BI_RGB){
             if(!DIB_to_RGBA(
                 px,         // DIB pixel array
                 ct,         // DIB color table
@@ -522,30 +526,24 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
                 free(rgba_px);
             }
         }
-    }
 
-    gchar *base64String=nullptr;
-    if(dibparams == U_BI_JPEG || dibparams==U_BI_PNG){  // image was binary png or jpg in source file
-        base64String = g_base64_encode((guchar*) px, numCt );
-    }
-    else if(mempng.buffer){                             // image was DIB in source file, converted to png in this routine
-        base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
-        free(mempng.buffer);
-    }
-    else {                                              // unknown or unsupported image type or failed conversion, insert the common bad image picture
-        width  = 3;
-        height = 4;
-        base64String = bad_image_png();
-    }
+        gchar *base64String=nullptr;
+        if(dibparams == U_BI_JPEG || dibparams==U_BI_PNG){  // image was binary png or jpg in source file
+            base64String = g_base64_encode((guchar*) px, numCt );
+        }
+        else if(mempng.buffer){                             // image was DIB in source file, converted to png in this routine
+            base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
+            free(mempng.buffer);
+        }
+        else {                                              // unknown or unsupported image type or failed conversion, insert the common bad image picture
+            width  = 3;
+            height = 4;
+            base64String = bad_image_png();
+        }
 
-    idx = in_images(d, (char *) base64String);
-    auto & defs = d->defs;
-    if(!idx){  // add it if not already present - we looked at the actual data for comparison
-        if(d->images.count == d->images.size){  enlarge_images(d); }
-        idx = d->images.count;
-        d->images.strings[d->images.count++]=strdup(base64String);
+        idx = add_string(d->images, key.c_str());
 
-        safeprintf(imagename,"EMFimage%d",idx++);
+        safeprintf(imagename,"EMFimage%d",idx-1);
         safeprintf(xywh," x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" ",width,height); // reuse this buffer
 
         defs += "\n";
@@ -560,6 +558,7 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
         defs += "\"\n";
         defs += "    preserveAspectRatio=\"none\"\n";
         defs += "    />\n";
+        g_free(base64String);
 
 
         defs += "\n";
@@ -578,7 +577,9 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
         defs += "    ";
         defs += "   </pattern>\n";
     }
-    g_free(base64String);//wait until this point to free because it might be a duplicate image
+    else {
+        safeprintf(imagename,"EMFimage%d",idx-1);
+    }
 
     /*  image allows the inner image to be rotated nicely, load this one second only if needed
         imagename retained from above
@@ -592,13 +593,10 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
     if(current_rotation(d) >= 0.00001 || current_rotation(d) <= -0.00001){ /* some rotation, allow a little rounding error around 0 degrees */
         int tangle = round(current_rotation(d)*1000000.0);
         safeprintf(imrotname,"EMFrotimage%d_%d",idx-1,tangle);
-        base64String = g_base64_encode((guchar*) imrotname, strlen(imrotname) );
-        idx = in_images(d, (char *) base64String); // scan for this "image"
+        idx = in_images(d, imrotname); // scan for this "image"
         if(!idx){
-            if(d->images.count == d->images.size){  enlarge_images(d); }
-            idx = d->images.count;
-            d->images.strings[d->images.count++]=strdup(base64String);
-            safeprintf(imrotname,"EMFimage%d",idx++);
+            idx = add_string(d->images, imrotname);
+            safeprintf(imrotname,"EMFimage%d",idx-1);
 
             defs += "\n";
             defs += "   <pattern\n";
@@ -612,27 +610,15 @@ uint32_t Emf::add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint
             defs += current_matrix(d, 0.0, 0.0, 0); //j use offset 0,0
             defs += " />\n";
         }
-        g_free(base64String);
     }
 
     return(idx-1);
 }
 
-/*  Add another 100 blank slots to the gradients array.
-*/
-void Emf::enlarge_gradients(PEMF_CALLBACK_DATA d){
-    d->gradients.size += 100;
-    d->gradients.strings = (char **) realloc(d->gradients.strings,d->gradients.size * sizeof(char *));
-}
-
 /*  See if the gradient name is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Emf::in_gradients(PEMF_CALLBACK_DATA d, const char *test){
-    int i;
-    for(i=0; i<d->gradients.count; i++){
-        if(strcmp(test,d->gradients.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->gradients, test));
 }
 
 U_COLORREF trivertex_to_colorref(U_TRIVERTEX tv){
@@ -689,8 +675,7 @@ uint32_t Emf::add_gradient(PEMF_CALLBACK_DATA d, uint32_t gradientType, U_TRIVER
     
     idx = in_gradients(d,hgradname);
     if(!idx){ // gradient does not yet exist
-        if(d->gradients.count == d->gradients.size){  enlarge_gradients(d); }
-        d->gradients.strings[d->gradients.count++]=strdup(hgradname);
+        add_string(d->gradients, hgradname);
         idx = d->gradients.count;
         SVGOStringStream stmp;
         stmp <<  "   <linearGradient id=\"";
@@ -726,21 +711,10 @@ uint32_t Emf::add_gradient(PEMF_CALLBACK_DATA d, uint32_t gradientType, U_TRIVER
     return(idx-1);
 }
 
-/*  Add another 100 blank slots to the clips array.
-*/
-void Emf::enlarge_clips(PEMF_CALLBACK_DATA d){
-    d->clips.size += 100;
-    d->clips.strings = (char **) realloc(d->clips.strings,d->clips.size * sizeof(char *));
-}
-
 /*  See if the pattern name is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Emf::in_clips(PEMF_CALLBACK_DATA d, const char *test){
-    int i;
-    for(i=0; i<d->clips.count; i++){
-        if(strcmp(test,d->clips.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->clips, test));
 }
 
 /*  (Conditionally) add a clip.  
@@ -764,8 +738,7 @@ void Emf::add_clips(PEMF_CALLBACK_DATA d, const char *clippath, unsigned int log
 
     uint32_t idx = in_clips(d, combined.c_str());
     if(!idx){  // add clip if not already present
-        if(d->clips.count == d->clips.size){  enlarge_clips(d); }
-        d->clips.strings[d->clips.count++] = strdup(combined.c_str());
+        add_string(d->clips, combined.c_str());
         d->dc[d->level].clip_id = d->clips.count;  // one more than the slot where it is actually stored
         SVGOStringStream tmp_clippath;
         tmp_clippath << "\n<clipPath";
@@ -3535,11 +3508,13 @@ std::cout << "BEFORE DRAW"
     return(file_status);
 }
 
-void Emf::free_emf_strings(EMF_STRINGS name){
+void Emf::free_emf_strings(EMF_STRINGS &name){
+    name.index.clear();
     if(name.count){
         for(int i=0; i< name.count; i++){ free(name.strings[i]); }
         free(name.strings);
     }
+    name.strings = nullptr;
     name.count = 0;
     name.size = 0;
 }
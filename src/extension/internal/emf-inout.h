@@ -13,6 +13,9 @@
 #ifndef SEEN_EXTENSION_INTERNAL_EMF_H
 #define SEEN_EXTENSION_INTERNAL_EMF_H
 
+#include <string_view>
+#include <unordered_map>
+
 #include <3rdparty/libuemf/uemf.h>
 #include <3rdparty/libuemf/uemf_safe.h>
 #include <3rdparty/libuemf/uemf_endian.h> // for U_emf_record_sizeok()
@@ -41,6 +44,7 @@ struct EMF_STRINGS {
     int size = 0;               // number of slots allocated in strings
     int count = 0;              // number of slots used in strings
     char **strings = nullptr;   // place to store strings
+    std::unordered_map<std::string_view, int> index; // position (1->n) of each of the strings
 };
 using PEMF_STRINGS = EMF_STRINGS *;
 
@@ -193,18 +197,16 @@ protected:
     static double      current_scale(PEMF_CALLBACK_DATA d);
     static std::string current_matrix(PEMF_CALLBACK_DATA d, double x, double y, int useoffset);
     static double      current_rotation(PEMF_CALLBACK_DATA d);
-    static void        enlarge_hatches(PEMF_CALLBACK_DATA d);
+    static int         add_string(EMF_STRINGS &list, const char *string);
+    static int         find_string(const EMF_STRINGS &list, const char *test);
     static int         in_hatches(PEMF_CALLBACK_DATA d, char *test);
     static uint32_t    add_hatch(PEMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hatchColor);
-    static void        enlarge_images(PEMF_CALLBACK_DATA d);
     static int         in_images(PEMF_CALLBACK_DATA d, const char *test);
     static uint32_t    add_image(PEMF_CALLBACK_DATA d,  void *pEmr, uint32_t cbBits, uint32_t cbBmi, 
                             uint32_t iUsage, uint32_t offBits, uint32_t offBmi);
-    static void        enlarge_gradients(PEMF_CALLBACK_DATA d);
     static int         in_gradients(PEMF_CALLBACK_DATA d, const char *test);
     static uint32_t    add_gradient(PEMF_CALLBACK_DATA d, uint32_t gradientType, U_TRIVERTEX tv1, U_TRIVERTEX tv2);
 
-    static void        enlarge_clips(PEMF_CALLBACK_DATA d);
     static int         in_clips(PEMF_CALLBACK_DATA d, const char *test);
     static void        add_clips(PEMF_CALLBACK_DATA d, const char *clippath, unsigned int logic);
 
@@ -228,7 +230,7 @@ protected:
                             double dx, double dy, double dw, double dh, int sx, int sy, int sw, int sh,  
                             uint32_t iUsage, uint32_t offBits, uint32_t cbBits, uint32_t offBmi, uint32_t cbBmi);
     static int         myEnhMetaFileProc(char *contents, unsigned int length, PEMF_CALLBACK_DATA d);
-    static void        free_emf_strings(EMF_STRINGS name);
+    static void        free_emf_strings(EMF_STRINGS &name);
 
 };
 
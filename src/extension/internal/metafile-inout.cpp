@@ -274,6 +274,42 @@ gchar *Metafile::bad_image_png(){
     return(gstring);
 }
 
+/* Return a key identifying an image by the bytes it has in the metafile record, so that repeated
+images can be found before they are converted to PNG and base64 encoded.
+dibparams, px, ct, numCt, width, height, colortype and invert are as returned by get_DIB_params(),
+with ct possibly replaced by the colors actually used.
+All images which cannot be converted share one key, as they all become bad_image_png().
+*/
+std::string Metafile::image_key(int dibparams, const char *px, const U_RGBQUAD *ct, uint32_t numCt,
+    int32_t width, int32_t height, int32_t colortype, int32_t invert){
+
+    size_t size;
+    if(px && (dibparams == U_BI_JPEG || dibparams == U_BI_PNG)){
+        size  = numCt;      // for these numCt is the size of the embedded file
+        ct    = nullptr;
+        numCt = 0;
+    }
+    else if(px && dibparams == U_BI_RGB && width > 0 && height > 0 && colortype > 0){
+        size  = (((size_t) width * colortype + 31) / 32) * 4 * height; // rows are padded to 4 bytes
+    }
+    else {
+        return("bad");
+    }
+
+    char params[128];
+    snprintf(params, sizeof(params), "%d;%d;%d;%d;%d;%u;", dibparams, width, height, colortype, invert, numCt);
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *) params, strlen(params));
+    if(ct && numCt){
+        g_checksum_update(checksum, (const guchar *) ct, numCt * sizeof(U_RGBQUAD));
+    }
+    g_checksum_update(checksum, (const guchar *) px, size);
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return(key);
+}
+
 
 
 } // namespace Internal
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <map>
 #include <stack>
+#include <string>
 #include <glibmm/ustring.h>
 #include <3rdparty/libuemf/uemf.h>
 #include <2geom/affine.h>
@@ -69,6 +70,8 @@ protected:
     static void        my_png_write_data(png_structp png_ptr, png_bytep data, png_size_t length);
     static void        toPNG(PMEMPNG accum, int width, int height, const char *px);
     static gchar      *bad_image_png();
+    static std::string image_key(int dibparams, const char *px, const U_RGBQUAD *ct, uint32_t numCt,
+                            int32_t width, int32_t height, int32_t colortype, int32_t invert);
     static void        setViewBoxIfMissing(SPDocument *doc);
     static int         combine_ops_to_livarot(const int op);
 
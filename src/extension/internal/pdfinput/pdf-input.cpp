@@ -129,6 +129,7 @@ PdfImportDialog::PdfImportDialog(std::shared_ptr<PDFDoc> doc, const gchar * /*ur
     , _page_numbers(UI::get_widget<Gtk::Entry>(_builder, "page-numbers"))
     , _preview_area(UI::get_widget<Gtk::DrawingArea>(_builder, "preview-area"))
     , _embed_images(UI::get_widget<Gtk::CheckButton>(_builder, "embed-images"))
+    , _merge_paths(UI::get_widget<Gtk::CheckButton>(_builder, "merge-paths"))
     , _mesh_slider(UI::get_widget<Gtk::Scale>(_builder, "mesh-slider"))
     , _mesh_label(UI::get_widget<Gtk::Label>(_builder, "mesh-label"))
     , _next_page(UI::get_widget<Gtk::Button>(_builder, "next-page"))
@@ -261,6 +262,7 @@ void PdfImportDialog::getImportSettings(Inkscape::XML::Node *prefs) {
     prefs->setAttribute("cropTo", clip_to.get_active_id());
     prefs->setAttributeSvgDouble("approximationPrecision", _mesh_slider.get_value());
     prefs->setAttributeBoolean("embedImages", _embed_images.get_active());
+    prefs->setAttributeBoolean("mergePaths", _merge_paths.get_active());
 }
 
 /**
@@ -680,6 +682,8 @@ PdfInput::open(::Inkscape::Extension::Input * /*mod*/, const gchar * uri) {
             // And then add each of the pages
             add_builder_page(pdf_doc, builder, doc, p);
         }
+        builder->simplifyLayers();
+        builder->reportMergedPaths();
 
         delete builder;
         g_free(docname);
@@ -825,6 +829,8 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
             pdf_parser.build_annots(annots.arrayGet(i), page_num);
         }
     }
+
+    builder->endPage();
 }
 
 #include "../clear-n_.h"
@@ -107,6 +107,7 @@ private:
     Gtk::Entry &_page_numbers;
     Gtk::DrawingArea &_preview_area;
     Gtk::CheckButton &_embed_images;
+    Gtk::CheckButton &_merge_paths;
     Gtk::Scale &_mesh_slider;
     Gtk::Label &_mesh_label;
     Gtk::Button &_next_page;
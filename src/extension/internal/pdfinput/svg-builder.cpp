@@ -18,6 +18,7 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <cstring>
 #include <string>
 #include <locale>
 #include <codecvt>
@@ -37,6 +38,7 @@
 #include "png.h"
 #include "poppler-cairo-font-engine.h"
 #include "profile-manager.h"
+#include "svg-simplifier.h"
 
 #include "color/cms-util.h"
 #include "display/cairo-utils.h"
@@ -96,6 +98,9 @@ SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
 
 SvgBuilder::~SvgBuilder()
 {
+    if (_is_top_level) {
+        endPage();
+    }
     if (_clip_history) {
         delete _clip_history;
         _clip_history = nullptr;
@@ -127,6 +132,7 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
     }
     _page_num += 1;
     _page_offset = true;
+    endPage();
 
     if (_page) {
         Inkscape::GC::release(_page);
@@ -164,11 +170,70 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
         while (_container != _root) {
             _popGroup();
         }
-        _pushGroup();
+        // The layer is filled while detached from the document, so that no objects are built
+        // or updated for each element added; endPage() attaches the finished page in one go.
+        _page_layer = _pushContainer("svg:g");
         setAsLayer(label.c_str(), true);
     }
 }
 
+/**
+ * Attach the layer of the page that was being built to the document.
+ */
+void SvgBuilder::endPage()
+{
+    if (!_page_layer) {
+        return;
+    }
+    auto layer = _page_layer;
+    _page_layer = nullptr;
+    _page_layer_ids.clear();
+    if (auto simplifier = _getSimplifier()) {
+        simplifier->simplifyLayers({layer});
+    }
+    _root->appendChild(layer);
+    Inkscape::GC::release(layer);
+}
+
+/**
+ * Simplify the layers of the optional content groups. Unlike the layers of pages, they are
+ * shared by all pages, so this waits until all of them are in.
+ */
+void SvgBuilder::simplifyLayers()
+{
+    if (auto simplifier = _getSimplifier()) {
+        simplifier->simplifyLayers(_ocg_layers);
+    }
+    _ocg_layers.clear();
+}
+
+/**
+ * The simplifier, if the paths are to be merged.
+ */
+SvgSimplifier *SvgBuilder::_getSimplifier()
+{
+    if (!_preferences->getAttributeBoolean("mergePaths", false)) {
+        return nullptr;
+    }
+    if (!_simplifier) {
+        // Classes from earlier imports into the same document must keep their styles.
+        char prefix[32];
+        g_snprintf(prefix, sizeof(prefix), "pdf-%08x-", g_random_int());
+        _simplifier = std::make_unique<SvgSimplifier>(_root, _doc->getDefs()->getRepr(), prefix);
+    }
+    return _simplifier.get();
+}
+
+/**
+ * Tell how much merging paths and sharing styles has simplified the imported drawing.
+ */
+void SvgBuilder::reportMergedPaths() const
+{
+    if (_simplifier) {
+        _simplifier->report();
+    }
+}
+
 void SvgBuilder::setDocumentSize(double width, double height) {
     this->_width = width;
     this->_height = height;
@@ -330,6 +395,9 @@ Inkscape::XML::Node *SvgBuilder::_addToContainer(const char *name)
  */
 void SvgBuilder::_addToContainer(Inkscape::XML::Node *node, bool release)
 {
+    if (_container == _root) {
+        endPage(); // Keep the stacking order
+    }
     if (!node->parent()) {
         _container->appendChild(node);
     }
@@ -356,12 +424,43 @@ void SvgBuilder::_setClipPath(Inkscape::XML::Node *node)
 Inkscape::XML::Node *SvgBuilder::_pushGroup()
 {
     Inkscape::XML::Node *saved_container = _container;
+    if (saved_container == _root) {
+        endPage(); // Keep the stacking order
+    }
     Inkscape::XML::Node *node = _pushContainer("svg:g");
     saved_container->appendChild(node);
     Inkscape::GC::release(node);
     return _container;
 }
 
+/**
+ * Find an element by id, including the layers of the page that isn't part of the document yet.
+ */
+Inkscape::XML::Node *SvgBuilder::_getNodeById(const std::string &id)
+{
+    if (auto found = _page_layer_ids.find(id); found != _page_layer_ids.end()) {
+        return found->second;
+    }
+    if (auto obj = _doc->getObjectById(id)) {
+        return obj->getRepr();
+    }
+    return nullptr;
+}
+
+/**
+ * Give a layer its id, remembering it for _getNodeById() while the page is detached, or for
+ * simplifyLayers() if it is outside of any page.
+ */
+void SvgBuilder::_setLayerId(Inkscape::XML::Node *node, const std::string &id)
+{
+    node->setAttribute("id", id);
+    if (_page_layer) {
+        _page_layer_ids[id] = node;
+    } else {
+        _ocg_layers.push_back(node);
+    }
+}
+
 Inkscape::XML::Node *SvgBuilder::_popGroup()
 {
     if (_container != _root) { // Pop if the current container isn't root
@@ -841,9 +940,9 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
 {
     if (name && group && std::string(name) == "OC") {
         auto layer_id = std::string("layer-") + group;
-        if (auto existing = _doc->getObjectById(layer_id)) {
-            if (existing->getRepr()->parent() == _container) {
-                _container = existing->getRepr();
+        if (auto existing = _getNodeById(layer_id)) {
+            if (existing->parent() == _container) {
+                _container = existing;
                 _node_stack.push_back(_container);
             } else {
                 g_warning("Unexpected marked content group in PDF!");
@@ -851,7 +950,7 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
             }
         } else {
             auto node = _pushGroup();
-            node->setAttribute("id", layer_id);
+            _setLayerId(node, layer_id);
             if (_ocgs.find(group) != _ocgs.end()) {
                 auto pair = _ocgs[group];
                 setAsLayer(pair.first.c_str(), pair.second);
@@ -873,15 +972,15 @@ void SvgBuilder::addOptionalGroup(const std::string &oc, const std::string &labe
 Inkscape::XML::Node *SvgBuilder::beginLayer(const std::string &label, bool visible)
 {
     Inkscape::XML::Node *save_current_location = _container;
-    if (auto existing = _doc->getObjectById(label)){
-        _container = existing->getRepr();
+    if (auto existing = _getNodeById(label)) {
+        _container = existing;
         _node_stack.push_back(_container);
     } else {
         while (_container != _root) {
             _popGroup();
         }
         auto node = _pushGroup();
-        node->setAttribute("id", label.c_str());
+        _setLayerId(node, label);
         setAsLayer(label.c_str(), visible);
     } 
     return save_current_location;
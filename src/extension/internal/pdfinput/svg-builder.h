@@ -67,6 +67,8 @@ namespace Inkscape {
 namespace Extension {
 namespace Internal {
 
+class SvgSimplifier;
+
 /**
  * Holds information about glyphs added by PdfParser which haven't been added
  * to the document yet.
@@ -108,6 +110,9 @@ public:
         return _preferences;
     }
     void pushPage(const std::string &label, GfxState *state);
+    void endPage();
+    void simplifyLayers();
+    void reportMergedPaths() const;
 
     // Path adding
     bool shouldMergePath(bool is_fill, const std::string &path);
@@ -208,6 +213,9 @@ private:
 
     // Handling of node stack
     Inkscape::XML::Node *_pushGroup();
+    Inkscape::XML::Node *_getNodeById(const std::string &id);
+    void _setLayerId(Inkscape::XML::Node *node, const std::string &id);
+    SvgSimplifier *_getSimplifier();
     Inkscape::XML::Node *_popGroup();
     Inkscape::XML::Node *_pushContainer(const char *name);
     Inkscape::XML::Node *_pushContainer(Inkscape::XML::Node *node);
@@ -262,6 +270,8 @@ private:
     double _height;       // Document size in px
 
     Inkscape::XML::Node *_page = nullptr; // XML Page definition
+    Inkscape::XML::Node *_page_layer = nullptr; // Layer of the current page, built detached until endPage()
+    std::map<std::string, Inkscape::XML::Node *> _page_layer_ids; // Layers by id in _page_layer
     int _page_num = 0; // Are we on a page
     double _page_left = 0 ; // Move to the left for more pages
     double _page_top = 0 ; // Move to the top (maybe)
@@ -269,6 +279,9 @@ private:
     Geom::Affine _page_affine = Geom::identity();
 
     std::map<std::string, std::pair<std::string, bool>> _ocgs;
+    std::vector<Inkscape::XML::Node *> _ocg_layers; // Layers shared by the pages, simplified at the end
+
+    std::unique_ptr<SvgSimplifier> _simplifier; // Merges paths and shares styles, if asked to
 
     std::string _icc_profile;
     std::map<cmsHPROFILE, std::string> _icc_profiles;
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Merging paths and sharing styles in the SVG built from PDF pages.
+ *//*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "svg-simplifier.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+#include <glib.h>
+#include <2geom/pathvector.h>
+
+#include "svg/svg.h"
+#include "xml/document.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+namespace Inkscape {
+namespace Extension {
+namespace Internal {
+
+SvgSimplifier::SvgSimplifier(Inkscape::XML::Node *root, Inkscape::XML::Node *defs, std::string class_prefix)
+    : _root(root)
+    , _defs(defs)
+    , _class_prefix(std::move(class_prefix))
+{}
+
+/**
+ * Merge the paths and share the styles in each of the layers. A layer inside another one is
+ * simplified along with it.
+ */
+void SvgSimplifier::simplifyLayers(std::vector<Inkscape::XML::Node *> const &layers)
+{
+    auto const listed = std::unordered_set<Inkscape::XML::Node *>(layers.begin(), layers.end());
+    for (auto layer : layers) {
+        bool nested = false;
+        for (auto parent = layer->parent(); parent && !nested; parent = parent->parent()) {
+            nested = listed.count(parent);
+        }
+        if (!nested) {
+            mergeSiblingPaths(layer);
+            shareStyles(layer);
+        }
+    }
+}
+
+/**
+ * Whether this is a path that only draws its outline, so that adding the subpaths of its
+ * identical neighbours to it doesn't change how it renders.
+ */
+bool SvgSimplifier::_canMergePath(Inkscape::XML::Node *node)
+{
+    if (std::strcmp(node->name(), "svg:path") || node->firstChild() || !node->attribute("d")
+        || node->attribute("id") || node->attribute("mask")) {
+        return false;
+    }
+    auto style = node->attribute("style");
+    if (!style) {
+        return false;
+    }
+    auto found = _mergeable_styles.find(style);
+    if (found != _mergeable_styles.end()) {
+        return found->second;
+    }
+    // Filled paths could cancel out each other's overlaps, and translucent strokes would no
+    // longer darken where they cross.
+    auto css = sp_repr_css_attr(node, "style");
+    bool mergeable = std::string(sp_repr_css_property(css, "fill", "")) == "none"
+                  && sp_repr_css_double_property(css, "opacity", 1.0) == 1.0
+                  && sp_repr_css_double_property(css, "stroke-opacity", 1.0) == 1.0
+                  && std::string(sp_repr_css_property(css, "mix-blend-mode", "normal")) == "normal";
+    sp_repr_css_attr_unref(css);
+    _mergeable_styles.emplace(style, mergeable);
+    return mergeable;
+}
+
+static bool same_but_path_data(Inkscape::XML::Node const *a, Inkscape::XML::Node const *b)
+{
+    if (a->attributeList().size() != b->attributeList().size()) {
+        return false;
+    }
+    for (auto const &attr : a->attributeList()) {
+        auto key = g_quark_to_string(attr.key);
+        auto other = b->attribute(key);
+        if (std::strcmp(key, "d") && (!other || std::strcmp(other, attr.value))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Join each run of sibling paths which only differ in their path data into one path.
+ * CAD drawings often draw every line segment as a path of its own.
+ */
+void SvgSimplifier::mergeSiblingPaths(Inkscape::XML::Node *parent)
+{
+    Inkscape::XML::Node *run = nullptr;
+    Geom::PathVector run_pathv;
+    bool run_merged = false;
+    auto end_run = [&] {
+        if (run_merged) {
+            run->setAttribute("d", sp_svg_write_path(run_pathv));
+        }
+        run = nullptr;
+        run_pathv.clear();
+        run_merged = false;
+    };
+
+    for (auto child = parent->firstChild(); child;) {
+        auto next = child->next();
+        if (!std::strcmp(child->name(), "svg:g")) {
+            end_run();
+            mergeSiblingPaths(child);
+        } else if (!_canMergePath(child)) {
+            end_run();
+        } else {
+            auto pathv = sp_svg_read_pathv(child->attribute("d"));
+            if (run && same_but_path_data(run, child)) {
+                run_pathv.insert(run_pathv.end(), pathv.begin(), pathv.end());
+                run_merged = true;
+                parent->removeChild(child);
+                _paths_merged++;
+            } else {
+                end_run();
+                run = child;
+                run_pathv = pathv;
+                _paths_kept++;
+            }
+        }
+        child = next;
+    }
+    end_run();
+}
+
+/**
+ * Replace the inline styles which are used more than once by classes from a style sheet. Once
+ * there are MAX_STYLE_CLASSES classes, the other styles stay inline; the most used ones get
+ * classes first.
+ */
+void SvgSimplifier::shareStyles(Inkscape::XML::Node *layer)
+{
+    std::vector<Inkscape::XML::Node *> styled;
+    std::map<std::string, int> uses;
+    auto collect = [&](auto &self, Inkscape::XML::Node *parent) -> void {
+        for (auto child = parent->firstChild(); child; child = child->next()) {
+            auto style = child->attribute("style");
+            // Id references in style sheets are not updated when ids clash on paste
+            if (style && !child->attribute("class") && !std::strstr(style, "url(")) {
+                styled.push_back(child);
+                uses[style]++;
+            }
+            self(self, child);
+        }
+    };
+    collect(collect, layer);
+
+    std::vector<std::pair<std::string, int>> candidates;
+    for (auto const &[style, count] : uses) {
+        if (count >= 2 && !_style_classes.count(style)) {
+            candidates.emplace_back(style, count);
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [] (auto const &a, auto const &b) { return a.second > b.second; });
+
+    std::string rules;
+    for (auto const &[style, count] : candidates) {
+        if (_style_classes.size() >= MAX_STYLE_CLASSES) {
+            break;
+        }
+        auto name = _class_prefix + std::to_string(_style_classes.size() + 1);
+        rules += "." + name + "{" + style + "}\n";
+        _style_classes.emplace(style, name);
+    }
+
+    for (auto node : styled) {
+        auto cls = _style_classes.find(node->attribute("style"));
+        if (cls == _style_classes.end()) {
+            continue;
+        }
+        node->setAttribute("class", cls->second);
+        node->removeAttribute("style");
+        _styles_shared++;
+    }
+    if (rules.empty()) {
+        return;
+    }
+
+    auto xml_doc = _root->document();
+    if (!_style_sheet) {
+        _style_sheet = xml_doc->createElement("svg:style");
+        _root->addChild(_style_sheet, _defs);
+        Inkscape::GC::release(_style_sheet);
+    }
+    auto text = xml_doc->createTextNode(rules.c_str());
+    _style_sheet->appendChild(text);
+    Inkscape::GC::release(text);
+}
+
+/**
+ * Tell how much merging paths and sharing styles has simplified the imported drawing.
+ */
+void SvgSimplifier::report() const
+{
+    if (!_paths_merged && !_styles_shared) {
+        return;
+    }
+    g_message("PDF import: merged %d paths into %d, and replaced %d inline styles by %zu classes.",
+              _paths_merged + _paths_kept, _paths_kept, _styles_shared, _style_classes.size());
+}
+
+} // namespace Internal
+} // namespace Extension
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
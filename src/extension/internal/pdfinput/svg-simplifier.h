@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Merging paths and sharing styles in the SVG built from PDF pages.
+ *//*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_EXTENSION_INTERNAL_PDFINPUT_SVG_SIMPLIFIER_H
+#define SEEN_EXTENSION_INTERNAL_PDFINPUT_SVG_SIMPLIFIER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Inkscape {
+namespace XML {
+class Node;
+} // namespace XML
+
+namespace Extension {
+namespace Internal {
+
+/**
+ * Makes drawings from CAD tools, which draw every line segment as a path of its own, lighter
+ * without changing how they render. Each page is simplified once it is finished; the shared
+ * styles are kept for the following pages.
+ */
+class SvgSimplifier
+{
+public:
+    /// Every element is matched against every class when styles cascade, so only this many are made.
+    static constexpr std::size_t MAX_STYLE_CLASSES = 64;
+
+    /**
+     * @param root The root of the document, which gets the style sheet after @a defs.
+     * @param class_prefix Start of the names of the style classes, which must not be used by
+     *                     anything else in the document, including earlier imports.
+     */
+    SvgSimplifier(Inkscape::XML::Node *root, Inkscape::XML::Node *defs, std::string class_prefix);
+
+    void simplifyLayers(std::vector<Inkscape::XML::Node *> const &layers);
+    void mergeSiblingPaths(Inkscape::XML::Node *parent);
+    void shareStyles(Inkscape::XML::Node *layer);
+    void report() const;
+
+    int pathsMerged() const { return _paths_merged; }
+    int pathsKept() const { return _paths_kept; }
+    int stylesShared() const { return _styles_shared; }
+    std::size_t styleClasses() const { return _style_classes.size(); }
+
+private:
+    bool _canMergePath(Inkscape::XML::Node *node);
+
+    Inkscape::XML::Node *_root;
+    Inkscape::XML::Node *_defs;
+    std::string _class_prefix;
+
+    Inkscape::XML::Node *_style_sheet = nullptr; // Rules of the shared style classes
+    std::map<std::string, std::string> _style_classes; // Class of each shared style
+    std::map<std::string, bool> _mergeable_styles; // Whether paths with this style can be merged
+    int _paths_merged = 0;
+    int _paths_kept = 0;
+    int _styles_shared = 0;
+};
+
+} // namespace Internal
+} // namespace Extension
+} // namespace Inkscape
+
+#endif // SEEN_EXTENSION_INTERNAL_PDFINPUT_SVG_SIMPLIFIER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
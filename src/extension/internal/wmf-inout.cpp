@@ -197,21 +197,30 @@ double Wmf::current_rotation(PWMF_CALLBACK_DATA /*d*/){
     return 0.0;
 }
 
-/*  Add another 100 blank slots to the hatches array.
+/*  Add a copy of the string to the list, growing it by 100 slots at a time.  Return its position (1->n, not 1-n-1)
 */
-void Wmf::enlarge_hatches(PWMF_CALLBACK_DATA d){
-    d->hatches.size += 100;
-    d->hatches.strings = (char **) realloc(d->hatches.strings,d->hatches.size * sizeof(char *));
+int Wmf::add_string(WMF_STRINGS &list, const char *string){
+    if(list.count == list.size){
+        list.size += 100;
+        list.strings = (char **) realloc(list.strings,list.size * sizeof(char *));
+    }
+    list.strings[list.count] = strdup(string);
+    list.index.emplace(list.strings[list.count], list.count + 1);
+    return(++list.count);
+}
+
+/*  See if the string is already in the list.  If it is return its position (1->n, not 1-n-1)
+    This is a hash lookup, lists may hold many thousands of entries.
+*/
+int Wmf::find_string(const WMF_STRINGS &list, const char *test){
+    auto found = list.index.find(test);
+    return(found == list.index.end() ? 0 : found->second);
 }
 
 /*  See if the pattern name is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Wmf::in_hatches(PWMF_CALLBACK_DATA d, char *test){
-    int i;
-    for(i=0; i<d->hatches.count; i++){
-        if(strcmp(test,d->hatches.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->hatches, test));
 }
 
 class TagEmitter
@@ -271,8 +280,7 @@ uint32_t Wmf::add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
     safeprintf(hpathname,"WMFhpath%d_%s",hatchType,tmpcolor);
     idx = in_hatches(d,hpathname);
     if(!idx){  // add path/color if not already present
-        if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-        d->hatches.strings[d->hatches.count++]=strdup(hpathname);
+        add_string(d->hatches, hpathname);
 
         defs += "\n";
         switch(hatchType){
@@ -370,8 +378,7 @@ uint32_t Wmf::add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hpathname,"WMFhpath%d_%s",hatchType,tmpcolor);
         idx = in_hatches(d,hatchname);
         if(!idx){  // add it if not already present
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hatchname);
+            add_string(d->hatches, hatchname);
             defs += "\n";
             defs += "   <pattern id=\"";
             defs += hatchname;
@@ -387,8 +394,7 @@ uint32_t Wmf::add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hbkname,"WMFhbkclr_%s",bkcolor);
         idx = in_hatches(d,hbkname);
         if(!idx){  // add path/color if not already present.  Hatchtype is not needed in the name.
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hbkname);
+            add_string(d->hatches, hbkname);
 
             defs += "\n";
             defs += "   <rect id=\"";
@@ -402,8 +408,7 @@ uint32_t Wmf::add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
         safeprintf(hatchname,"WMFhatch%d_%s_%s",hatchType,tmpcolor,bkcolor);
         idx = in_hatches(d,hatchname);
         if(!idx){  // add it if not already present
-            if(d->hatches.count == d->hatches.size){  enlarge_hatches(d); }
-            d->hatches.strings[d->hatches.count++]=strdup(hatchname);
+            add_string(d->hatches, hatchname);
             defs += "\n";
             defs += "   <pattern id=\"";
             defs += hatchname;
@@ -419,21 +424,10 @@ uint32_t Wmf::add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hat
     return(idx-1);
 }
 
-/*  Add another 100 blank slots to the images array.
-*/
-void Wmf::enlarge_images(PWMF_CALLBACK_DATA d){
-    d->images.size += 100;
-    d->images.strings = (char **) realloc(d->images.strings,d->images.size * sizeof(char *));
-}
-
 /*  See if the image string is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
-int Wmf::in_images(PWMF_CALLBACK_DATA d, char *test){
-    int i;
-    for(i=0; i<d->images.count; i++){
-        if(strcmp(test,d->images.strings[i])==0)return(i+1);
-    }
-    return(0);
+int Wmf::in_images(PWMF_CALLBACK_DATA d, const char *test){
+    return(find_string(d->images, test));
 }
 
 /*  (Conditionally) add an image from a DIB.  If a matching image already exists nothing happens.  If one
@@ -453,11 +447,20 @@ uint32_t Wmf::add_dib_image(PWMF_CALLBACK_DATA d, const char *dib, uint32_t iUsa
     char            *rgba_px = nullptr;     // RGBA pixels
     const char      *px      = nullptr;     // DIB pixels
     const U_RGBQUAD *ct      = nullptr;     // DIB color table
-    uint32_t numCt;
-    int32_t  width, height, colortype, invert; // if needed these values will be set by wget_DIB_params
+    uint32_t numCt = 0;
+    int32_t  width = 0, height = 0, colortype = 0, invert = 0; // if needed these values will be set by wget_DIB_params
     if(iUsage == U_DIB_RGB_COLORS){
         // next call returns pointers and values, but allocates no memory
         dibparams = wget_DIB_params(dib, &px, &ct, &numCt, &width, &height, &colortype, &invert);
+    }
+
+    /*  Look the image up by its bytes in the record, so that an image which is used many times is
+        only converted and encoded once.
+    */
+    std::string key = image_key(dibparams, px, ct, numCt, width, height, colortype, invert);
+    idx = in_images(d, key.c_str());
+    auto & defs = d->defs;
+    if(!idx){  // add it if not already present - we looked at the actual data for comparison
         if(dibparams == U_BI_RGB){
             if(!DIB_to_RGBA(
                 px,         // DIB pixel array
@@ -478,29 +481,24 @@ uint32_t Wmf::add_dib_image(PWMF_CALLBACK_DATA d, const char *dib, uint32_t iUsa
                 free(rgba_px);
             }
         }
-    }
 
-    gchar *base64String=nullptr;
-    if(dibparams == U_BI_JPEG || dibparams==U_BI_PNG){  // image was binary png or jpg in source file
-        base64String = g_base64_encode((guchar*) px, numCt );
-    }
-    else if(mempng.buffer){                             // image was DIB in source file, converted to png in this routine
-        base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
-        free(mempng.buffer);
-    }
-    else {                         // failed conversion, insert the common bad image picture
-        width  = 3;
-        height = 4;
-        base64String = bad_image_png();
-    }
-    idx = in_images(d, (char *) base64String);
-    auto & defs = d->defs;
-    if(!idx){  // add it if not already present - we looked at the actual data for comparison
-        if(d->images.count == d->images.size){  enlarge_images(d); }
-        idx = d->images.count;
-        d->images.strings[d->images.count++]=strdup(base64String);
+        gchar *base64String=nullptr;
+        if(dibparams == U_BI_JPEG || dibparams==U_BI_PNG){  // image was binary png or jpg in source file
+            base64String = g_base64_encode((guchar*) px, numCt );
+        }
+        else if(mempng.buffer){                             // image was DIB in source file, converted to png in this routine
+            base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
+            free(mempng.buffer);
+        }
+        else {                         // failed conversion, insert the common bad image picture
+            width  = 3;
+            height = 4;
+            base64String = bad_image_png();
+        }
+
+        idx = add_string(d->images, key.c_str());
 
-        safeprintf(imagename,"WMFimage%d",idx++);
+        safeprintf(imagename,"WMFimage%d",idx-1);
         safeprintf(xywh," x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" ",width,height); // reuse this buffer
 
         defs += "\n";
@@ -515,6 +513,7 @@ uint32_t Wmf::add_dib_image(PWMF_CALLBACK_DATA d, const char *dib, uint32_t iUsa
         defs += "\"\n";
         defs += " preserveAspectRatio=\"none\"\n";
         defs += "   />\n";
+        g_free(base64String);
 
 
         defs += "\n";
@@ -533,7 +532,6 @@ uint32_t Wmf::add_dib_image(PWMF_CALLBACK_DATA d, const char *dib, uint32_t iUsa
         defs += "    ";
         defs += "   </pattern>\n";
     }
-    g_free(base64String); //wait until this point to free because it might be a duplicate image
     return(idx-1);
 }
 
@@ -560,44 +558,46 @@ uint32_t Wmf::add_bm16_image(PWMF_CALLBACK_DATA d, U_BITMAP16 Bm16, const char *
     invert    = 0;
     if(colortype < 16)return(U_WMR_INVALID);  // these would need a colortable if they were a dib, no idea what bm16 is supposed to do instead.
 
-    if(!DIB_to_RGBA(// This is not really a dib, but close enough so that it still works.
-        px,         // DIB pixel array
-        ct,         // DIB color table (always NULL here)
-        numCt,      // DIB color table number of entries (always 0)
-        &rgba_px,   // U_RGBA pixel array (32 bits), created by this routine, caller must free.
-        width,      // Width of pixel array
-        height,     // Height of pixel array
-        colortype,  // DIB BitCount Enumeration
-        numCt,      // Color table used if not 0
-        invert      // If DIB rows are in opposite order from RGBA rows
-    )){
-        toPNG(         // Get the image from the RGBA px into mempng
-            &mempng,
-            width, height,    // of the SRC bitmap
-            rgba_px
-        );
-        free(rgba_px);
-    }
-
-    gchar *base64String=nullptr;
-    if(mempng.buffer){             // image was Bm16 in source file, converted to png in this routine
-        base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
-        free(mempng.buffer);
-    }
-    else {                         // failed conversion, insert the common bad image picture
-        width  = 3;
-        height = 4;
-        base64String = bad_image_png();
-    }
-
-    idx = in_images(d, (char *) base64String);
+    /*  Look the image up by its bytes in the record, so that an image which is used many times is
+        only converted and encoded once.
+    */
+    std::string key = image_key(U_BI_RGB, px, ct, numCt, width, height, colortype, invert);
+    idx = in_images(d, key.c_str());
     auto & defs = d->defs;
     if(!idx){  // add it if not already present - we looked at the actual data for comparison
-        if(d->images.count == d->images.size){  enlarge_images(d); }
-        idx = d->images.count;
-        d->images.strings[d->images.count++]=g_strdup(base64String);
-
-        safeprintf(imagename,"WMFimage%d",idx++);
+        if(!DIB_to_RGBA(// This is not really a dib, but close enough so that it still works.
+            px,         // DIB pixel array
+            ct,         // DIB color table (always NULL here)
+            numCt,      // DIB color table number of entries (always 0)
+            &rgba_px,   // U_RGBA pixel array (32 bits), created by this routine, caller must free.
+            width,      // Width of pixel array
+            height,     // Height of pixel array
+            colortype,  // DIB BitCount Enumeration
+            numCt,      // Color table used if not 0
+            invert      // If DIB rows are in opposite order from RGBA rows
+        )){
+            toPNG(         // Get the image from the RGBA px into mempng
+                &mempng,
+                width, height,    // of the SRC bitmap
+                rgba_px
+            );
+            free(rgba_px);
+        }
+
+        gchar *base64String=nullptr;
+        if(mempng.buffer){             // image was Bm16 in source file, converted to png in this routine
+            base64String = g_base64_encode((guchar*) mempng.buffer, mempng.size );
+            free(mempng.buffer);
+        }
+        else {                         // failed conversion, insert the common bad image picture
+            width  = 3;
+            height = 4;
+            base64String = bad_image_png();
+        }
+
+        idx = add_string(d->images, key.c_str());
+
+        safeprintf(imagename,"WMFimage%d",idx-1);
         safeprintf(xywh," x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" ",width,height); // reuse this buffer
 
         defs += "\n";
@@ -611,6 +611,7 @@ uint32_t Wmf::add_bm16_image(PWMF_CALLBACK_DATA d, U_BITMAP16 Bm16, const char *
         defs += "\"\n";
         defs += " preserveAspectRatio=\"none\"\n";
         defs += "   />\n";
+        g_free(base64String);
 
 
         defs += "\n";
@@ -628,25 +629,13 @@ uint32_t Wmf::add_bm16_image(PWMF_CALLBACK_DATA d, U_BITMAP16 Bm16, const char *
         defs += "\" />\n";
         defs += "   </pattern>\n";
     }
-    g_free(base64String); //wait until this point to free because it might be a duplicate image
     return(idx-1);
 }
 
-/*  Add another 100 blank slots to the clips array.
-*/
-void Wmf::enlarge_clips(PWMF_CALLBACK_DATA d){
-    d->clips.size += 100;
-    d->clips.strings = (char **) realloc(d->clips.strings,d->clips.size * sizeof(char *));
-}
-
 /*  See if the pattern name is already in the list.  If it is return its position (1->n, not 1-n-1)
 */
 int Wmf::in_clips(PWMF_CALLBACK_DATA d, const char *test){
-    int i;
-    for(i=0; i<d->clips.count; i++){
-        if(strcmp(test,d->clips.strings[i])==0)return(i+1);
-    }
-    return(0);
+    return(find_string(d->clips, test));
 }
 
 /*  (Conditionally) add a clip.  
@@ -670,8 +659,7 @@ void Wmf::add_clips(PWMF_CALLBACK_DATA d, const char *clippath, unsigned int log
 
     uint32_t idx = in_clips(d, combined.c_str());
     if(!idx){  // add clip if not already present
-        if(d->clips.count == d->clips.size){  enlarge_clips(d); }
-        d->clips.strings[d->clips.count++] = strdup(combined.c_str());
+        add_string(d->clips, combined.c_str());
         d->dc[d->level].clip_id = d->clips.count;  // one more than the slot where it is actually stored
         SVGOStringStream tmp_clippath;
         tmp_clippath << "\n<clipPath";
@@ -3092,11 +3080,13 @@ std::cout << "BEFORE DRAW"
     return(file_status);
 }
 
-void Wmf::free_wmf_strings(WMF_STRINGS name){
+void Wmf::free_wmf_strings(WMF_STRINGS &name){
+    name.index.clear();
     if(name.count){
         for(int i=0; i< name.count; i++){ free(name.strings[i]); }
         free(name.strings);
     }
+    name.strings = nullptr;
     name.count = 0;
     name.size = 0;
 }
@@ -12,6 +12,9 @@
 #ifndef SEEN_EXTENSION_INTERNAL_WMF_H
 #define SEEN_EXTENSION_INTERNAL_WMF_H
 
+#include <string_view>
+#include <unordered_map>
+
 #include <3rdparty/libuemf/uwmf.h>
 #include "extension/internal/metafile-inout.h"  // picks up PNG
 #include "extension/implementation/implementation.h"
@@ -38,6 +41,7 @@ struct WMF_STRINGS {
     int size = 0;               // number of slots allocated in strings
     int count = 0;              // number of slots used in strings
     char **strings = nullptr;   // place to store strings
+    std::unordered_map<std::string_view, int> index; // position (1->n) of each of the strings
 };
 using PWMF_STRINGS = WMF_STRINGS *;
 
@@ -185,15 +189,14 @@ protected:
    static double      current_scale(PWMF_CALLBACK_DATA d);
    static std::string current_matrix(PWMF_CALLBACK_DATA d, double x, double y, int useoffset);
    static double      current_rotation(PWMF_CALLBACK_DATA d);
-   static void        enlarge_hatches(PWMF_CALLBACK_DATA d);
+   static int         add_string(WMF_STRINGS &list, const char *string);
+   static int         find_string(const WMF_STRINGS &list, const char *test);
    static int         in_hatches(PWMF_CALLBACK_DATA d, char *test);
    static uint32_t    add_hatch(PWMF_CALLBACK_DATA d, uint32_t hatchType, U_COLORREF hatchColor);
-   static void        enlarge_images(PWMF_CALLBACK_DATA d);
-   static int         in_images(PWMF_CALLBACK_DATA d, char *test);
+   static int         in_images(PWMF_CALLBACK_DATA d, const char *test);
    static uint32_t    add_dib_image(PWMF_CALLBACK_DATA d, const char *dib, uint32_t iUsage);
    static uint32_t    add_bm16_image(PWMF_CALLBACK_DATA d, U_BITMAP16 Bm16, const char *px);
 
-   static void        enlarge_clips(PWMF_CALLBACK_DATA d);
    static int         in_clips(PWMF_CALLBACK_DATA d, const char *test);
    static void        add_clips(PWMF_CALLBACK_DATA d, const char *clippath, unsigned int logic);
 
@@ -216,7 +219,7 @@ protected:
    static void        common_bm16_to_image(PWMF_CALLBACK_DATA d, U_BITMAP16 Bm16, const char *px,
                          double dx, double dy, double dw, double dh, int sx, int sy, int sw, int sh);
    static int         myMetaFileProc(const char *contents, unsigned int length, PWMF_CALLBACK_DATA d);
-   static void        free_wmf_strings(WMF_STRINGS name);
+   static void        free_wmf_strings(WMF_STRINGS &name);
 
 };
 
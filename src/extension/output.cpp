@@ -15,6 +15,7 @@
 
 #include "io/sys.h"
 #include "implementation/implementation.h"
+#include "object/sp-image.h"
 
 #include "xml/attribute-record.h"
 #include "xml/node.h"
@@ -220,6 +221,7 @@ Output::save(SPDocument *doc, gchar const *filename, bool detachbase)
     if (loaded()) {
         imp->setDetachBase(detachbase);
         auto new_doc = doc->copy();
+        sp_image_finish_decoding(new_doc.get());
         new_doc->ensureUpToDate();
         run_processing_actions(new_doc.get());
         imp->save(this, new_doc.get(), filename);
@@ -20,8 +20,8 @@
 #include "display/drawing-context.h"
 #include "display/drawing.h"
 #include "helper/pixbuf-ops.h"
+#include "object/sp-image.h"
 #include "object/sp-root.h"
-#include "util/scope_exit.h"
 #include "util/units.h"
 
 /**
@@ -46,47 +46,63 @@ Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
         return nullptr;
     }
 
+    return OffscreenBitmap(document, area, dpi, items, opaque).render(checkerboard_color, device_scale);
+}
+
+OffscreenBitmap::OffscreenBitmap(SPDocument *document, Geom::Rect const &area, double dpi,
+                                 std::vector<SPItem const *> const &items, bool opaque)
+    : _document(document)
+    , _dkey(SPItem::display_key_new(1))
+    , _drawing(std::make_unique<Inkscape::Drawing>()) // New drawing for offscreen rendering.
+{
     Geom::Point origin = area.min();
     double scale_factor = Inkscape::Util::Quantity::convert(dpi, "px", "in");
     Geom::Affine affine = Geom::Translate(-origin) * Geom::Scale (scale_factor, scale_factor);
 
-    int width  = std::ceil(scale_factor * area.width());
-    int height = std::ceil(scale_factor * area.height());
+    _width  = std::ceil(scale_factor * area.width());
+    _height = std::ceil(scale_factor * area.height());
 
     // Document
+    sp_image_finish_decoding(document);
     document->ensureUpToDate();
-    unsigned dkey = SPItem::display_key_new(1);
 
     // Drawing
-    Inkscape::Drawing drawing; // New drawing for offscreen rendering.
-    drawing.setRoot(document->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
-    auto invoke_hide_guard = scope_exit([&] { document->getRoot()->invoke_hide(dkey); });
-    drawing.root()->setTransform(affine);
-    drawing.setExact(); // Maximum quality for blurs.
+    _drawing->setRoot(document->getRoot()->invoke_show(*_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+    _drawing->root()->setTransform(affine);
+    _drawing->setExact(); // Maximum quality for blurs.
 
     // Hide all items we don't want, instead of showing only requested items,
     // because that would not work if the shown item references something in defs.
     if (!items.empty()) {
-        document->getRoot()->invoke_hide_except(dkey, items);
+        document->getRoot()->invoke_hide_except(_dkey, items);
     }
 
-    auto final_area = Geom::IntRect::from_xywh(0, 0, width, height);
-    drawing.update(final_area);
+    _drawing->update(Geom::IntRect::from_xywh(0, 0, _width, _height));
 
     if (opaque) {
         // Required by sp_asbitmap_render().
         for (auto item : items) {
-            if (item->get_arenaitem(dkey)) {
-                item->get_arenaitem(dkey)->setOpacity(1.0);
+            if (item->get_arenaitem(_dkey)) {
+                item->get_arenaitem(_dkey)->setOpacity(1.0);
             }
         }
     }
+}
+
+OffscreenBitmap::~OffscreenBitmap()
+{
+    _document->getRoot()->invoke_hide(_dkey);
+}
+
+Inkscape::Pixbuf *OffscreenBitmap::render(uint32_t const *checkerboard_color, double device_scale) const
+{
+    auto final_area = Geom::IntRect::from_xywh(0, 0, _width, _height);
 
     // Rendering
-    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, _width, _height);
 
     if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
-        long long size = (long long)height * (long long)cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+        long long size = (long long)_height * (long long)cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, _width);
         g_warning("sp_generate_internal_bitmap: not enough memory to create pixel buffer. Need %lld.", size);
         cairo_surface_destroy(surface);
         return nullptr;
@@ -106,7 +122,7 @@ Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
     }
 
     // render items
-    drawing.render(dc, final_area, Inkscape::DrawingItem::RENDER_BYPASS_CACHE);
+    _drawing->render(dc, final_area, Inkscape::DrawingItem::RENDER_BYPASS_CACHE);
 
     if (device_scale != 1.0) {
         cairo_surface_set_device_scale(surface, device_scale, device_scale);
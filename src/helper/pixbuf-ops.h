@@ -13,13 +13,17 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <memory>
 #include <vector>
 #include <cstdint>
 #include <2geom/forward.h>
 
 class SPDocument;
 class SPItem;
-namespace Inkscape { class Pixbuf; }
+namespace Inkscape {
+class Drawing;
+class Pixbuf;
+} // namespace Inkscape
 
 Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
                                               Geom::Rect const &area,
@@ -28,4 +32,31 @@ Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
                                               bool set_opaque = false,
                                               uint32_t const *checkerboard_color = nullptr,
                                               double device_scale = 1.0);
+
+/**
+ * The work of sp_generate_internal_bitmap() split in two, so that the expensive rendering can
+ * run on another thread. The constructor and destructor show and hide the document in a drawing
+ * of its own and must run on the main thread. render() may be called from any thread, as long
+ * as the document isn't modified meanwhile.
+ */
+class OffscreenBitmap
+{
+public:
+    OffscreenBitmap(SPDocument *document, Geom::Rect const &area, double dpi,
+                    std::vector<SPItem const *> const &items = {}, bool set_opaque = false);
+    ~OffscreenBitmap();
+    OffscreenBitmap(OffscreenBitmap const &) = delete;
+    OffscreenBitmap &operator=(OffscreenBitmap const &) = delete;
+
+    /// Render the bitmap. Returns nullptr if rendering failed.
+    Inkscape::Pixbuf *render(uint32_t const *checkerboard_color = nullptr, double device_scale = 1.0) const;
+
+private:
+    SPDocument *_document;
+    unsigned _dkey;
+    std::unique_ptr<Inkscape::Drawing> _drawing;
+    int _width;
+    int _height;
+};
+
 #endif // INKSCAPE_HELPER_PIXBUF_OPS_H
@@ -31,6 +31,7 @@
 #include "io/sys.h"
 
 #include "object/sp-defs.h"
+#include "object/sp-image.h"
 #include "object/sp-item.h"
 #include "object/sp-root.h"
 
@@ -404,6 +405,7 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 	return EXPORT_ABORTED;
     }
 
+    sp_image_finish_decoding(doc);
     doc->ensureUpToDate();
 
     /* Calculate translation by transforming to document coordinates (flipping Y)*/
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Inkscape::GC::Arena - block allocator for objects that die together
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "inkgc/gc-arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace Inkscape {
+namespace GC {
+
+namespace {
+
+std::atomic<std::ptrdiff_t> total_size{0};
+std::atomic<std::ptrdiff_t> total_used{0};
+
+}
+
+/**
+ * Per-arena counters, kept in a separate finalizable object so that they can be subtracted
+ * from the totals when the arena is reclaimed. The arena itself cannot be finalizable: it is
+ * part of a cycle (arena, blocks, objects pointing back at their owner) and the collector
+ * refuses to finalize cycles.
+ */
+struct Arena::Usage {
+    std::ptrdiff_t size = 0;
+    std::ptrdiff_t used = 0;
+
+    static void cleanup(void *mem, void *)
+    {
+        auto usage = static_cast<Usage *>(mem);
+        total_size -= usage->size;
+        total_used -= usage->used;
+    }
+};
+
+Arena::Arena()
+    : _usage(new (ATOMIC, AUTO, &Usage::cleanup) Usage)
+{}
+
+void Arena::_addUsage(std::ptrdiff_t size, std::ptrdiff_t used)
+{
+    _usage->size += size;
+    _usage->used += used;
+    total_size += size;
+    total_used += used;
+}
+
+void *Arena::allocate(std::size_t size)
+{
+    size = std::max<std::size_t>((size + GRANULE - 1) / GRANULE * GRANULE, GRANULE);
+
+    if (size <= MAX_RECYCLED) {
+        auto &head = _free_lists[size / GRANULE];
+        if (head) {
+            void *mem = head;
+            head = *static_cast<void **>(mem);
+            *static_cast<void **>(mem) = nullptr;
+            _addUsage(0, size);
+            return mem;
+        }
+    }
+
+    if (static_cast<std::size_t>(_end - _cur) < size) {
+        std::size_t const block_size = std::max(_next_block_size, size);
+        auto block = static_cast<char *>(::operator new(block_size, SCANNED, AUTO));
+        _blocks.push_back(block);
+        _cur = block;
+        _end = block + block_size;
+        _next_block_size = std::min(_next_block_size + _next_block_size / 2, MAX_BLOCK);
+        _addUsage(block_size, 0);
+    }
+
+    void *mem = _cur;
+    _cur += size;
+    _addUsage(0, size);
+    return mem;
+}
+
+void Arena::deallocate(void *mem, std::size_t size)
+{
+    if (!mem) {
+        return;
+    }
+
+    size = std::max<std::size_t>((size + GRANULE - 1) / GRANULE * GRANULE, GRANULE);
+    _addUsage(0, -static_cast<std::ptrdiff_t>(size));
+
+    if (size <= MAX_RECYCLED) {
+        // Clear the block so that stale pointers in it do not keep anything alive.
+        std::memset(mem, 0, size);
+        auto &head = _free_lists[size / GRANULE];
+        *static_cast<void **>(mem) = head;
+        head = mem;
+    }
+}
+
+char *Arena::copy_string(char const *string, std::size_t length)
+{
+    auto copy = static_cast<char *>(allocate(length + 1));
+    std::memcpy(copy, string, length);
+    copy[length] = 0;
+    return copy;
+}
+
+Arena::Stats Arena::stats() const
+{
+    return { static_cast<std::size_t>(_usage->size), static_cast<std::size_t>(_usage->used) };
+}
+
+Arena::Stats Arena::total_stats()
+{
+    return { static_cast<std::size_t>(total_size.load()), static_cast<std::size_t>(total_used.load()) };
+}
+
+}
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Inkscape::GC::Arena - block allocator for objects that die together
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_GC_ARENA_H
+#define SEEN_INKSCAPE_GC_ARENA_H
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "inkgc/gc-alloc.h"
+#include "inkgc/gc-managed.h"
+
+namespace Inkscape {
+
+namespace GC {
+
+/**
+ * An Arena hands out memory from a small number of large blocks obtained from the collector,
+ * for objects that share a lifetime, such as the nodes of one XML document.
+ *
+ * The blocks are ordinary scanned, collected memory that is reachable only through the arena.
+ * Pointers stored in arena objects therefore keep their targets alive as usual, and the blocks
+ * are reclaimed together as soon as neither the arena nor any object in them is reachable.
+ * Nothing is ever freed explicitly, so a stray reference into an arena cannot dangle.
+ *
+ * Small blocks returned with deallocate() are recycled through per-size free lists; larger ones
+ * are only reclaimed with the arena.
+ *
+ * The arena itself must be allocated with the collector (it derives from Managed) and held
+ * from collected or root memory. It is not thread-safe.
+ */
+class Arena : public Managed<> {
+public:
+    struct Stats {
+        std::size_t size;       ///< Bytes obtained from the collector.
+        std::size_t bytes_used; ///< Bytes handed out and not returned.
+    };
+
+    Arena();
+    Arena(Arena const &) = delete;
+    Arena &operator=(Arena const &) = delete;
+
+    /// Allocate a block of the given size. Alignment is at most alignof(std::max_align_t).
+    void *allocate(std::size_t size);
+    /// Return a block obtained from allocate() with the same size.
+    void deallocate(void *mem, std::size_t size);
+    /// Copy a string into the arena, adding a terminating NUL.
+    char *copy_string(char const *string, std::size_t length);
+
+    Stats stats() const;
+    /// Totals over all arenas that have not yet been reclaimed.
+    static Stats total_stats();
+
+private:
+    static constexpr std::size_t GRANULE = alignof(std::max_align_t);
+    static constexpr std::size_t MAX_RECYCLED = 512;
+    static constexpr std::size_t MIN_BLOCK = 16 * 1024;
+    static constexpr std::size_t MAX_BLOCK = 1024 * 1024;
+
+    struct Usage;
+
+    std::vector<void *, Alloc<void *>> _blocks;
+    char *_cur = nullptr;
+    char *_end = nullptr;
+    std::size_t _next_block_size = MIN_BLOCK;
+    std::array<void *, MAX_RECYCLED / GRANULE + 1> _free_lists{};
+    Usage *_usage;
+
+    void _addUsage(std::ptrdiff_t size, std::ptrdiff_t used);
+};
+
+/**
+ * Allocator that takes memory from an Arena if it was constructed with one, and from the
+ * collector (like Alloc<T>) otherwise.
+ *
+ * Copies of a container do not inherit its arena: a copy made outside the arena's owner must not
+ * quietly pin the whole arena.
+ */
+template <typename T>
+class ArenaAlloc {
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef std::size_t size_type;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAlloc() = default;
+    explicit ArenaAlloc(Arena *arena) : _arena(arena) {}
+    template <typename U> ArenaAlloc(ArenaAlloc<U> const &other) : _arena(other.arena()) {}
+
+    pointer allocate(size_type count) {
+        if (_arena) {
+            return static_cast<pointer>(_arena->allocate(count * sizeof(T)));
+        }
+        return Alloc<T>().allocate(count);
+    }
+
+    void deallocate(pointer p, size_type count) {
+        if (_arena) {
+            _arena->deallocate(p, count * sizeof(T));
+        } else {
+            Alloc<T>().deallocate(p, count);
+        }
+    }
+
+    ArenaAlloc select_on_container_copy_construction() const { return {}; }
+
+    Arena *arena() const { return _arena; }
+
+private:
+    Arena *_arena = nullptr;
+};
+
+template <typename T1, typename T2>
+bool operator==(ArenaAlloc<T1> const &a, ArenaAlloc<T2> const &b) {
+    return a.arena() == b.arena();
+}
+
+template <typename T1, typename T2>
+bool operator!=(ArenaAlloc<T1> const &a, ArenaAlloc<T2> const &b) {
+    return a.arena() != b.arena();
+}
+
+}
+
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -1601,6 +1601,20 @@ Effect::doEffect (SPCurve * curve)
     curve->set_pathvector(result_pathv);
 }
 
+std::string
+Effect::geometryCacheKey() const
+{
+    std::string key = std::to_string(effectType());
+    for (auto param : param_vector) {
+        key += ';';
+        key += param->param_key.raw();
+        key += '=';
+        key += param->param_getSVGValue().raw();
+    }
+    extendGeometryCacheKey(key);
+    return key;
+}
+
 Geom::PathVector
 Effect::doEffect_path (Geom::PathVector const & path_in)
 {
@@ -104,6 +104,24 @@ public:
 
     virtual void doEffect (SPCurve * curve);
 
+    /**
+     * Whether doEffect() is a pure function of its input path, the parameter values and what
+     * extendGeometryCacheKey() adds, so that its output can be reused while none of these change.
+     * Effects that keep state between runs or read the item in doEffect() must not claim this.
+     */
+    bool isPureGeometry() const { return _pure_geometry; }
+    /// Everything besides the input path that the output of a pure-geometry effect depends on.
+    std::string geometryCacheKey() const;
+    /// Helper paths filled in by doEffect() of a pure-geometry effect, kept with its output.
+    virtual Geom::PathVector *geometryCacheHelperPaths() { return nullptr; }
+    /**
+     * Whether doEffect() of a pure-geometry effect may run on a worker thread, next to the
+     * effects of other items. It must then only touch the curve and the effect's own members,
+     * and not read the preferences, the document or the desktop. Effects shared between several
+     * items always run on the main thread.
+     */
+    virtual bool isThreadSafe() const { return false; }
+
     virtual Gtk::Widget * newWidget();
     /**
      * Sets all parameters to their default values and writes them to SVG.
@@ -191,6 +209,9 @@ protected:
     // this boolean defaults to false, it concatenates the input path to one pwd2,
     // instead of normally 'splitting' the path into continuous pwd2 paths and calling doEffect_pwd2 for each.
     bool concatenate_before_pwd2;
+    bool _pure_geometry = false; // see isPureGeometry()
+    /// Add what else doEffect() depends on to @a key, in pure-geometry effects.
+    virtual void extendGeometryCacheKey(std::string &/*key*/) const {}
     double current_zoom;
     std::vector<Geom::Point> selectedNodesPoints;
     Inkscape::UI::Widget::Registry wr;
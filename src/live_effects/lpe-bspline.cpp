@@ -58,10 +58,18 @@ LPEBSpline::LPEBSpline(LivePathEffectObject *lpeobject)
     helper_size.param_set_range(0.0, 999.0);
     helper_size.param_set_increments(1, 1);
     helper_size.param_set_digits(2);
+
+    _pure_geometry = true;
 }
 
 LPEBSpline::~LPEBSpline() = default;
 
+void LPEBSpline::extendGeometryCacheKey(std::string &key) const
+{
+    // The helper paths depend on it.
+    key += Inkscape::Preferences::get()->getBool("/tools/nodes/show_outline", true) ? ";outline" : "";
+}
+
 void LPEBSpline::doBeforeEffect (SPLPEItem const* /*lpeitem*/)
 {
     if(!hp.empty()) {
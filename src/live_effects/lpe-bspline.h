@@ -30,6 +30,7 @@ public:
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
     void doBSplineFromWidget(SPCurve *curve, double value);
     void addCanvasIndicators(SPLPEItem const */*lpeitem*/, std::vector<Geom::PathVector> &hp_vec) override;
+    Geom::PathVector *geometryCacheHelperPaths() override { return &hp; }
     Gtk::Widget *newWidget() override;
     void changeWeight(double weightValue);
     void toDefaultWeight();
@@ -40,6 +41,9 @@ public:
     ScalarParam steps;
     BoolParam uniform;
 
+protected:
+    void extendGeometryCacheKey(std::string &key) const override;
+
 private:
     ScalarParam helper_size;
     BoolParam apply_no_weight;
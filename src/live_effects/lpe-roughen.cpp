@@ -84,6 +84,9 @@ LPERoughen::LPERoughen(LivePathEffectObject *lpeobject)
     segments.param_set_increments(1, 1);
     seed = 0;
     apply_to_clippath_and_mask = true;
+    // The randomizers restart from their seeds, which are part of the parameter values, in
+    // doBeforeEffect().
+    _pure_geometry = true;
 }
 
 LPERoughen::~LPERoughen() = default;
@@ -179,6 +182,12 @@ Gtk::Widget *LPERoughen::newWidget()
     return vbox;
 }
 
+bool LPERoughen::isThreadSafe() const
+{
+    // Before 1.1 the signs came from the global rand().
+    return lpeversion.param_getSVGValue() >= "1.1";
+}
+
 double LPERoughen::sign(double random_number)
 {
     if (lpeversion.param_getSVGValue() < "1.1") {
@@ -48,6 +48,7 @@ public:
 
     void doOnApply(SPLPEItem const *lpeitem) override;
     void doEffect(SPCurve *curve) override;
+    bool isThreadSafe() const override;
     virtual double sign(double randNumber);
     virtual Geom::Point randomize(double max_length, bool is_node = false);
     void doBeforeEffect(SPLPEItem const * lpeitem) override;
@@ -59,6 +59,7 @@ LPESimplify::LPESimplify(LivePathEffectObject *lpeobject)
     setVersioningData();
     radius_helper_nodes = 6.0;
     apply_to_clippath_and_mask = true;
+    _pure_geometry = true;
 }
 
 LPESimplify::~LPESimplify() = default;
@@ -73,6 +74,18 @@ LPESimplify::doBeforeEffect (SPLPEItem const* lpeitem)
     radius_helper_nodes = helper_size;
 }
 
+void
+LPESimplify::extendGeometryCacheKey(std::string &key) const
+{
+    // The threshold is relative to the size of the item in document units.
+    double const values[] = {
+        bbox ? bbox->width() : 0.0,
+        bbox ? bbox->height() : 0.0,
+        sp_lpe_item ? sp_lpe_item->i2doc_affine().descrim() : 1.0,
+    };
+    key.append(reinterpret_cast<char const *>(values), sizeof(values));
+}
+
 void
 LPESimplify::setVersioningData()
 {
@@ -23,6 +23,7 @@ public:
     LPESimplify &operator=(const LPESimplify &) = delete;
 
     void doEffect(SPCurve *curve) override;
+    Geom::PathVector *geometryCacheHelperPaths() override { return &hp; }
 
     void doBeforeEffect (SPLPEItem const* lpeitem) override;
 
@@ -41,6 +42,7 @@ public:
 
   protected:
     void addCanvasIndicators(SPLPEItem const */*lpeitem*/, std::vector<Geom::PathVector> &hp_vec) override;
+    void extendGeometryCacheKey(std::string &key) const override;
 
 private:
     void setVersioningData();
@@ -18,15 +18,20 @@
 #include <2geom/path-intersection.h>
 #include <2geom/path-sink.h>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 #include "desktop.h"
 #include "display/curve.h"
 #include "document.h"
 #include "preferences.h"
 #include "snap-enums.h"
+#include "snap-target-index.h"
 #include "text-editing.h"
 #include "page-manager.h"
 
+#include "helper/auto-connection.h"
+
 #include "object/sp-flowtext.h"
 #include "object/sp-item.h"
 #include "object/sp-path.h"
@@ -37,17 +42,57 @@
 #include "object/sp-text.h"
 #include "path/path-util.h" // curve_for_item
 
+/**
+ * Spatial indices over _points_to_snap_to and the curves of _paths_to_snap_to, so that a snap
+ * only has to look at the targets within tolerance. They are rebuilt together with the lists.
+ */
+struct Inkscape::ObjectSnapper::Indices
+{
+    SnapTargetIndex points;
+    SnapTargetIndex curves;
+
+    struct Curve
+    {
+        unsigned candidate; ///< Index in _paths_to_snap_to.
+        unsigned path;      ///< Index in its path vector.
+        unsigned curve;     ///< Index in its path.
+    };
+    std::vector<Curve> curve_info; ///< Indexed by the number of the entry in curves.
+    unsigned candidates_indexed = 0;
+};
+
+/**
+ * The snap points of candidate items, kept from one snap to the next until the item is modified
+ * or released, so that starting a drag need not recompute them for every item in range. The whole
+ * cache is dropped when anything else the points depend on changes.
+ */
+struct Inkscape::ObjectSnapper::ItemPoints
+{
+    struct Entry
+    {
+        std::vector<SnapCandidatePoint> points;
+        auto_connection modified;
+        auto_connection release;
+    };
+
+    std::unordered_map<SPItem *, Entry> entries;
+    std::optional<SnapPreferences> snapprefs; ///< The preferences the entries were computed with.
+    Geom::Affine doc2dt;
+};
+
 Inkscape::ObjectSnapper::ObjectSnapper(SnapManager *sm, Geom::Coord const d)
     : Snapper(sm, d)
 {
     _points_to_snap_to = std::make_unique<std::vector<SnapCandidatePoint>>();
     _paths_to_snap_to = std::make_unique<std::vector<SnapCandidatePath>>();
+    _indices = std::make_unique<Indices>();
+    _item_points = std::make_unique<ItemPoints>();
 }
 
 Inkscape::ObjectSnapper::~ObjectSnapper()
 {
     _points_to_snap_to->clear();
-    _clear_paths();
+    _paths_to_snap_to->clear();
 }
 
 Geom::Coord Inkscape::ObjectSnapper::getSnapperTolerance() const
@@ -70,6 +115,7 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
     // first point and store the collection for later use. This significantly improves the performance
     if (first_point) {
         _points_to_snap_to->clear();
+        _indices->points.clear(2 * getSnapperTolerance());
 
          // Determine the type of bounding box we should snap to
         SPItem::BBoxType bbox_type = SPItem::GEOMETRIC_BBOX;
@@ -122,6 +168,19 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
             }
         }
 
+        // Cached snap points are only valid for the preferences they were computed with, which
+        // below always have intersections disabled when snapping to paths.
+        auto snapprefs = _snapmanager->snapprefs;
+        if (snapprefs.isTargetSnappable(SNAPTARGET_PATH)) {
+            snapprefs.setTargetSnappable(SNAPTARGET_PATH_INTERSECTION, false);
+        }
+        auto const doc2dt = _snapmanager->getDesktop() ? _snapmanager->getDesktop()->doc2dt() : Geom::identity();
+        if (!_item_points->snapprefs || !_item_points->snapprefs->sameTargets(snapprefs) || _item_points->doc2dt != doc2dt) {
+            _item_points->entries.clear();
+            _item_points->snapprefs = snapprefs;
+            _item_points->doc2dt = doc2dt;
+        }
+
         for (const auto & _candidate : *_snapmanager->_obj_snapper_candidates) {
             SPItem *root_item = _candidate.item;
             g_return_if_fail(root_item);
@@ -169,7 +228,14 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
                     }
                 }
 
-                root_item->getSnappoints(*_points_to_snap_to, &_snapmanager->snapprefs);
+                // The points of a clone depend on its original, which does not notify the clone when
+                // it changes, so these are not cached.
+                if (_snapmanager->snapprefs.sameTargets(snapprefs) && !is<SPUse>(root_item)) {
+                    auto const &points = _getItemSnappoints(root_item);
+                    _points_to_snap_to->insert(_points_to_snap_to->end(), points.begin(), points.end());
+                } else {
+                    root_item->getSnappoints(*_points_to_snap_to, &_snapmanager->snapprefs);
+                }
 
                 // restore the original snap preferences
                 _snapmanager->snapprefs.setTargetSnappable(SNAPTARGET_PATH_INTERSECTION, old_pref);
@@ -189,7 +255,27 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
                 }
             }
         }
+
+        for (auto const &k : *_points_to_snap_to) {
+            _indices->points.insert(k.getPoint());
+        }
+    }
+}
+
+/**
+ * Return the snap points of @a item, computed with the preferences in _item_points, from the cache
+ * if possible.
+ */
+std::vector<Inkscape::SnapCandidatePoint> const &Inkscape::ObjectSnapper::_getItemSnappoints(SPItem *item) const
+{
+    auto [it, inserted] = _item_points->entries.try_emplace(item);
+    auto &entry = it->second;
+    if (inserted) {
+        item->getSnappoints(entry.points, &_snapmanager->snapprefs);
+        entry.modified = item->connectModified([this, item] (SPObject *, unsigned) { _item_points->entries.erase(item); });
+        entry.release = item->connectRelease([this, item] (SPObject *) { _item_points->entries.erase(item); });
     }
+    return entry.points;
 }
 
 void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
@@ -202,16 +288,11 @@ void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
 
     _collectNodes(p.getSourceType(), p.getSourceNum() <= 0);
 
-    if (unselected_nodes != nullptr && unselected_nodes->size() > 0) {
-        g_assert(_points_to_snap_to != nullptr);
-        _points_to_snap_to->insert(_points_to_snap_to->end(), unselected_nodes->begin(), unselected_nodes->end());
-    }
-
     SnappedPoint s;
     bool success = false;
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
 
-    for (const auto & k : *_points_to_snap_to) {
+    auto snap_to = [&] (SnapCandidatePoint const &k) {
         if (_allowSourceToSnapToTarget(p.getSourceType(), k.getTargetType(), strict_snapping)) {
             Geom::Point target_pt = k.getPoint();
             Geom::Coord dist = Geom::L2(target_pt - p.getPoint()); // Default: free (unconstrained) snapping
@@ -221,7 +302,7 @@ void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
                 if (Geom::L2(target_pt - c.projection(target_pt)) > 1e-9) {
                     // The distance from the target point to its projection on the constraint
                     // is too large, so this point is not on the constraint. Skip it!
-                    continue;
+                    return;
                 }
                 dist = Geom::L2(target_pt - p_proj_on_constraint);
             }
@@ -232,6 +313,20 @@ void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
                 success = true;
             }
         }
+    };
+
+    // Only the points within tolerance of where we measure from can be snapped to
+    Geom::Point const origin = c.isUndefined() ? p.getPoint() : p_proj_on_constraint;
+    Geom::Rect area(origin, origin);
+    area.expandBy(getSnapperTolerance());
+    for (auto i : _indices->points.query(area)) {
+        snap_to((*_points_to_snap_to)[i]);
+    }
+
+    if (unselected_nodes != nullptr) {
+        for (auto const &k : *unselected_nodes) {
+            snap_to(k);
+        }
     }
 
     if (success) {
@@ -256,7 +351,14 @@ void Inkscape::ObjectSnapper::_snapTranslatingGuide(IntermSnapResults &isr,
     Geom::Coord tol = getSnapperTolerance();
     bool always = getSnapperAlwaysSnap(SNAPSOURCE_GUIDE);
 
-    for (const auto & k : *_points_to_snap_to) {
+    // Unless always snapping, a node must be within tol of the guide, and its projection on the
+    // guide within tol of p, so it is within 2 * tol of p.
+    Geom::Rect area(p, p);
+    area.expandBy(2 * tol);
+    auto const ids = always ? std::vector<unsigned>() : _indices->points.query(area);
+
+    for (unsigned i = 0, n = always ? _points_to_snap_to->size() : ids.size(); i < n; i++) {
+        auto const &k = (*_points_to_snap_to)[always ? i : ids[i]];
         Geom::Point target_pt = k.getPoint();
         // Project each node (*k) on the guide line (running through point p)
         Geom::Point p_proj = Geom::projection(target_pt, Geom::Line(p, p + Geom::rot90(guide_normal)));
@@ -425,83 +527,112 @@ void Inkscape::ObjectSnapper::_snapPaths(IntermSnapResults &isr,
         }
     }
 
-    int num_path = 0; // _paths_to_snap_to contains multiple path_vectors, each containing multiple paths.
-                      // num_path will count the paths, and will not be zeroed for each path_vector. It will
-                      // continue counting
+    _indexPaths();
 
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
     bool snap_perp = _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_PATH_PERPENDICULAR);
     bool snap_tang = _snapmanager->snapprefs.isTargetSnappable(Inkscape::SNAPTARGET_PATH_TANGENTIAL);
 
-    //dt->getSnapIndicator()->remove_debugging_points();
+    // _paths_to_snap_to contains multiple path_vectors, each containing multiple paths. The paths
+    // we may snap to are numbered consecutively over all path_vectors; first_num_path holds the
+    // number of the first path of each path_vector.
+    std::vector<int> first_num_path;
+    first_num_path.reserve(_paths_to_snap_to->size());
+    int num_paths = 0;
     for (const auto & it_p : *_paths_to_snap_to) {
+        first_num_path.push_back(num_paths);
+        if (_allowSourceToSnapToTarget(p.getSourceType(), it_p.target_type, strict_snapping)) {
+            num_paths += it_p.path_vector.size();
+        }
+    }
+
+    // Only the curves whose bounds come within tolerance of p can be snapped to
+    Geom::Rect area(p_doc, p_doc);
+    area.expandBy(getSnapperTolerance());
+
+    //dt->getSnapIndicator()->remove_debugging_points();
+    for (auto id : _indices->curves.query(area)) {
+        auto const &info = _indices->curve_info[id];
+        auto const &it_p = (*_paths_to_snap_to)[info.candidate];
         if (_allowSourceToSnapToTarget(p.getSourceType(), it_p.target_type, strict_snapping)) {
             bool const being_edited = node_tool_active && it_p.currently_being_edited;
             //if true then this pathvector it_pv is currently being edited in the node tool
 
-            for (auto &it_pv : it_p.path_vector) {
-                // Find a nearest point for each curve within this path
-                // n curves will return n time values with 0 <= t <= 1
-                std::vector<double> anp = it_pv.nearestTimePerCurve(p_doc);
-
-                //std::cout << "#nearest points = " << anp.size() << " | p = " << p.getPoint() << std::endl;
-                // Now we will examine each of the nearest points, and determine whether it's within snapping range and if we should snap to it
-                std::vector<double>::const_iterator np = anp.begin();
-                unsigned int index = 0;
-                for (; np != anp.end(); ++np, index++) {
-                    Geom::Curve const *curve = &it_pv.at(index);
-                    Geom::Point const sp_doc = curve->pointAt(*np);
-                    //dt->getSnapIndicator()->set_new_debugging_point(sp_doc*dt->doc2dt());
-                    bool c1 = true;
-                    bool c2 = true;
-                    if (being_edited) {
-                        /* If the path is being edited, then we should only snap though to stationary pieces of the path
-                         * and not to the pieces that are being dragged around. This way we avoid
-                         * self-snapping. For this we check whether the nodes at both ends of the current
-                         * piece are unselected; if they are then this piece must be stationary
-                         */
-                        g_assert(unselected_nodes != nullptr);
-                        Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
-                        Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
-                        c1 = isUnselectedNode(start_pt, unselected_nodes);
-                        c2 = isUnselectedNode(end_pt, unselected_nodes);
-                        /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
-                         * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
-                         * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
-                         *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
-                         *   should be in the exact same order for both classes, so we can index them
-                         * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
-                         */
-                    }
+            auto const &it_pv = it_p.path_vector[info.path];
+            int const num_path = first_num_path[info.candidate] + info.path;
+
+            // Find the nearest point on this curve, and determine whether it's within snapping range and if we should snap to it
+            unsigned int const index = info.curve;
+            Geom::Curve const *curve = &it_pv.at(index);
+            double const np = curve->nearestTime(p_doc);
+            Geom::Point const sp_doc = curve->pointAt(np);
+            //dt->getSnapIndicator()->set_new_debugging_point(sp_doc*dt->doc2dt());
+            bool c1 = true;
+            bool c2 = true;
+            if (being_edited) {
+                /* If the path is being edited, then we should only snap though to stationary pieces of the path
+                 * and not to the pieces that are being dragged around. This way we avoid
+                 * self-snapping. For this we check whether the nodes at both ends of the current
+                 * piece are unselected; if they are then this piece must be stationary
+                 */
+                g_assert(unselected_nodes != nullptr);
+                Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
+                Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
+                c1 = isUnselectedNode(start_pt, unselected_nodes);
+                c2 = isUnselectedNode(end_pt, unselected_nodes);
+                /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
+                 * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
+                 * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
+                 *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
+                 *   should be in the exact same order for both classes, so we can index them
+                 * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
+                 */
+            }
 
-                    Geom::Point const sp_dt = dt->doc2dt(sp_doc);
-                    if (!being_edited || (c1 && c2)) {
-                        Geom::Coord dist = Geom::distance(sp_doc, p_doc);
-                        // std::cout << "  dist -> " << dist << std::endl;
-                        if (dist < getSnapperTolerance()) {
-                            // Add the curve we have snapped to
-                            Geom::Point sp_tangent_dt = Geom::Point(0,0);
-                            if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
-                                // We currently only use the tangent when snapping guides, so only in this case we will
-                                // actually calculate the tangent to avoid wasting CPU cycles
-                                Geom::Point sp_tangent_doc = curve->unitTangentAt(*np);
-                                sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
-                            }
-                            bool always = getSnapperAlwaysSnap(p.getSourceType());
-                            isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path, index, dist, getSnapperTolerance(), always, false, curve, p.getSourceType(), p.getSourceNum(), it_p.target_type, it_p.target_bbox);
-                            if (snap_tang || snap_perp) {
-                                // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
-                                _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
-                            }
-                        }
+            Geom::Point const sp_dt = dt->doc2dt(sp_doc);
+            if (!being_edited || (c1 && c2)) {
+                Geom::Coord dist = Geom::distance(sp_doc, p_doc);
+                // std::cout << "  dist -> " << dist << std::endl;
+                if (dist < getSnapperTolerance()) {
+                    // Add the curve we have snapped to
+                    Geom::Point sp_tangent_dt = Geom::Point(0,0);
+                    if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
+                        // We currently only use the tangent when snapping guides, so only in this case we will
+                        // actually calculate the tangent to avoid wasting CPU cycles
+                        Geom::Point sp_tangent_doc = curve->unitTangentAt(np);
+                        sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
+                    }
+                    bool always = getSnapperAlwaysSnap(p.getSourceType());
+                    isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path, index, dist, getSnapperTolerance(), always, false, curve, p.getSourceType(), p.getSourceNum(), it_p.target_type, it_p.target_bbox);
+                    if (snap_tang || snap_perp) {
+                        // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
+                        _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
                     }
                 }
-                num_path++;
-            } // End of: for (Geom::PathVector::iterator ....)
+            }
         }
     }
 }
 
+/**
+ * Add the curves of any paths not yet in the curve index to it.
+ */
+void Inkscape::ObjectSnapper::_indexPaths() const
+{
+    auto &indices = *_indices;
+    for (unsigned k = indices.candidates_indexed; k < _paths_to_snap_to->size(); k++) {
+        auto const &pathv = (*_paths_to_snap_to)[k].path_vector;
+        for (unsigned j = 0; j < pathv.size(); j++) {
+            auto const &path = pathv[j];
+            for (unsigned i = 0; i < path.size_default(); i++) {
+                indices.curves.insert(path[i].boundsFast());
+                indices.curve_info.push_back({ k, j, i });
+            }
+        }
+    }
+    indices.candidates_indexed = _paths_to_snap_to->size();
+}
+
 /* Returns true if point is coincident with one of the unselected nodes */
 bool Inkscape::ObjectSnapper::isUnselectedNode(Geom::Point const &point, std::vector<SnapCandidatePoint> const *unselected_nodes) const
 {
@@ -585,9 +716,19 @@ void Inkscape::ObjectSnapper::_snapPathsConstrained(IntermSnapResults &isr,
 
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
 
+    // Only path_vectors with a curve whose bounds meet those of the constraint can intersect it
+    _indexPaths();
+    std::vector<bool> near(_paths_to_snap_to->size(), false);
+    if (auto const bounds = constraint_path.boundsFast()) {
+        for (auto id : _indices->curves.query(*bounds)) {
+            near[_indices->curve_info[id].candidate] = true;
+        }
+    }
+
     // Find all intersections of the constrained path with the snap target candidates
-    for (const auto & k : *_paths_to_snap_to) {
-        if (_allowSourceToSnapToTarget(p.getSourceType(), k.target_type, strict_snapping)) {
+    for (unsigned n = 0; n < _paths_to_snap_to->size(); n++) {
+        auto const &k = (*_paths_to_snap_to)[n];
+        if (near[n] && _allowSourceToSnapToTarget(p.getSourceType(), k.target_type, strict_snapping)) {
             // Do the intersection math
             std::vector<Geom::PVIntersection> inters = constraint_path.intersect(k.path_vector);
 
@@ -730,6 +871,9 @@ bool Inkscape::ObjectSnapper::ThisSnapperMightSnap() const
 void Inkscape::ObjectSnapper::_clear_paths() const
 {
     _paths_to_snap_to->clear();
+    _indices->curves.clear(2 * getSnapperTolerance());
+    _indices->curve_info.clear();
+    _indices->candidates_indexed = 0;
 }
 
 Geom::PathVector Inkscape::ObjectSnapper::_getPathvFromRect(Geom::Rect const rect) const
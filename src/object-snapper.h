@@ -60,8 +60,13 @@ public:
                   std::vector<SnapCandidatePoint> *unselected_nodes) const override;
 
 private:
+    struct Indices;
+    struct ItemPoints;
+
     std::unique_ptr<std::vector<SnapCandidatePoint>> _points_to_snap_to;
     std::unique_ptr<std::vector<SnapCandidatePath >> _paths_to_snap_to;
+    std::unique_ptr<Indices> _indices;        ///< Spatial indices over the two lists above.
+    std::unique_ptr<ItemPoints> _item_points; ///< Snap points of candidate items, kept across snaps.
 
     void _snapNodes(IntermSnapResults &isr,
                       Inkscape::SnapCandidatePoint const &p, // in desktop coordinates
@@ -105,6 +110,8 @@ private:
                       bool const &first_point) const;
 
     void _clear_paths() const;
+    void _indexPaths() const;
+    std::vector<SnapCandidatePoint> const &_getItemSnappoints(SPItem *item) const;
     Geom::PathVector _getBorderPathv() const;
     Geom::PathVector _getPathvFromRect(Geom::Rect const rect) const;
     bool _allowSourceToSnapToTarget(SnapSourceType source, SnapTargetType target, bool strict_snapping) const;
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Decoding of bitmap images off the main thread.
+ *//*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "image-decoder.h"
+
+#include <cstring>
+#include <thread>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "display/cairo-utils.h"
+#include "preferences.h"
+
+namespace Inkscape {
+
+namespace {
+
+boost::asio::thread_pool &decode_pool()
+{
+    // Created on first use, which is on the main thread, so reading the preferences is fine.
+    static boost::asio::thread_pool pool(Preferences::get()->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256));
+    return pool;
+}
+
+} // namespace
+
+std::shared_ptr<ImageDecoder> ImageDecoder::start(std::function<Pixbuf *()> decode)
+{
+    auto decoder = std::shared_ptr<ImageDecoder>(new ImageDecoder());
+    boost::asio::post(decode_pool(), [decoder, decode = std::move(decode)] {
+        decoder->_run(decode);
+    });
+    return decoder;
+}
+
+ImageDecoder::~ImageDecoder() = default;
+
+void ImageDecoder::_run(std::function<Pixbuf *()> const &decode)
+{
+    {
+        auto lock = std::unique_lock(_mutex);
+        if (_cancelled) {
+            _done = true;
+            _done_cond.notify_all();
+            return;
+        }
+    }
+
+    auto result = std::unique_ptr<Pixbuf>(decode());
+
+    auto lock = std::unique_lock(_mutex);
+    _result = std::move(result);
+    _done = true;
+    _done_cond.notify_all();
+    if (_slot) {
+        g_idle_add(&ImageDecoder::_notify, new std::shared_ptr<ImageDecoder>(shared_from_this()));
+    }
+}
+
+int ImageDecoder::_notify(void *data)
+{
+    auto const self = std::unique_ptr<std::shared_ptr<ImageDecoder>>(static_cast<std::shared_ptr<ImageDecoder> *>(data));
+
+    std::function<void ()> slot;
+    {
+        auto lock = std::unique_lock((*self)->_mutex);
+        slot = std::move((*self)->_slot);
+        (*self)->_slot = {};
+    }
+    if (slot) {
+        slot();
+    }
+    return G_SOURCE_REMOVE;
+}
+
+bool ImageDecoder::ready() const
+{
+    auto lock = std::unique_lock(_mutex);
+    return _done;
+}
+
+void ImageDecoder::wait() const
+{
+    auto lock = std::unique_lock(_mutex);
+    _done_cond.wait(lock, [this] { return _done; });
+}
+
+std::unique_ptr<Pixbuf> ImageDecoder::take()
+{
+    auto lock = std::unique_lock(_mutex);
+    _done_cond.wait(lock, [this] { return _done; });
+    return std::move(_result);
+}
+
+void ImageDecoder::onReady(std::function<void ()> slot)
+{
+    auto lock = std::unique_lock(_mutex);
+    _slot = std::move(slot);
+    if (_done && _slot) {
+        g_idle_add(&ImageDecoder::_notify, new std::shared_ptr<ImageDecoder>(shared_from_this()));
+    }
+}
+
+void ImageDecoder::cancel()
+{
+    auto lock = std::unique_lock(_mutex);
+    _slot = {};
+    _cancelled = true;
+}
+
+std::optional<Geom::IntPoint> probe_image_file_size(std::string const &path)
+{
+    int width = 0, height = 0;
+    if (!gdk_pixbuf_get_file_info(path.c_str(), &width, &height) || width <= 0 || height <= 0) {
+        return {};
+    }
+    return Geom::IntPoint(width, height);
+}
+
+std::optional<Geom::IntPoint> probe_data_uri_size(char const *uri_data)
+{
+    auto const comma = std::strchr(uri_data, ',');
+    if (!comma || !g_strstr_len(uri_data, comma - uri_data, "base64")) {
+        return {};
+    }
+
+    // The size is in the first few kilobytes of all common formats, after any metadata.
+    constexpr std::size_t PROBE_LENGTH = 64 * 1024;
+    auto const data = comma + 1;
+    auto length = strnlen(data, PROBE_LENGTH);
+    length -= length % 4;
+    auto const encoded = std::string(data, length);
+
+    gsize decoded_len = 0;
+    auto const decoded = g_base64_decode(encoded.c_str(), &decoded_len);
+
+    std::optional<Geom::IntPoint> size;
+    auto const loader = gdk_pixbuf_loader_new();
+    g_signal_connect(loader, "size-prepared", G_CALLBACK(+[] (GdkPixbufLoader *, int width, int height, gpointer data) {
+        *static_cast<std::optional<Geom::IntPoint> *>(data) = Geom::IntPoint(width, height);
+    }), &size);
+    gdk_pixbuf_loader_write(loader, decoded, decoded_len, nullptr);
+    gdk_pixbuf_loader_close(loader, nullptr); // complains about the missing rest
+    g_object_unref(loader);
+    g_free(decoded);
+
+    if (size && ((*size)[Geom::X] <= 0 || (*size)[Geom::Y] <= 0)) {
+        return {};
+    }
+    return size;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Decoding of bitmap images off the main thread.
+ *//*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_IMAGE_DECODER_H
+#define SEEN_INKSCAPE_IMAGE_DECODER_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <2geom/point.h>
+
+namespace Inkscape {
+
+class Pixbuf;
+
+/**
+ * One image being decoded on the shared pool of decoding threads.
+ *
+ * Images are queued as soon as their source is known, typically while the document is being
+ * built, so that all of them decode at the same time while the rest of the document loads.
+ * The owner either waits for the result, or asks to be told on the main thread once it is
+ * there.
+ */
+class ImageDecoder : public std::enable_shared_from_this<ImageDecoder>
+{
+public:
+    /// Queue @a decode, which must be safe to run on any thread.
+    static std::shared_ptr<ImageDecoder> start(std::function<Pixbuf *()> decode);
+
+    ImageDecoder(ImageDecoder const &) = delete;
+    ImageDecoder &operator=(ImageDecoder const &) = delete;
+    ~ImageDecoder();
+
+    /// Whether the result is there, so that take() won't block.
+    bool ready() const;
+
+    /// Wait until the result is there.
+    void wait() const;
+
+    /// Wait for the result and take it. Returns null if decoding failed or was already taken.
+    std::unique_ptr<Pixbuf> take();
+
+    /**
+     * Call @a slot from the main loop once the result is there, or straight away if it already
+     * is. Only one slot is kept.
+     */
+    void onReady(std::function<void ()> slot);
+
+    /// Forget the slot, and skip decoding if it hasn't started yet.
+    void cancel();
+
+private:
+    ImageDecoder() = default;
+
+    void _run(std::function<Pixbuf *()> const &decode);
+    static int _notify(void *data);
+
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _done_cond;
+    bool _done = false;
+    bool _cancelled = false;
+    std::unique_ptr<Pixbuf> _result;
+    std::function<void ()> _slot;
+};
+
+/// Read the pixel size of the image file at @a path from its header, without decoding it.
+std::optional<Geom::IntPoint> probe_image_file_size(std::string const &path);
+
+/**
+ * Read the pixel size of a base64 encoded bitmap from the start of its data URI (without the
+ * "data:" prefix), without decoding the whole image.
+ */
+std::optional<Geom::IntPoint> probe_data_uri_size(char const *uri_data);
+
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_IMAGE_DECODER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
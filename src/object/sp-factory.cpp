@@ -96,6 +96,12 @@
 #include "filters/turbulence.h"
 
 #include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+
+#include "attributes.h"
+#include "xml/node.h"
 
 namespace {
 
@@ -114,6 +120,44 @@ public:
         return it->second();
     }
 
+    /**
+     * Create the object for a repr by dispatching directly on its interned element name
+     * (or sodipodi:type), without building the type string.
+     */
+    SPObject *create(Inkscape::XML::Node const &node) const
+    {
+        GQuark code = 0;
+        switch (node.type()) {
+            case Inkscape::XML::NodeType::TEXT_NODE:
+                code = string_code;
+                break;
+            case Inkscape::XML::NodeType::ELEMENT_NODE:
+                if (auto sptype = node.attributeByCode(sodipodi_type_code)) {
+                    // All known types were interned on construction, so a value that was never
+                    // interned cannot name one.
+                    code = g_quark_try_string(sptype);
+                    if (!code) {
+                        std::cerr << "WARNING: unknown type: " << sptype << std::endl;
+                        return nullptr;
+                    }
+                } else {
+                    code = node.code();
+                }
+                break;
+            default:
+                return nullptr; // comments
+        }
+
+        if (code < codes.size()) {
+            if (auto func = codes[code]) {
+                return func();
+            }
+        }
+
+        std::cerr << "WARNING: unknown type: " << g_quark_to_string(code) << std::endl;
+        return nullptr;
+    }
+
     bool supportsId(std::string const &id) const
     {
         return map.find(id) != map.end();
@@ -128,6 +172,19 @@ public:
 private:
     using Func = SPObject*(*)();
 
+    Factory()
+    {
+        // Intern every type name and index the constructors by quark. Quarks created later
+        // are either outside the table or map to nullptr, i.e. unknown.
+        for (auto const &[id, func] : map) {
+            GQuark const code = g_quark_from_string(id.c_str());
+            if (code >= codes.size()) {
+                codes.resize(code + 1, nullptr);
+            }
+            codes[code] = func;
+        }
+    }
+
     template <typename T>
     static Func constexpr make = [] () -> SPObject* { return new T; };
     static Func constexpr null = [] () -> SPObject* { return nullptr; };
@@ -278,6 +335,10 @@ private:
         { "inkscape:_templateinfo", null }, // metadata for templates
         { "", null } // comments
     };
+
+    std::vector<Func> codes;
+    GQuark const string_code = g_quark_from_static_string("string");
+    GQuark const sodipodi_type_code = sp_attribute_quark(SPAttr::SODIPODI_TYPE);
 };
 
 } // namespace
@@ -287,6 +348,11 @@ SPObject *SPFactory::createObject(std::string const &id)
     return Factory::get().create(id);
 }
 
+SPObject *SPFactory::createObject(Inkscape::XML::Node const &node)
+{
+    return Factory::get().create(node);
+}
+
 bool SPFactory::supportsType(std::string const &id)
 {
     return Factory::get().supportsId(id);
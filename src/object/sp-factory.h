@@ -24,6 +24,9 @@ class Node;
 
 struct SPFactory {
     static SPObject *createObject(std::string const &id);
+    /// Create the object for a repr; equivalent to createObject(NodeTraits::get_type_string(node))
+    /// but dispatches on the interned element name, with no string construction per node.
+    static SPObject *createObject(Inkscape::XML::Node const &node);
     static bool supportsType(std::string const &id);
 };
 
@@ -30,7 +30,10 @@
 
 // Added for preserveAspectRatio support -- EAF
 #include "attributes.h"
+#include "desktop.h"
 #include "document.h"
+#include "image-decoder.h"
+#include "inkscape.h"
 #include "print.h"
 #include "snap-candidate.h"
 #include "snap-preferences.h"
@@ -100,6 +103,27 @@ extern guint update_in_progress;
 #define DEBUG_MESSAGE_SCISLAC(key, ...)
 #endif // DEBUG_LCMS
 
+/**
+ * Whether update() may leave the image empty until its pixels arrive. That is only the case for
+ * documents shown on a desktop, which are redrawn once they do; documents without one are
+ * rendered right after their update, so update() waits for the pixels.
+ */
+static bool decode_in_background(SPDocument const *document)
+{
+    if (!Inkscape::Application::exists() || !INKSCAPE.use_gui()) {
+        return false;
+    }
+    auto const desktops = INKSCAPE.get_desktops();
+    return desktops && std::any_of(desktops->begin(), desktops->end(), [=] (SPDesktop const *desktop) {
+        return desktop->getDocument() == document;
+    });
+}
+
+static bool is_svg_filename(std::string const &filename)
+{
+    return filename.size() >= 4 && g_ascii_strcasecmp(filename.c_str() + filename.size() - 4, ".svg") == 0;
+}
+
 SPImage::SPImage() : SPItem(), SPViewBox() {
 
     this->x.unset();
@@ -133,6 +157,8 @@ void SPImage::build(SPDocument *document, Inkscape::XML::Node *repr) {
 
     /* Register */
     document->addResource("image", this);
+
+    _startDecode();
 }
 
 void SPImage::release() {
@@ -146,6 +172,7 @@ void SPImage::release() {
         this->href = nullptr;
     }
 
+    _stopDecode();
     pixbuf.reset();
 
     if (this->color_profile) {
@@ -163,6 +190,7 @@ void SPImage::set(SPAttr key, const gchar* value) {
         case SPAttr::XLINK_HREF:
             g_free (this->href);
             this->href = (value) ? g_strdup (value) : nullptr;
+            _stopDecode();
             this->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_IMAGE_HREF_MODIFIED_FLAG);
             break;
 
@@ -203,6 +231,7 @@ void SPImage::set(SPAttr key, const gchar* value) {
             break;
 
         case SPAttr::SVG_DPI:
+            _stopDecode();
             this->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_IMAGE_HREF_MODIFIED_FLAG);
             break;
 
@@ -318,18 +347,34 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
                 svgdpi = g_ascii_strtod(getRepr()->attribute("inkscape:svg-dpi"), nullptr);
             }
             dpi = svgdpi;
-            pb = readImage(Inkscape::getHrefAttribute(*getRepr()).second,
-                           getRepr()->attribute("sodipodi:absref"),
-                           document->getDocumentBase(), svgdpi);
-            if (!pb) {
-                missing = true;
-                // Passing in our previous size allows us to preserve the image's expected size.
-                auto broken_width = width._set ? width.computed : 640;
-                auto broken_height = height._set ? height.computed : 640;
-                pb = getBrokenImage(broken_width, broken_height);
-            }
-            else {
-                missing = false;
+
+            // Leave the image empty until its pixels arrive, as long as we know how big it is.
+            bool const pending = _decoder && !_decoder->ready() && decode_in_background(document) &&
+                                 ((width._set && height._set) || _decode_size);
+
+            if (pending) {
+                _decoder->onReady([this] {
+                    requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_IMAGE_HREF_MODIFIED_FLAG);
+                });
+            } else {
+                if (_decoder) {
+                    pb = _decoder->take().release();
+                    _stopDecode();
+                } else {
+                    pb = readImage(Inkscape::getHrefAttribute(*getRepr()).second,
+                                   getRepr()->attribute("sodipodi:absref"),
+                                   document->getDocumentBase(), svgdpi);
+                }
+                if (!pb) {
+                    missing = true;
+                    // Passing in our previous size allows us to preserve the image's expected size.
+                    auto broken_width = width._set ? width.computed : 640;
+                    auto broken_height = height._set ? height.computed : 640;
+                    pb = getBrokenImage(broken_width, broken_height);
+                }
+                else {
+                    missing = false;
+                }
             }
 
             if (pb) {
@@ -342,9 +387,17 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
 
     SPItemCtx *ictx = (SPItemCtx *) ctx;
 
+    // While the image is still being decoded, it is laid out with the size from its header.
+    std::optional<Geom::IntPoint> pixel_size;
+    if (this->pixbuf) {
+        pixel_size = Geom::IntPoint(this->pixbuf->width(), this->pixbuf->height());
+    } else if (_decoder) {
+        pixel_size = _decode_size;
+    }
+
     // Why continue without a pixbuf? So we can display "Missing Image" png.
     // Eventually, we should properly support SVG image type (i.e. render it ourselves).
-    if (this->pixbuf) {
+    if (this->pixbuf || _decoder) {
         if (!this->x._set) {
             this->x.unit = SVGLength::PX;
             this->x.computed = 0;
@@ -355,14 +408,14 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
             this->y.computed = 0;
         }
 
-        if (!this->width._set) {
+        if (!this->width._set && pixel_size) {
             this->width.unit = SVGLength::PX;
-            this->width.computed = this->pixbuf->width();
+            this->width.computed = (*pixel_size)[Geom::X];
         }
 
-        if (!this->height._set) {
+        if (!this->height._set && pixel_size) {
             this->height.unit = SVGLength::PX;
-            this->height.computed = this->pixbuf->height();
+            this->height.computed = (*pixel_size)[Geom::Y];
         }
     }
 
@@ -566,6 +619,95 @@ Inkscape::DrawingItem* SPImage::show(Inkscape::Drawing &drawing, unsigned int /*
 }
 
 
+/**
+ * Start decoding the image on the decoding threads, so that the images of a document being
+ * opened are all decoded at once. Only bitmaps embedded as data URIs or read from local files
+ * qualify: SVG images are loaded as documents, which can only be done on the main thread.
+ */
+void SPImage::_startDecode()
+{
+    auto const href = Inkscape::getHrefAttribute(*getRepr()).second;
+    if (!href) {
+        return;
+    }
+    auto const absref = getRepr()->attribute("sodipodi:absref");
+    auto const base = document->getDocumentBase();
+    if (absref && is_svg_filename(absref)) {
+        return;
+    }
+
+    // The size is only needed if the attributes don't give it.
+    bool const need_size = !width._set || !height._set;
+    std::optional<Geom::IntPoint> size;
+
+    if (g_ascii_strncasecmp(href, "data:", 5) == 0) {
+        auto const comma = std::strchr(href, ',');
+        if (!comma || g_strstr_len(href, comma - href, "svg")) {
+            return;
+        }
+        if (need_size) {
+            size = Inkscape::probe_data_uri_size(href + 5);
+        }
+    } else {
+        auto const url = Inkscape::URI::from_href_and_basedir(href, base);
+        if (!url.hasScheme("file")) {
+            return;
+        }
+        auto const filename = url.toNativeFilename();
+        if (is_svg_filename(filename)) {
+            return;
+        }
+        if (need_size) {
+            size = Inkscape::probe_image_file_size(filename);
+        }
+    }
+
+    double svgdpi = 96;
+    if (getRepr()->attribute("inkscape:svg-dpi")) {
+        svgdpi = g_ascii_strtod(getRepr()->attribute("inkscape:svg-dpi"), nullptr);
+    }
+
+    auto const copy = [] (char const *s) { return s ? std::optional<std::string>(s) : std::nullopt; };
+    _decoder = Inkscape::ImageDecoder::start([href = std::string(href), absref = copy(absref), base = copy(base), svgdpi] {
+        auto pb = readImage(href.c_str(), absref ? absref->c_str() : nullptr, base ? base->c_str() : nullptr, svgdpi);
+        if (pb) {
+            pb->ensurePixelFormat(Inkscape::Pixbuf::PF_CAIRO);
+        }
+        return pb;
+    });
+    _decode_size = size;
+}
+
+/**
+ * Wait until the image being decoded in the background is there, and schedule an update to
+ * show it.
+ */
+void SPImage::finishDecode()
+{
+    if (_decoder) {
+        _decoder->wait();
+        requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_IMAGE_HREF_MODIFIED_FLAG);
+    }
+}
+
+void sp_image_finish_decoding(SPDocument *document)
+{
+    for (auto obj : document->getResourceList("image")) {
+        if (auto image = cast<SPImage>(obj)) {
+            image->finishDecode();
+        }
+    }
+}
+
+void SPImage::_stopDecode()
+{
+    if (_decoder) {
+        _decoder->cancel();
+        _decoder.reset();
+    }
+    _decode_size.reset();
+}
+
 Inkscape::Pixbuf *SPImage::readImage(gchar const *href, gchar const *absref, gchar const *base, double svgdpi)
 {
     Inkscape::Pixbuf *inkpb = nullptr;
@@ -18,6 +18,7 @@
 #include "sp-item.h"
 
 #include <memory>
+#include <optional>
 
 #include <glibmm/ustring.h>
 
@@ -29,7 +30,11 @@
 
 #define SP_IMAGE_HREF_MODIFIED_FLAG SP_OBJECT_USER_MODIFIED_FLAG_A
 
-namespace Inkscape { class Pixbuf; }
+namespace Inkscape {
+class ImageDecoder;
+class Pixbuf;
+} // namespace Inkscape
+
 class SPImage final : public SPItem, public SPViewBox, public SPDimensions {
 public:
     SPImage();
@@ -72,13 +77,23 @@ public:
     void refresh_if_outdated();
     bool cropToArea(Geom::Rect area);
     bool cropToArea(const Geom::IntRect &area);
+    void finishDecode();
 private:
     static Inkscape::Pixbuf *readImage(gchar const *href, gchar const *absref, gchar const *base, double svgdpi = 0);
     static Inkscape::Pixbuf *getBrokenImage(double width, double height);
+
+    void _startDecode();
+    void _stopDecode();
+
+    std::shared_ptr<Inkscape::ImageDecoder> _decoder; ///< decoding started by build(), if any
+    std::optional<Geom::IntPoint> _decode_size; ///< pixel size of the image being decoded, if known
 };
 
 /* Return duplicate of curve or NULL */
 void sp_embed_image(Inkscape::XML::Node *imgnode, Inkscape::Pixbuf *pb);
 void sp_embed_svg(Inkscape::XML::Node *image_node, std::string const &fn);
 
+/// Wait for the images of @a document that are still being decoded; follow with ensureUpToDate().
+void sp_image_finish_decoding(SPDocument *document);
+
 #endif
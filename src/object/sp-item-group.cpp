@@ -995,6 +995,9 @@ void SPGroup::update_patheffect(bool write) {
 #ifdef GROUP_VERBOSE
     g_message("sp_group_update_patheffect: %p\n", lpeitem);
 #endif
+    // Children whose effects can all run on worker threads are updated together first.
+    std::vector<SPItem *> sub_items;
+    std::vector<SPShape *> concurrent;
     for (auto sub_item : item_list()) {
         if (sub_item) {
             // don't need lpe version < 1 (issue only reply on lower LPE on nested LPEs
@@ -1006,10 +1009,26 @@ void SPGroup::update_patheffect(bool write) {
                 sub_shape->bbox_vis_cache_is_valid = false;
                 sub_shape->bbox_geom_cache_is_valid = false;
             }
-            auto lpe_item = cast<SPLPEItem>(sub_item);
-            if (lpe_item) {
-                lpe_item->update_patheffect(write);
+            if (sub_shape && sub_shape->canUpdatePatheffectConcurrently()) {
+                concurrent.push_back(sub_shape);
             }
+            sub_items.push_back(sub_item);
+        }
+    }
+    if (concurrent.size() > 1) {
+        SPShape::update_patheffects_concurrently(concurrent, write);
+    } else {
+        concurrent.clear();
+    }
+    auto done = concurrent.begin();
+    for (auto sub_item : sub_items) {
+        if (done != concurrent.end() && *done == sub_item) {
+            ++done;
+            continue;
+        }
+        auto lpe_item = cast<SPLPEItem>(sub_item);
+        if (lpe_item) {
+            lpe_item->update_patheffect(write);
         }
     }
 
@@ -95,6 +95,7 @@ void SPLPEItem::release() {
     lpe_modified_connection_list.clear();
 
     clear_path_effect_list(this->path_effect_list);
+    lpe_stage_cache.clear();
 
     // delete the list itself
     delete this->path_effect_list;
@@ -115,6 +116,7 @@ void SPLPEItem::set(SPAttr key, gchar const* value) {
             lpe_modified_connection_list.clear();
 
             clear_path_effect_list(this->path_effect_list);
+            lpe_stage_cache.clear();
 
             // Parse the contents of "value" to rebuild the path effect reference list
             if ( value ) {
@@ -264,50 +266,134 @@ bool SPLPEItem::performOnePathEffect(SPCurve *curve, SPShape *current, Inkscape:
         if (!is_clip_or_mask || lpe->apply_to_clippath_and_mask) {
             // Uncomment to get updates
             // g_debug("LPE running:: %s",Inkscape::LivePathEffect::LPETypeConverter.get_key(lpe->effectType()).c_str());
-            lpe->setCurrentShape(current);
-            if (!is<SPGroup>(this)) {
-                lpe->pathvector_before_effect = curve->get_pathvector();
-            }
-            // To Calculate BBox on shapes and nested LPE
-            current->setCurveInsync(curve);
-            // Groups have their doBeforeEffect called elsewhere
-            if (lpe->lpeversion.param_getSVGValue() != "0") { // we are on 1 or up
-                current->bbox_vis_cache_is_valid = false;
-                current->bbox_geom_cache_is_valid = false;
-            }
-            auto group = cast<SPGroup>(this);
-            if (!group && !is_clip_or_mask) {
-                lpe->doBeforeEffect_impl(this);
+            LPEStageRun run{curve, current, lpe};
+            beginPathEffect(run, is_clip_or_mask);
+            if (!run.cached) {
+                runPathEffect(run);
             }
+            return endPathEffect(run);
+        }
+    }
+    return true;
+}
 
-            try {
-                lpe->doEffect(curve);
-                lpe->has_exception = false;
-            }
+/**
+ * The part of performOnePathEffect() before doEffect().
+ */
+void SPLPEItem::beginPathEffect(LPEStageRun &run, bool is_clip_or_mask)
+{
+    auto const lpe = run.lpe;
+    auto const current = run.current;
+    lpe->setCurrentShape(current);
+    if (!is<SPGroup>(this)) {
+        lpe->pathvector_before_effect = run.curve->get_pathvector();
+    }
+    // To Calculate BBox on shapes and nested LPE
+    current->setCurveInsync(run.curve);
+    // Groups have their doBeforeEffect called elsewhere
+    if (lpe->lpeversion.param_getSVGValue() != "0") { // we are on 1 or up
+        current->bbox_vis_cache_is_valid = false;
+        current->bbox_geom_cache_is_valid = false;
+    }
+    auto group = cast<SPGroup>(this);
+    if (!group && !is_clip_or_mask) {
+        lpe->doBeforeEffect_impl(this);
+    }
 
-            catch (std::exception & e) {
-                g_warning("Exception during LPE %s execution. \n %s", lpe->getName().c_str(), e.what());
-                if (SP_ACTIVE_DESKTOP && SP_ACTIVE_DESKTOP->messageStack()) {
-                    SP_ACTIVE_DESKTOP->messageStack()->flash( Inkscape::WARNING_MESSAGE,
-                                    _("An exception occurred during execution of the Path Effect.") );
-                }
-                lpe->doOnException(this);
-                return false;
-            }
+    // Reuse the last output of a pure-geometry effect if nothing it depends on changed.
+    // Group effects run once per child with state shared between them, so they always run.
+    if (group || !lpe->isPureGeometry()) {
+        return;
+    }
+    run.cache_key = lpe->geometryCacheKey();
+    run.cache = &lpe_stage_cache[{current, lpe}];
+    if (run.cache->key == run.cache_key && run.cache->input == run.curve->get_pathvector()) {
+        run.curve->set_pathvector(run.cache->output);
+        if (auto helper_paths = lpe->geometryCacheHelperPaths()) {
+            *helper_paths = run.cache->helper_paths;
+        }
+        run.cached = true;
+    } else {
+        run.cache->key.clear();
+        run.cache->input = run.curve->get_pathvector();
+    }
+}
 
-            if (!group) {
-                // To have processed the shape to doAfterEffect
-                current->setCurveInsync(curve);
-                if (curve) {
-                    lpe->pathvector_after_effect = curve->get_pathvector();
-                }
-                lpe->doAfterEffect_impl(this, curve);
-            }
+/**
+ * The doEffect() of performOnePathEffect(). Only touches the curve and the effect, so may run
+ * on a worker thread if the effect allows it.
+ */
+void SPLPEItem::runPathEffect(LPEStageRun &run)
+{
+    try {
+        run.lpe->doEffect(run.curve);
+        run.lpe->has_exception = false;
+    }
+
+    catch (std::exception & e) {
+        run.error = e.what();
+    }
+}
+
+/**
+ * The part of performOnePathEffect() after doEffect(). Returns false if doEffect() failed.
+ */
+bool SPLPEItem::endPathEffect(LPEStageRun &run)
+{
+    auto const lpe = run.lpe;
+    if (run.error) {
+        g_warning("Exception during LPE %s execution. \n %s", lpe->getName().c_str(), run.error->c_str());
+        if (SP_ACTIVE_DESKTOP && SP_ACTIVE_DESKTOP->messageStack()) {
+            SP_ACTIVE_DESKTOP->messageStack()->flash( Inkscape::WARNING_MESSAGE,
+                            _("An exception occurred during execution of the Path Effect.") );
+        }
+        lpe->doOnException(this);
+        return false;
+    }
+
+    if (run.cache && !run.cached) {
+        run.cache->key = std::move(run.cache_key);
+        run.cache->output = run.curve->get_pathvector();
+        if (auto helper_paths = lpe->geometryCacheHelperPaths()) {
+            run.cache->helper_paths = *helper_paths;
+        }
+    }
+
+    if (!is<SPGroup>(this)) {
+        // To have processed the shape to doAfterEffect
+        run.current->setCurveInsync(run.curve);
+        if (run.curve) {
+            lpe->pathvector_after_effect = run.curve->get_pathvector();
         }
+        lpe->doAfterEffect_impl(this, run.curve);
     }
     return true;
 }
 
+std::vector<Inkscape::LivePathEffect::Effect *> SPLPEItem::getThreadSafePathEffects() const
+{
+    std::vector<Inkscape::LivePathEffect::Effect *> result;
+    if (!hasPathEffect() || !pathEffectsEnabled()) {
+        return result;
+    }
+    for (auto const &lperef : *path_effect_list) {
+        auto const lpeobj = lperef->lpeobject;
+        auto const lpe = lpeobj ? lpeobj->get_lpe() : nullptr;
+        // A shared effect object keeps the state of one item between doBeforeEffect() and
+        // doEffect(), so only one item at a time can use it.
+        if (!lpe || lpeobj->hrefcount != 1 || !lpe->isPureGeometry() || !lpe->isThreadSafe()) {
+            return {};
+        }
+        if (lpe->isVisible()) {
+            if (lpe->acceptsNumClicks() > 0 && !lpe->isReady()) {
+                return {};
+            }
+            result.push_back(lpe);
+        }
+    }
+    return result;
+}
+
 /**
  * returns false when LPE write unoptimiced
  */
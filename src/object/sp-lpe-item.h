@@ -17,9 +17,13 @@
 
 #include <cstddef>
 #include <list>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
+#include <2geom/pathvector.h>
 
 #include "helper/auto-connection.h"
 #include "sp-item.h"
@@ -49,6 +53,17 @@ class SPLPEItem : public SPItem {
     // this list contains the connections for listening to lpeobject parameter changes
     std::list<Inkscape::auto_connection> lpe_modified_connection_list;
 
+    // The last run of each pure-geometry effect of the stack, per shape it ran on, so that it
+    // needn't run again while its input and parameters stay the same.
+    struct LPEStageCache
+    {
+        std::string key;
+        Geom::PathVector input;
+        Geom::PathVector output;
+        Geom::PathVector helper_paths;
+    };
+    std::map<std::pair<SPShape const *, Inkscape::LivePathEffect::Effect const *>, LPEStageCache> lpe_stage_cache;
+
 public:
     SPLPEItem();
     ~SPLPEItem() override;
@@ -137,6 +152,30 @@ public:
     bool forkPathEffectsIfNecessary(unsigned int nr_of_allowed_users = 1, bool recursive = true, bool force = false);
     void editNextParamOncanvas(SPDesktop *dt);
     void update_satellites(bool recursive = true);
+
+protected:
+    /**
+     * One run of one effect on one shape, split up so that doEffect() can happen on a worker
+     * thread while the rest stays on the main thread.
+     */
+    struct LPEStageRun
+    {
+        SPCurve *curve;
+        SPShape *current;
+        Inkscape::LivePathEffect::Effect *lpe;
+        LPEStageCache *cache = nullptr;
+        std::string cache_key;
+        bool cached = false;              ///< the output came from the cache, doEffect() needn't run
+        std::optional<std::string> error; ///< what doEffect() threw, if it did
+    };
+    void beginPathEffect(LPEStageRun &run, bool is_clip_or_mask);
+    static void runPathEffect(LPEStageRun &run);
+    bool endPathEffect(LPEStageRun &run);
+    /**
+     * The visible effects of the stack if all of them may run on a worker thread, see
+     * Effect::isThreadSafe(), or nothing if any of them must not.
+     */
+    std::vector<Inkscape::LivePathEffect::Effect *> getThreadSafePathEffects() const;
 };
 void sp_lpe_item_update_patheffect (SPLPEItem *lpeitem, bool wholetree, bool write, bool with_satellites = false); // careful, class already has method with *very* similar name!
 void sp_lpe_item_enable_path_effects(SPLPEItem *lpeitem, bool enable);
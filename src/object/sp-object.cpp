@@ -711,9 +711,7 @@ static SPObject *get_closest_child_by_repr(SPObject &obj, Inkscape::XML::Node *r
 void SPObject::child_added(Inkscape::XML::Node *child, Inkscape::XML::Node *ref) {
     SPObject* object = this;
 
-    const std::string type_string = NodeTraits::get_type_string(*child);
-
-    SPObject* ochild = SPFactory::createObject(type_string);
+    SPObject* ochild = SPFactory::createObject(*child);
     if (ochild == nullptr) {
         // Currently, there are many node types that do not have
         // corresponding classes in the SPObject tree.
@@ -799,9 +797,7 @@ void SPObject::build(SPDocument *document, Inkscape::XML::Node *repr) {
         object->clone_original = document->getObjectById(repr->attribute("id"));
 
     for (Inkscape::XML::Node *rchild = repr->firstChild() ; rchild != nullptr; rchild = rchild->next()) {
-        const std::string typeString = NodeTraits::get_type_string(*rchild);
-
-        SPObject* child = SPFactory::createObject(typeString);
+        SPObject* child = SPFactory::createObject(*rchild);
         if (child == nullptr) {
             // Currently, there are many node types that do not have
             // corresponding classes in the SPObject tree.
@@ -1128,12 +1124,12 @@ void SPObject::readAttr(SPAttr keyid)
         return;
     }
 
-    char const *key = sp_attribute_name(keyid);
+    GQuark const key = sp_attribute_quark(keyid);
 
-    assert(key != nullptr);
+    assert(key != 0);
     assert(getRepr() != nullptr);
 
-    char const *value = getRepr()->attribute(key);
+    char const *value = getRepr()->attributeByCode(key);
 
     setKeyValue(keyid, value);
 }
@@ -1154,10 +1150,13 @@ void SPObject::readAttr(gchar const *key)
     }
 }
 
-void SPObject::notifyAttributeChanged(Inkscape::XML::Node &, GQuark key_, Util::ptr_shared, Util::ptr_shared)
+void SPObject::notifyAttributeChanged(Inkscape::XML::Node &, GQuark key, Util::ptr_shared, Util::ptr_shared)
 {
-    auto const key = g_quark_to_string(key_);
-    readAttr(key);
+    // Resolve through the quark table; this runs for every attribute change, including undo.
+    auto keyid = sp_attribute_lookup(key);
+    if (keyid != SPAttr::INVALID) {
+        setKeyValue(keyid, getRepr()->attributeByCode(key));
+    }
 }
 
 void SPObject::notifyContentChanged(Inkscape::XML::Node &, Util::ptr_shared, Util::ptr_shared)
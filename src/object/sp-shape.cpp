@@ -15,6 +15,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 #include <2geom/pathvector.h>
@@ -41,12 +47,21 @@
 #include "svg/path-string.h"
 #include "snap-candidate.h"
 #include "snap-preferences.h"
+#include "live_effects/effect.h"
 #include "live_effects/lpeobject.h"
 
 #define noSHAPE_VERBOSE
 
 static void sp_shape_update_marker_view (SPShape *shape, Inkscape::DrawingItem *ai);
 
+/// Threads for the effects of several shapes at once.
+static boost::asio::thread_pool &lpe_pool()
+{
+    // Created on first use, which is on the main thread, so reading the preferences is fine.
+    static boost::asio::thread_pool pool(Inkscape::Preferences::get()->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256));
+    return pool;
+}
+
 SPShape::SPShape() : SPLPEItem() {
     for (auto & i : this->_marker) {
         i = nullptr;
@@ -853,38 +868,124 @@ std::optional<Geom::PathVector> SPShape::documentExactBounds() const
 }
 
 void SPShape::update_patheffect(bool write)
+{
+    auto c_lpe = beginPatheffectUpdate();
+    if (c_lpe) {
+        bool success = false;
+        if (hasPathEffect() && pathEffectsEnabled()) {
+            success = this->performPathEffect(&*c_lpe, this);
+        }
+        endPatheffectUpdate(*c_lpe, success, write);
+    }
+}
+
+/**
+ * The curve for the effects to work on, or nothing if there is none.
+ */
+std::optional<SPCurve> SPShape::beginPatheffectUpdate()
 {
     if (!curveForEdit()) {
         set_shape();
     }
-    if (curveForEdit()) {
-        auto c_lpe = *curveForEdit();
-        /* if a path has an lpeitem applied, then reset the curve to the _curve_before_lpe.
-         * This is very important for LPEs to work properly! (the bbox might be recalculated depending on the curve in shape)*/
+    if (!curveForEdit()) {
+        return {};
+    }
+    auto c_lpe = *curveForEdit();
+    /* if a path has an lpeitem applied, then reset the curve to the _curve_before_lpe.
+     * This is very important for LPEs to work properly! (the bbox might be recalculated depending on the curve in shape)*/
+    setCurveInsync(&c_lpe);
+
+    // avoid update lpe in each selection
+    // must be set also to non effect items (satellites or parents)
+    lpe_initialized = true; 
+    return c_lpe;
+}
+
+/**
+ * Take over @a c_lpe once the effects have run on it.
+ */
+void SPShape::endPatheffectUpdate(SPCurve &c_lpe, bool success, bool write)
+{
+    if (success) {
+        if (!sp_version_inside_range(document->getRoot()->version.inkscape, 0, 1, 0, 92)) {
+            resetClipPathAndMaskLPE();
+        }
         setCurveInsync(&c_lpe);
-       
+        applyToClipPath(this);
+        applyToMask(this);
+    }
+    if (write && success) {
+        if (auto repr = getRepr()) {
+            repr->setAttribute("d", sp_svg_write_path(c_lpe.get_pathvector()));
+        }
+    }
+    requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
+}
 
-        bool success = false;
-        // avoid update lpe in each selection
-        // must be set also to non effect items (satellites or parents)
-        lpe_initialized = true; 
-        if (hasPathEffect() && pathEffectsEnabled()) {
-            success = this->performPathEffect(&c_lpe, this);
-            if (success) {
-                if (!sp_version_inside_range(document->getRoot()->version.inkscape, 0, 1, 0, 92)) {
-                    resetClipPathAndMaskLPE();
+bool SPShape::canUpdatePatheffectConcurrently() const
+{
+    return !getThreadSafePathEffects().empty();
+}
+
+void SPShape::update_patheffects_concurrently(std::vector<SPShape *> const &shapes, bool write)
+{
+    struct Job
+    {
+        SPShape *shape;
+        SPCurve curve;
+        std::vector<Inkscape::LivePathEffect::Effect *> effects;
+        bool success = true;
+    };
+    std::vector<Job> jobs;
+    for (auto shape : shapes) {
+        if (auto c_lpe = shape->beginPatheffectUpdate()) {
+            jobs.push_back({shape, std::move(*c_lpe), shape->getThreadSafePathEffects()});
+        }
+    }
+
+    // The n-th effects of all shapes form one round. Everything but doEffect() runs here on the
+    // main thread as usual, and the doEffect() calls of a round run at the same time.
+    for (std::size_t stage = 0; ; stage++) {
+        std::vector<std::pair<Job *, LPEStageRun>> runs;
+        for (auto &job : jobs) {
+            if (job.success && stage < job.effects.size()) {
+                auto const lpe = job.effects[stage];
+                if (job.shape->document->isSeeking()) {
+                    lpe->refresh_widgets = true;
                 }
-                setCurveInsync(&c_lpe);
-                applyToClipPath(this);
-                applyToMask(this);
+                runs.emplace_back(&job, LPEStageRun{&job.curve, job.shape, lpe});
+                job.shape->beginPathEffect(runs.back().second, false);
             }
-        } 
-        if (write && success) {
-            if (auto repr = getRepr()) {
-                repr->setAttribute("d", sp_svg_write_path(c_lpe.get_pathvector()));
+        }
+        if (runs.empty()) {
+            break;
+        }
+
+        std::mutex mutables;
+        std::condition_variable finished;
+        auto remaining = std::count_if(runs.begin(), runs.end(), [] (auto const &r) { return !r.second.cached; });
+        for (auto &[job, run] : runs) {
+            if (!run.cached) {
+                boost::asio::post(lpe_pool(), [&, run = &run] {
+                    runPathEffect(*run);
+                    auto lock = std::lock_guard(mutables);
+                    remaining--;
+                    finished.notify_one();
+                });
             }
         }
-        requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
+        {
+            auto lock = std::unique_lock(mutables);
+            finished.wait(lock, [&] { return remaining == 0; });
+        }
+
+        for (auto &[job, run] : runs) {
+            job->success = job->shape->endPathEffect(run);
+        }
+    }
+
+    for (auto &job : jobs) {
+        job.shape->endPatheffectUpdate(job.curve, job.success, write);
     }
 }
 
@@ -25,6 +25,8 @@
 #include "display/curve.h"
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #define SP_SHAPE_WRITE_PATH (1 << 2)
 
@@ -95,8 +97,20 @@ public:
 
 	virtual void set_shape();
 	void update_patheffect(bool write) override;
+    /// Whether the shape can be given to update_patheffects_concurrently().
+    bool canUpdatePatheffectConcurrently() const;
+    /**
+     * Like calling update_patheffect() on each of @a shapes, but with the doEffect() calls of
+     * different shapes running on several threads. The effects are joined before anything is
+     * written back.
+     */
+    static void update_patheffects_concurrently(std::vector<SPShape *> const &shapes, bool write);
 
     void set_marker(unsigned key, char const *value);
+
+private:
+    std::optional<SPCurve> beginPatheffectUpdate();
+    void endPatheffectUpdate(SPCurve &c_lpe, bool success, bool write);
 };
 
 Geom::Affine sp_shape_marker_get_transform(Geom::Curve const & c1, Geom::Curve const & c2);
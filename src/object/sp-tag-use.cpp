@@ -155,8 +155,7 @@ SPTagUse::href_changed(SPObject * /*old_ref*/, SPObject * /*ref*/)
         SPItem *refobj = ref->getObject();
         if (refobj) {
             Inkscape::XML::Node *childrepr = refobj->getRepr();
-            const std::string typeString = NodeTraits::get_type_string(*childrepr);
-            SPObject* child_ = SPFactory::createObject(typeString);
+            SPObject* child_ = SPFactory::createObject(*childrepr);
             if (child_) {
                 child = child_;
                 attach(child_, lastChild());
@@ -610,7 +610,7 @@ void SPUse::href_changed() {
         if (refobj) {
             Inkscape::XML::Node *childrepr = refobj->getRepr();
 
-            SPObject* obj = SPFactory::createObject(NodeTraits::get_type_string(*childrepr));
+            SPObject* obj = SPFactory::createObject(*childrepr);
 
             auto item = cast<SPItem>(obj);
             if (item) {
@@ -10,8 +10,10 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>                                         // for size_t
+#include <iterator>
 #include <glib.h>                                          // for g_assert
 
 #include "snap-preferences.h"
@@ -261,6 +263,17 @@ void Inkscape::SnapPreferences::clearTargetMask(int enabled)
     }
 }
 
+/**
+ * Compare only what the snap points of an item depend on, leaving out transient state such as
+ * snapping being postponed while the mouse moves fast.
+ */
+bool Inkscape::SnapPreferences::sameTargets(SnapPreferences const &other) const
+{
+    return std::equal(std::begin(_active_snap_targets), std::end(_active_snap_targets), std::begin(other._active_snap_targets)) &&
+           std::equal(std::begin(_active_mask_targets), std::end(_active_mask_targets), std::begin(other._active_mask_targets)) &&
+           _object_tolerance == other._object_tolerance;
+}
+
 bool Inkscape::SnapPreferences::isTargetSnappable(Inkscape::SnapTargetType const target) const
 {
     bool always_on = false;
@@ -23,6 +23,8 @@ class SnapPreferences
 {
 public:
     SnapPreferences();
+    /// Whether the same targets are snapped to with the same tolerance, as far as snap points go.
+    bool sameTargets(SnapPreferences const &other) const;
     void setTargetSnappable(Inkscape::SnapTargetType const target, bool enabled);
     bool isTargetSnappable(Inkscape::SnapTargetType const target) const;
     bool isTargetSnappable(Inkscape::SnapTargetType const target1, Inkscape::SnapTargetType const target2) const;
@@ -98,11 +100,11 @@ private:
 
     bool _simple_snapping[static_cast<int>(Inkscape::SimpleSnap::_MaxEnumValue)];
 
-    double _grid_tolerance;
-    double _guide_tolerance;
-    double _object_tolerance;
-    double _alignment_tolerance;
-    double _distribution_tolerance;
+    double _grid_tolerance = 0.0;
+    double _guide_tolerance = 0.0;
+    double _object_tolerance = 0.0;
+    double _alignment_tolerance = 0.0;
+    double _distribution_tolerance = 0.0;
 };
 
 }
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Spatial index for looking up snap targets near a point.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "snap-target-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Inkscape {
+
+void SnapTargetIndex::clear(double cell_size)
+{
+    _cell_size = cell_size > 0 && std::isfinite(cell_size) ? cell_size : 1.0;
+    _bounds.clear();
+    _cells.clear();
+    _oversized.clear();
+    _extent.reset();
+}
+
+int SnapTargetIndex::_cell(double coord) const
+{
+    // Keep well clear of the ends of the int range, so that ranges of cells can be counted.
+    double constexpr limit = std::numeric_limits<int>::max() / 4;
+    return std::clamp(std::floor(coord / _cell_size), -limit, limit);
+}
+
+SnapTargetIndex::CellRange SnapTargetIndex::_cellRange(Geom::Rect const &rect) const
+{
+    return { _cell(rect.left()), _cell(rect.top()), _cell(rect.right()), _cell(rect.bottom()) };
+}
+
+unsigned SnapTargetIndex::insert(Geom::Rect const &bounds)
+{
+    unsigned const id = _bounds.size();
+    _bounds.push_back(bounds);
+
+    auto const range = _cellRange(bounds);
+    if (range.count() > MAX_CELLS_PER_ENTRY) {
+        _oversized.push_back(id);
+        return id;
+    }
+
+    for (int y = range.y0; y <= range.y1; y++) {
+        for (int x = range.x0; x <= range.x1; x++) {
+            _cells[_key(x, y)].push_back(id);
+        }
+    }
+
+    if (_extent) {
+        _extent->x0 = std::min(_extent->x0, range.x0);
+        _extent->y0 = std::min(_extent->y0, range.y0);
+        _extent->x1 = std::max(_extent->x1, range.x1);
+        _extent->y1 = std::max(_extent->y1, range.y1);
+    } else {
+        _extent = range;
+    }
+
+    return id;
+}
+
+std::vector<unsigned> SnapTargetIndex::query(Geom::Rect const &area) const
+{
+    std::vector<unsigned> result;
+
+    auto const hit = [&] (unsigned id) {
+        if (_bounds[id].intersects(area)) {
+            result.push_back(id);
+        }
+    };
+
+    for (auto id : _oversized) {
+        hit(id);
+    }
+
+    if (_extent) {
+        auto range = _cellRange(area);
+        range.x0 = std::max(range.x0, _extent->x0);
+        range.y0 = std::max(range.y0, _extent->y0);
+        range.x1 = std::min(range.x1, _extent->x1);
+        range.y1 = std::min(range.y1, _extent->y1);
+
+        if (range.x0 > range.x1 || range.y0 > range.y1) {
+            // Nothing but oversized entries here.
+        } else if (range.count() > (std::int64_t)_cells.size()) {
+            // Looking up more cells than there are occupied ones; just check every entry.
+            result.clear();
+            for (unsigned id = 0; id < _bounds.size(); id++) {
+                hit(id);
+            }
+            return result;
+        } else {
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++) {
+                    auto it = _cells.find(_key(x, y));
+                    if (it != _cells.end()) {
+                        for (auto id : it->second) {
+                            hit(id);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Entries spanning several cells are found once per cell.
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_SNAP_TARGET_INDEX_H
+#define SEEN_SNAP_TARGET_INDEX_H
+
+/**
+ * @file
+ * Spatial index for looking up snap targets near a point.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <2geom/point.h>
+#include <2geom/rect.h>
+
+namespace Inkscape {
+
+/**
+ * A uniform grid over the bounding boxes of snap targets (points, curves or items), answering
+ * "which targets lie within this rectangle" without looking at all of them.
+ *
+ * Entries are numbered in order of insertion, and queries return these numbers in increasing
+ * order, so that callers visiting the results see the targets in the same order as they would
+ * when looping over all of them.
+ *
+ * The cell size should be about the size of the typical query, i.e. twice the snap tolerance.
+ * Entries that would cover too many cells are kept in a separate list that is always checked.
+ */
+class SnapTargetIndex
+{
+public:
+    explicit SnapTargetIndex(double cell_size = 1.0) { clear(cell_size); }
+
+    /// Remove all entries, and set the cell size for the entries to come.
+    void clear(double cell_size);
+
+    /// Add an entry, returning its number.
+    unsigned insert(Geom::Rect const &bounds);
+    unsigned insert(Geom::Point const &point) { return insert(Geom::Rect(point, point)); }
+
+    /// Number of entries.
+    unsigned size() const { return _bounds.size(); }
+    bool empty() const { return _bounds.empty(); }
+
+    /// Return, in increasing order, the numbers of the entries whose bounds intersect @a area.
+    std::vector<unsigned> query(Geom::Rect const &area) const;
+
+private:
+    static constexpr int MAX_CELLS_PER_ENTRY = 64;
+
+    /// An inclusive range of cells.
+    struct CellRange
+    {
+        int x0, y0, x1, y1;
+        std::int64_t count() const { return (std::int64_t)(x1 - x0 + 1) * (y1 - y0 + 1); }
+    };
+
+    double _cell_size;
+    std::vector<Geom::Rect> _bounds;
+    std::unordered_map<std::uint64_t, std::vector<unsigned>> _cells;
+    std::vector<unsigned> _oversized;
+    std::optional<CellRange> _extent; ///< Cells in use.
+
+    CellRange _cellRange(Geom::Rect const &rect) const;
+    int _cell(double coord) const;
+    static std::uint64_t _key(int x, int y) { return (std::uint64_t)(std::uint32_t)x << 32 | (std::uint32_t)y; }
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_SNAP_TARGET_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
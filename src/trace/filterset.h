@@ -20,18 +20,18 @@ namespace Inkscape {
 namespace Trace {
 
 /**
- * Apply gaussian blur to an GrayMap.
+ * Apply gaussian blur to an GrayMap, on up to nthreads threads.
  */
-GrayMap grayMapGaussian(GrayMap const &gmap);
+GrayMap grayMapGaussian(GrayMap const &gmap, int nthreads = 1);
 
 /**
- * Apply gaussian blur to an RgbMap.
+ * Apply gaussian blur to an RgbMap, on up to nthreads threads.
  */
-RgbMap rgbMapGaussian(RgbMap const &rgbmap);
+RgbMap rgbMapGaussian(RgbMap const &rgbmap, int nthreads = 1);
 
-GrayMap grayMapCanny(GrayMap const &gmap, double lowThreshold, double highThreshold);
+GrayMap grayMapCanny(GrayMap const &gmap, double lowThreshold, double highThreshold, int nthreads = 1);
 
-GrayMap quantizeBand(RgbMap const &rgbmap, int nrColors);
+GrayMap quantizeBand(RgbMap const &rgbmap, int nrColors, int nthreads = 1);
 
 } // namespace Trace
 } // namespace Inkscape
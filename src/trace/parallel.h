@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Splitting the rows or columns of a bitmap between threads.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#ifndef INKSCAPE_TRACE_PARALLEL_H
+#define INKSCAPE_TRACE_PARALLEL_H
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+namespace Inkscape {
+namespace Trace {
+
+/**
+ * Call f(first, last) for consecutive ranges covering [0, count), running up to nthreads of
+ * them at once. Ranges are at least min_size long, so small bitmaps are done on the calling
+ * thread in one go.
+ */
+template <typename F>
+void parallel_ranges(int count, int nthreads, F &&f, int min_size = 16)
+{
+    int const nranges = std::clamp(count / std::max(min_size, 1), 1, std::max(nthreads, 1));
+    if (nranges == 1) {
+        f(0, count);
+        return;
+    }
+
+    auto pool = boost::asio::thread_pool(nranges);
+    for (int i = 0; i < nranges; i++) {
+        boost::asio::post(pool, [&, i] {
+            f((long)count * i / nranges, (long)count * (i + 1) / nranges);
+        });
+    }
+    pool.join();
+}
+
+} // namespace Trace
+} // namespace Inkscape
+
+#endif // INKSCAPE_TRACE_PARALLEL_H
@@ -14,13 +14,22 @@
  * is provided by the generosity of Peter Selinger, to whom we are grateful.
  *
  */
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iomanip>
+#include <mutex>
+#include <thread>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <glibmm/i18n.h>
 #include <potracelib.h>
 
 #include "inkscape-potrace.h"
 #include "bitmap.h"
 
+#include "preferences.h"
 #include "async/progress.h"
 #include "trace/filterset.h"
 #include "trace/quantize.h"
@@ -39,6 +48,63 @@ Glib::ustring twohex(int value)
     return Glib::ustring::format(std::hex, std::setfill(L'0'), std::setw(2), value);
 }
 
+using Inkscape::Trace::GrayMap;
+
+/**
+ * Mark as black the pixels of \a gm whose brightness lies in [floor, threshold).
+ */
+GrayMap brightnessBand(GrayMap const &gm, double floor, double threshold)
+{
+    auto map = GrayMap(gm.width, gm.height);
+
+    double const lo = 3.0 * floor * 256.0;
+    double const hi = 3.0 * threshold * 256.0;
+    for (int y = 0; y < gm.height; y++) {
+        for (int x = 0; x < gm.width; x++) {
+            double brightness = gm.getPixel(x, y);
+            bool black = brightness >= lo && brightness < hi;
+            map.setPixel(x, y, black ? GrayMap::BLACK : GrayMap::WHITE);
+        }
+    }
+
+    return map;
+}
+
+void invertGrayMap(GrayMap &map)
+{
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            map.setPixel(x, y, GrayMap::WHITE - map.getPixel(x, y));
+        }
+    }
+}
+
+/**
+ * The progress of one scan of a multi-scan trace. It is written by the worker tracing the scan
+ * and read by the thread driving the trace, which forwards the total to the real Progress, since
+ * that need not be thread-safe.
+ */
+class ScanProgress final
+    : public Inkscape::Async::Progress<double>
+{
+public:
+    explicit ScanProgress(std::atomic<bool> const &cancelled) : cancelled(&cancelled) {}
+
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> const *cancelled;
+    std::atomic<double> value = 0.0;
+
+    bool _keepgoing() const override { return !cancelled->load(std::memory_order_relaxed); }
+
+    bool _report(double const &progress) override
+    {
+        value.store(progress, std::memory_order_relaxed);
+        return _keepgoing();
+    }
+};
+
 } // namespace
 
 namespace Inkscape {
@@ -62,6 +128,9 @@ PotraceTracingEngine::PotraceTracingEngine(TraceType traceType, bool invert, int
 void PotraceTracingEngine::common_init()
 {
     potraceParams = potrace_param_default();
+
+    // Read here rather than in trace(), which runs off the main thread.
+    numThreads = Inkscape::Preferences::get()->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256);
 }
 
 PotraceTracingEngine::~PotraceTracingEngine()
@@ -149,23 +218,13 @@ std::optional<GrayMap> PotraceTracingEngine::filter(Glib::RefPtr<Gdk::Pixbuf> co
         // Color quantization -- banding
         auto rgbmap = gdkPixbufToRgbMap(pixbuf);
         // rgbMap->writePPM(rgbMap, "rgb.ppm");
-        map = quantizeBand(rgbmap, quantizationNrColors);
+        map = quantizeBand(rgbmap, quantizationNrColors, numThreads);
 
     } else if (traceType == TraceType::BRIGHTNESS || traceType == TraceType::BRIGHTNESS_MULTI) {
 
         // Brightness threshold
         auto gm = gdkPixbufToGrayMap(pixbuf);
-        map = GrayMap(gm.width, gm.height);
-
-        double floor = 3.0 * brightnessFloor * 256.0;
-        double cutoff = 3.0 * brightnessThreshold * 256.0;
-        for (int y = 0; y < gm.height; y++) {
-            for (int x = 0; x < gm.width; x++) {
-                double brightness = gm.getPixel(x, y);
-                bool black = brightness >= floor && brightness < cutoff;
-                map->setPixel(x, y, black ? GrayMap::BLACK : GrayMap::WHITE);
-            }
-        }
+        map = brightnessBand(gm, brightnessFloor, brightnessThreshold);
 
         // map->writePPM(map, "brightness.ppm");
 
@@ -173,20 +232,14 @@ std::optional<GrayMap> PotraceTracingEngine::filter(Glib::RefPtr<Gdk::Pixbuf> co
 
         // Canny edge detection
         auto gm = gdkPixbufToGrayMap(pixbuf);
-        map = grayMapCanny(gm, 0.1, cannyHighThreshold);
+        map = grayMapCanny(gm, 0.1, cannyHighThreshold, numThreads);
         // map->writePPM(map, "canny.ppm");
 
     }
 
     // Invert the image if necessary.
     if (map && invert) {
-        for (int y = 0; y < map->height; y++) {
-            for (int x = 0; x < map->width; x++) {
-                auto brightness = map->getPixel(x, y);
-                brightness = GrayMap::WHITE - brightness;
-                map->setPixel(x, y, brightness);
-            }
-        }
+        invertGrayMap(*map);
     }
 
     return map;
@@ -197,10 +250,10 @@ IndexedMap PotraceTracingEngine::filterIndexed(Glib::RefPtr<Gdk::Pixbuf> const &
     auto map = gdkPixbufToRgbMap(pixbuf);
 
     if (multiScanSmooth) {
-        map = rgbMapGaussian(map);
+        map = rgbMapGaussian(map, numThreads);
     }
 
-    auto imap = rgbMapQuantize(map, multiScanNrColors);
+    auto imap = rgbMapQuantize(map, multiScanNrColors, numThreads);
 
     auto tomono = [] (RGB c) -> RGB {
         unsigned char s = ((int)c.r + (int)c.g + (int)c.b) / 3;
@@ -241,7 +294,7 @@ Glib::RefPtr<Gdk::Pixbuf> PotraceTracingEngine::preview(Glib::RefPtr<Gdk::Pixbuf
 /**
  * This is the actual wrapper of the call to Potrace.
  */
-Geom::PathVector PotraceTracingEngine::grayMapToPath(GrayMap const &grayMap, Async::Progress<double> &progress)
+Geom::PathVector PotraceTracingEngine::grayMapToPath(GrayMap const &grayMap, Async::Progress<double> &progress) const
 {
     auto potraceBitmap = potrace_bitmap_uniqptr(bm_new(grayMap.width, grayMap.height));
     if (!potraceBitmap) {
@@ -270,9 +323,11 @@ Geom::PathVector PotraceTracingEngine::grayMapToPath(GrayMap const &grayMap, Asy
 
     auto throttled = Async::ProgressStepThrottler(progress, 0.02);
 
-    potraceParams->progress.data = &throttled;
-    potraceParams->progress.callback = [] (double progress, void *data) { reinterpret_cast<decltype(throttled)*>(data)->report(progress); };
-    auto potraceState = potrace_state_uniqptr(potrace_trace(potraceParams, potraceBitmap.get()));
+    // Use a private copy of the parameters, as several scans may be traced at once.
+    auto params = *potraceParams;
+    params.progress.data = &throttled;
+    params.progress.callback = [] (double progress, void *data) { reinterpret_cast<decltype(throttled)*>(data)->report(progress); };
+    auto potraceState = potrace_state_uniqptr(potrace_trace(&params, potraceBitmap.get()));
 
     potraceBitmap.reset();
 
@@ -285,6 +340,92 @@ Geom::PathVector PotraceTracingEngine::grayMapToPath(GrayMap const &grayMap, Asy
     return builder.peek();
 }
 
+/**
+ * Trace \a count scans concurrently, returning their paths in scan order. The graymap of each
+ * scan is built by \a scan, which is called from the worker threads.
+ *
+ * Progress is reported on the calling thread only. Once cancelled, scans not yet started are
+ * skipped and those in progress stop at their next check.
+ */
+std::vector<Geom::PathVector> PotraceTracingEngine::traceScans(int count, std::function<GrayMap(int)> const &scan, Async::Progress<double> &progress) const
+{
+    std::vector<Geom::PathVector> paths(count);
+    if (count == 0) {
+        return paths;
+    }
+
+    std::atomic<bool> cancelled = false;
+    std::deque<ScanProgress> scan_progress; // not movable, so not a vector
+    for (int i = 0; i < count; i++) {
+        scan_progress.emplace_back(cancelled);
+    }
+
+    std::mutex mutables;
+    std::condition_variable finished;
+    int remaining = count;
+    std::exception_ptr error;
+
+    auto pool = boost::asio::thread_pool(std::min(numThreads, count));
+
+    for (int i = 0; i < count; i++) {
+        boost::asio::post(pool, [&, i] {
+            auto &subprogress = scan_progress[i];
+
+            try {
+                subprogress.throw_if_cancelled();
+
+                auto grayMap = scan(i);
+                subprogress.report_or_throw(0.2);
+
+                auto sub_gmtopath = Async::SubProgress(subprogress, 0.2, 0.8);
+                paths[i] = grayMapToPath(grayMap, sub_gmtopath);
+                subprogress.report(1.0);
+            } catch (Async::CancelledException const &) {
+                // Nothing to do; the driving thread will throw.
+            } catch (...) {
+                auto lock = std::lock_guard(mutables);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                cancelled = true;
+            }
+
+            auto lock = std::lock_guard(mutables);
+            remaining--;
+            finished.notify_one();
+        });
+    }
+
+    while (true) {
+        {
+            auto lock = std::unique_lock(mutables);
+            finished.wait_for(lock, std::chrono::milliseconds(20), [&] { return remaining == 0; });
+            if (remaining == 0) {
+                break;
+            }
+        }
+
+        double total = 0.0;
+        for (auto const &p : scan_progress) {
+            total += p.get();
+        }
+        if (!progress.report(total / count)) {
+            cancelled = true;
+        }
+    }
+
+    pool.join();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (cancelled) {
+        throw Async::CancelledException();
+    }
+
+    return paths;
+}
+
 /**
  * This is called for a single scan.
  */
@@ -328,40 +469,50 @@ TraceResult PotraceTracingEngine::traceBrightnessMulti(Glib::RefPtr<Gdk::Pixbuf>
     double constexpr high  = 0.9; // top of range
     double const     delta = (high - low) / multiScanNrColors;
 
-    brightnessFloor = 0.0; // Set bottom to black
+    auto const gm = gdkPixbufToGrayMap(pixbuf);
 
-    TraceResult results;
+    auto threshold = [&] (int i) { return low + delta * i; };
 
-    for (int i = 0; i < multiScanNrColors; i++) {
-        auto subprogress = Async::SubProgress(progress, (double)i / multiScanNrColors, 1.0 / multiScanNrColors);
+    auto band = [&] (int i, double floor) {
+        auto map = brightnessBand(gm, floor, threshold(i));
+        if (invert) {
+            invertGrayMap(map);
+        }
+        return map;
+    };
 
-        brightnessThreshold = low + delta * i;
+    // When tiling, each scan starts where the last non-empty one ended. Trace all scans at once
+    // on the assumption that none is empty, then redo the few for which that turns out false.
+    auto guessed_floor = [&] (int i) { return multiScanStack || i == 0 ? 0.0 : threshold(i - 1); };
 
-        auto grayMap = filter(pixbuf);
-        if (!grayMap) {
-            continue;
-        }
+    auto paths = traceScans(multiScanNrColors, [&] (int i) { return band(i, guessed_floor(i)); }, progress);
 
-        subprogress.report_or_throw(0.2);
+    TraceResult results;
+
+    double floor = 0.0; // Set bottom to black
 
-        auto sub_gmtopath = Async::SubProgress(subprogress, 0.2, 0.8);
-        auto pv = grayMapToPath(*grayMap, sub_gmtopath);
+    for (int i = 0; i < multiScanNrColors; i++) {
+        if (floor != guessed_floor(i)) {
+            // Reports nothing, but still honours cancellation.
+            auto retrace = Async::SubProgress(progress, 1.0, 0.0);
+            paths[i] = grayMapToPath(band(i, floor), retrace);
+        }
+
+        auto &pv = paths[i];
         if (pv.empty()) {
             continue;
         }
 
         // get style info
-        int grayVal = 256.0 * brightnessThreshold;
+        int grayVal = 256.0 * threshold(i);
         auto style = Glib::ustring::compose("fill-opacity:1.0;fill:#%1%2%3", twohex(grayVal), twohex(grayVal), twohex(grayVal));
 
         // g_message("### GOT '%s' \n", style.c_str());
         results.emplace_back(style.raw(), std::move(pv));
 
         if (!multiScanStack) {
-            brightnessFloor = brightnessThreshold;
+            floor = threshold(i);
         }
-
-        subprogress.report_or_throw(1.0);
     }
 
     // Remove the bottom-most scan, if requested.
@@ -377,47 +528,34 @@ TraceResult PotraceTracingEngine::traceBrightnessMulti(Glib::RefPtr<Gdk::Pixbuf>
  */
 TraceResult PotraceTracingEngine::traceQuant(Glib::RefPtr<Gdk::Pixbuf> const &pixbuf, Async::Progress<double> &progress)
 {
-    auto imap = filterIndexed(pixbuf);
+    auto const imap = filterIndexed(pixbuf);
 
-    // Create and clear a gray map
-    auto gm = GrayMap(imap.width, imap.height);
-    for (int row = 0; row < gm.height; row++) {
-        for (int col = 0; col < gm.width; col++) {
-            gm.setPixel(col, row, GrayMap::WHITE);
-        }
-    }
-
-    TraceResult results;
-
-    for (int colorIndex = 0; colorIndex < imap.nrColors; colorIndex++) {
-        auto subprogress = Async::SubProgress(progress, (double)colorIndex / imap.nrColors, 1.0 / imap.nrColors);
-
-        // Update the graymap for the current color index
+    // Build the graymap for a color index: just that color when tiling, or it and all colors
+    // before it when stacking.
+    auto scan = [&] (int colorIndex) {
+        auto gm = GrayMap(imap.width, imap.height);
         for (int row = 0; row < imap.height; row++) {
             for (int col = 0; col < imap.width; col++) {
                 int index = imap.getPixel(col, row);
-                if (index == colorIndex) {
-                    gm.setPixel(col, row, GrayMap::BLACK);
-                } else if (!multiScanStack) {
-                    gm.setPixel(col, row, GrayMap::WHITE);
-                }
+                bool black = multiScanStack ? index <= colorIndex : index == colorIndex;
+                gm.setPixel(col, row, black ? GrayMap::BLACK : GrayMap::WHITE);
             }
         }
+        return gm;
+    };
 
-        subprogress.report_or_throw(0.2);
+    auto paths = traceScans(imap.nrColors, scan, progress);
 
-        // Now we have a traceable graymap
-        auto sub_gmtopath = Async::SubProgress(subprogress, 0.2, 0.8);
-        auto pv = grayMapToPath(gm, sub_gmtopath);
+    TraceResult results;
 
+    for (int colorIndex = 0; colorIndex < imap.nrColors; colorIndex++) {
+        auto &pv = paths[colorIndex];
         if (!pv.empty()) {
             // get style info
             auto rgb = imap.clut[colorIndex];
             auto style = Glib::ustring::compose("fill:#%1%2%3", twohex(rgb.r), twohex(rgb.g), twohex(rgb.b));
             results.emplace_back(style.raw(), std::move(pv));
         }
-
-        subprogress.report_or_throw(1.0);
     }
 
     // Remove the bottom-most scan, if requested.
@@ -17,8 +17,10 @@
 #ifndef INKSCAPE_TRACE_POTRACE_H
 #define INKSCAPE_TRACE_POTRACE_H
 
+#include <functional>
 #include <optional>
 #include <unordered_set>
+#include <vector>
 #include <boost/functional/hash.hpp>
 #include <2geom/point.h>
 #include <2geom/path-sink.h>
@@ -96,6 +98,9 @@ private:
     bool multiScanSmooth = false; // do we use gaussian filter?
     bool multiScanRemoveBackground = false; // do we remove the bottom trace?
 
+    // Number of scans of a multi-scan trace that are traced at once.
+    int numThreads = 1;
+
     void common_init();
 
     TraceResult traceQuant          (Glib::RefPtr<Gdk::Pixbuf> const &pixbuf, Async::Progress<double> &progress);
@@ -105,7 +110,8 @@ private:
     IndexedMap filterIndexed(Glib::RefPtr<Gdk::Pixbuf> const &pixbuf) const;
     std::optional<GrayMap> filter(Glib::RefPtr<Gdk::Pixbuf> const &pixbuf) const;
 
-    Geom::PathVector grayMapToPath(GrayMap const &gm, Async::Progress<double> &progress);
+    Geom::PathVector grayMapToPath(GrayMap const &gm, Async::Progress<double> &progress) const;
+    std::vector<Geom::PathVector> traceScans(int count, std::function<GrayMap(int)> const &scan, Async::Progress<double> &progress) const;
 
     void writePaths(potrace_path_t *paths, Geom::PathBuilder &builder, std::unordered_set<Geom::Point> &points, Async::Progress<double> &progress) const;
 };
@@ -9,13 +9,18 @@
  *
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
+#include <vector>
 #include <glib.h>
 
 #include "pool.h"
 #include "imagemap.h"
+#include "parallel.h"
 #include "quantize.h"
 
 namespace Inkscape {
@@ -495,24 +500,93 @@ int distRGB(RGB rgb1, RGB rgb2)
 }
 
 /**
- * find the index of closest color in a palette
+ * find the index of closest color in a palette, without trying every color.
+ *
+ * the color cube is divided into cells, and each cell lists the palette
+ * entries which can be the closest one to some color inside it: the color
+ * nearest to a cell's farthest corner bounds the distance of the closest
+ * entry from anywhere in the cell, so entries which don't come that close to
+ * the cell are left out. entries are listed in palette order, keeping ties
+ * resolved the same way.
  */
-int findRGB(RGB const *rgbs, int ncolor, RGB rgb)
+class PaletteLookup
 {
-    int index = -1, dist = 0;
-    for (int k = 0; k < ncolor; k++) {
-        int d = distRGB(rgbs[k], rgb);
-        if (index == -1 || d < dist) { dist = d; index = k; }
+public:
+    PaletteLookup(RGB const *rgbs, int ncolor)
+        : _rgbs(rgbs)
+    {
+        // candidates are stored as bytes
+        assert(ncolor <= 256);
+
+        std::vector<int> maxdist(ncolor);
+        for (int cell = 0; cell < NCELLS; cell++) {
+            RGB const lo = cellOrigin(cell);
+            int bound = -1;
+            for (int k = 0; k < ncolor; k++) {
+                maxdist[k] = distToCell(rgbs[k], lo, true);
+                if (bound == -1 || maxdist[k] < bound) bound = maxdist[k];
+            }
+            _first[cell] = _candidates.size();
+            for (int k = 0; k < ncolor; k++) {
+                if (distToCell(rgbs[k], lo, false) <= bound) {
+                    _candidates.push_back(k);
+                }
+            }
+        }
+        _first[NCELLS] = _candidates.size();
     }
-    return index;
-}
+
+    int find(RGB rgb) const
+    {
+        int const cell = ((rgb.r >> SHIFT) << (2 * BITS)) | ((rgb.g >> SHIFT) << BITS) | (rgb.b >> SHIFT);
+        int index = -1, dist = 0;
+        for (auto i = _first[cell]; i < _first[cell + 1]; i++) {
+            int const k = _candidates[i];
+            int d = distRGB(_rgbs[k], rgb);
+            if (index == -1 || d < dist) { dist = d; index = k; }
+        }
+        return index;
+    }
+
+private:
+    static constexpr int BITS = 4; // cells per channel: 2^BITS
+    static constexpr int SHIFT = 8 - BITS;
+    static constexpr int NCELLS = 1 << (3 * BITS);
+
+    static RGB cellOrigin(int cell)
+    {
+        int const mask = (1 << BITS) - 1;
+        return { (unsigned char)((cell >> (2 * BITS) & mask) << SHIFT),
+                 (unsigned char)((cell >> BITS & mask) << SHIFT),
+                 (unsigned char)((cell & mask) << SHIFT) };
+    }
+
+    /**
+     * squared distance from <rgb> to the nearest (or farthest) color of the
+     * cell starting at <lo>
+     */
+    static int distToCell(RGB rgb, RGB lo, bool farthest)
+    {
+        auto axis = [=] (int c, int l) {
+            int h = l + (1 << SHIFT) - 1;
+            int d = farthest ? std::max(std::abs(c - l), std::abs(c - h))
+                             : c < l ? l - c : c > h ? c - h : 0;
+            return d * d;
+        };
+        return axis(rgb.r, lo.r) + axis(rgb.g, lo.g) + axis(rgb.b, lo.b);
+    }
+
+    RGB const *_rgbs;
+    std::vector<unsigned char> _candidates;
+    std::array<std::size_t, NCELLS + 1> _first;
+};
 
 } // namespace
 
 /**
  * quantize an RGB image to a reduced number of colors.
  */
-IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int ncolor)
+IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int ncolor, int nthreads)
 {
     assert(ncolor > 0);
 
@@ -528,7 +602,7 @@ IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int ncolor)
     octreeDelete(pool, tree);
 
     // stacking with increasing contrasts
-    std::sort(rgbs.get(), rgbs.get() + ncolor, [] (auto &ra, auto &rb) {
+    std::sort(rgbs.get(), rgbs.get() + index, [] (auto &ra, auto &rb) {
         return (ra.r + ra.g + ra.b) < (rb.r + rb.g + rb.b);
     });
 
@@ -539,14 +613,25 @@ IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int ncolor)
     }
     imap.nrColors = index;
 
-    // fill in new map pixels
-    for (int y = 0; y < rgbmap.height; y++) {
-        for (int x = 0; x < rgbmap.width; x++) {
-            auto rgb = rgbmap.getPixel(x, y);
-            int index = findRGB(rgbs.get(), ncolor, rgb);
-            imap.setPixel(x, y, index);
+    // fill in new map pixels, in bands of rows on several threads
+    auto const lookup = PaletteLookup(rgbs.get(), index);
+    auto remap = [&] (int y1, int y2) {
+        // neighbouring pixels often share their color
+        RGB last{};
+        int last_index = lookup.find(last);
+        for (int y = y1; y < y2; y++) {
+            for (int x = 0; x < rgbmap.width; x++) {
+                auto rgb = rgbmap.getPixel(x, y);
+                if (!(rgb == last)) {
+                    last = rgb;
+                    last_index = lookup.find(rgb);
+                }
+                imap.setPixel(x, y, last_index);
+            }
         }
-    }
+    };
+
+    parallel_ranges(rgbmap.height, nthreads, remap);
 
     return imap;
 }
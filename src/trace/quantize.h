@@ -18,9 +18,10 @@ namespace Inkscape {
 namespace Trace {
 
 /**
- * Quantize an RGB image to a reduced number of colors.
+ * Quantize an RGB image to a reduced number of colors, mapping the pixels to
+ * the reduced palette on up to nthreads threads.
  */
-IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int nrColors);
+IndexedMap rgbMapQuantize(RgbMap const &rgbmap, int nrColors, int nthreads = 1);
 
 } // namespace Trace
 } // namespace Inkscape
@@ -14,6 +14,7 @@
 #include <cassert>
 
 #include "siox.h"
+#include "parallel.h"
 #include "async/progress.h"
 
 namespace Inkscape {
@@ -122,34 +123,38 @@ namespace {
 
 /**
  * Apply a function which updates each pixel depending on the value of its neighbours.
+ *
+ * Each of the four sweeps only reads pixels it hasn't updated yet, so the horizontal ones can
+ * be done row by row and the vertical ones column by column, in parallel.
  */
 template <typename F>
-void apply_adjacent(float *cm, int xres, int yres, F f)
+void apply_adjacent(float *cm, int xres, int yres, int nthreads, F f)
 {
-    for (int y = 0; y < yres; y++) {
-        for (int x = 0; x < xres - 1; x++) {
-            int idx = y * xres + x;
-            f(cm[idx], cm[idx + 1]);
-        }
-    }
-    for (int y = 0; y < yres; y++) {
-        for (int x = xres - 1; x >= 1; x--) {
-            int idx = y * xres + x;
-            f(cm[idx], cm[idx - 1]);
+    parallel_ranges(yres, nthreads, [&] (int y1, int y2) {
+        for (int y = y1; y < y2; y++) {
+            float *row = cm + y * xres;
+            for (int x = 0; x < xres - 1; x++) {
+                f(row[x], row[x + 1]);
+            }
+            for (int x = xres - 1; x >= 1; x--) {
+                f(row[x], row[x - 1]);
+            }
         }
-    }
-    for (int y = 0; y < yres - 1; y++) {
-        for (int x = 0; x < xres; x++) {
-            int idx = y * xres + x;
-            f(cm[idx], cm[idx + xres]);
+    });
+    parallel_ranges(xres, nthreads, [&] (int x1, int x2) {
+        for (int y = 0; y < yres - 1; y++) {
+            float *row = cm + y * xres;
+            for (int x = x1; x < x2; x++) {
+                f(row[x], row[x + xres]);
+            }
         }
-    }
-    for (int y = yres - 1; y >= 1; y--) {
-        for (int x = 0; x < xres; x++) {
-            int idx = y * xres + x;
-            f(cm[idx], cm[idx - xres]);
+        for (int y = yres - 1; y >= 1; y--) {
+            float *row = cm + y * xres;
+            for (int x = x1; x < x2; x++) {
+                f(row[x], row[x - xres]);
+            }
         }
-    }
+    }, 64);
 }
 
 /**
@@ -157,24 +162,20 @@ void apply_adjacent(float *cm, int xres, int yres, F f)
  *
  * Can be used to close small holes in the given confidence matrix.
  */
-void dilate(float *cm, int xres, int yres)
+void dilate(float *cm, int xres, int yres, int nthreads)
 {
-    apply_adjacent(cm, xres, yres, [] (float &a, float b) {
-        if (b > a) {
-            a = b;
-        }
+    apply_adjacent(cm, xres, yres, nthreads, [] (float &a, float b) {
+        a = std::max(a, b);
     });
 }
 
 /**
  * Applies the morphological erode operator.
  */
-void erode(float *cm, int xres, int yres)
+void erode(float *cm, int xres, int yres, int nthreads)
 {
-    apply_adjacent(cm, xres, yres, [] (float &a, float b) {
-        if (b < a) {
-            a = b;
-        }
+    apply_adjacent(cm, xres, yres, nthreads, [] (float &a, float b) {
+        a = std::min(a, b);
     });
 }
 
@@ -212,34 +213,35 @@ void normalizeMatrix(float *cm, int cmSize)
  * Blurs confidence matrix with a given symmetrically weighted kernel.
  *
  * In the standard case confidence matrix entries are between 0...1 and
- * the weight factors sum up to 1.
+ * the weight factors sum up to 1. The sweeps are split up like in apply_adjacent().
  */
-void smooth(float *cm, int xres, int yres, float f1, float f2, float f3)
+void smooth(float *cm, int xres, int yres, float f1, float f2, float f3, int nthreads)
 {
-    for (int y = 0; y < yres; y++) {
-        for (int x = 0; x < xres - 2; x++) {
-            int idx = y * xres + x;
-            cm[idx] = f1 * cm[idx] + f2 * cm[idx + 1] + f3 * cm[idx + 2];
-        }
-    }
-    for (int y = 0; y < yres; y++) {
-        for (int x = xres - 1; x >= 2; x--) {
-            int idx = y * xres + x;
-            cm[idx] = f3 * cm[idx - 2] + f2 * cm[idx - 1] + f1 * cm[idx];
+    parallel_ranges(yres, nthreads, [&] (int y1, int y2) {
+        for (int y = y1; y < y2; y++) {
+            float *row = cm + y * xres;
+            for (int x = 0; x < xres - 2; x++) {
+                row[x] = f1 * row[x] + f2 * row[x + 1] + f3 * row[x + 2];
+            }
+            for (int x = xres - 1; x >= 2; x--) {
+                row[x] = f3 * row[x - 2] + f2 * row[x - 1] + f1 * row[x];
+            }
         }
-    }
-    for (int y = 0; y < yres - 2; y++) {
-        for (int x = 0; x < xres; x++) {
-            int idx = y * xres + x;
-            cm[idx] = f1 * cm[idx] + f2 * cm[((y + 1) * xres) + x] + f3 * cm[((y + 2) * xres) + x];
+    });
+    parallel_ranges(xres, nthreads, [&] (int x1, int x2) {
+        for (int y = 0; y < yres - 2; y++) {
+            float *row = cm + y * xres;
+            for (int x = x1; x < x2; x++) {
+                row[x] = f1 * row[x] + f2 * row[x + xres] + f3 * row[x + 2 * xres];
+            }
         }
-    }
-    for (int y = yres - 1; y >= 2; y--) {
-        for (int x = 0; x < xres; x++) {
-            int idx = y * xres + x;
-            cm[idx] = f3 * cm[((y - 2) * xres) + x] + f2 * cm[((y - 1) * xres) + x] + f1 * cm[idx];
+        for (int y = yres - 1; y >= 2; y--) {
+            float *row = cm + y * xres;
+            for (int x = x1; x < x2; x++) {
+                row[x] = f3 * row[x - 2 * xres] + f2 * row[x - xres] + f1 * row[x];
+            }
         }
-    }
+    }, 64);
 }
 
 /**
@@ -257,8 +259,9 @@ float sqrEuclideanDist(float *p, int pSize, float *q)
 
 } // namespace
 
-Siox::Siox(Async::Progress<double> &progress)
+Siox::Siox(Async::Progress<double> &progress, int nthreads)
     : progress(&progress)
+    , nthreads(nthreads)
     , width(0)
     , height(0)
     , pixelCount(0)
@@ -384,13 +387,13 @@ SioxImage Siox::extractForeground(SioxImage const &originalImage, uint32_t backg
     trace("### postProcessing");
 
     // Postprocessing
-    smooth(cm, width, height, 0.333f, 0.333f, 0.333f); // average
+    smooth(cm, width, height, 0.333f, 0.333f, 0.333f, nthreads); // average
     normalizeMatrix(cm, pixelCount);
-    erode(cm, width, height);
+    erode(cm, width, height, nthreads);
     keepOnlyLargeComponents(UNKNOWN_REGION_CONFIDENCE, 1.0/*sizeFactorToKeep*/);
 
     // for (int i = 0; i < 2/*smoothness*/; i++)
-    //     smooth(cm, width, height, 0.333f, 0.333f, 0.333f); // average
+    //     smooth(cm, width, height, 0.333f, 0.333f, 0.333f, nthreads); // average
 
     normalizeMatrix(cm, pixelCount);
 
@@ -402,7 +405,7 @@ SioxImage Siox::extractForeground(SioxImage const &originalImage, uint32_t backg
 
     keepOnlyLargeComponents(UNKNOWN_REGION_CONFIDENCE, 1.5/*sizeFactorToKeep*/);
     fillColorRegions();
-    dilate(cm, width, height);
+    dilate(cm, width, height, nthreads);
 
     progress->report_or_throw(1.0);
 
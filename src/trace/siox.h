@@ -125,7 +125,8 @@ public:
      */
     static constexpr float CERTAIN_BACKGROUND_CONFIDENCE = 0.0f;
 
-    Siox(Async::Progress<double> &progress);
+    /// Runs the filters over the confidence matrix on up to nthreads threads.
+    Siox(Async::Progress<double> &progress, int nthreads = 1);
 
     /**
      * Extract the foreground of the original image, according to the values in the confidence matrix.
@@ -140,6 +141,7 @@ public:
 
 private:
     Async::Progress<double> *progress;
+    int nthreads;
 
     int width;       ///< Width of the image
     int height;      ///< Height of the image
@@ -20,6 +20,7 @@
 #include <cassert>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <2geom/transforms.h>
 #include <glibmm/i18n.h>
 #include <glibmm/ustring.h>
@@ -32,6 +33,7 @@
 #include "helper/geom.h"
 #include "inkscape.h"
 #include "message-stack.h"
+#include "preferences.h"
 #include "selection.h"
 #include "svg/svg.h"
 #include "async/async.h"
@@ -176,7 +178,7 @@ public:
         return instance;
     }
 
-    Glib::RefPtr<Gdk::Pixbuf> process(SioxImage const &sioximage, Async::Progress<double> &progress) const;
+    Glib::RefPtr<Gdk::Pixbuf> process(SioxImage const &sioximage, Async::Progress<double> &progress, int nthreads) const;
 
 private:
     mutable std::mutex mutables;
@@ -186,7 +188,7 @@ private:
     SioxImageCache() = default;
 };
 
-Glib::RefPtr<Gdk::Pixbuf> SioxImageCache::process(SioxImage const &sioximage, Async::Progress<double> &progress) const
+Glib::RefPtr<Gdk::Pixbuf> SioxImageCache::process(SioxImage const &sioximage, Async::Progress<double> &progress, int nthreads) const
 {
     auto hash = sioximage.hash();
 
@@ -196,7 +198,7 @@ Glib::RefPtr<Gdk::Pixbuf> SioxImageCache::process(SioxImage const &sioximage, As
         return last_result;
     }
 
-    auto result = Siox(progress).extractForeground(sioximage, 0xffffff);
+    auto result = Siox(progress, nthreads).extractForeground(sioximage, 0xffffff);
 
     // result.writePPM("siox2.ppm");
 
@@ -206,7 +208,7 @@ Glib::RefPtr<Gdk::Pixbuf> SioxImageCache::process(SioxImage const &sioximage, As
     return last_result;
 }
 
-Glib::RefPtr<Gdk::Pixbuf> sioxProcessImage(Glib::RefPtr<Gdk::Pixbuf> pixbuf, Cairo::RefPtr<Cairo::ImageSurface> siox_mask, Async::Progress<double> &progress)
+Glib::RefPtr<Gdk::Pixbuf> sioxProcessImage(Glib::RefPtr<Gdk::Pixbuf> pixbuf, Cairo::RefPtr<Cairo::ImageSurface> siox_mask, Async::Progress<double> &progress, int nthreads)
 {
     // Copy the pixbuf into the siox image.
     auto sioximage = SioxImage(pixbuf);
@@ -232,7 +234,7 @@ Glib::RefPtr<Gdk::Pixbuf> sioxProcessImage(Glib::RefPtr<Gdk::Pixbuf> pixbuf, Cai
     tmp.writePPM("/tmp/x1.ppm");*/
 
     // Process or retrieve from cache.
-    return SioxImageCache::get().process(sioximage, progress);
+    return SioxImageCache::get().process(sioximage, progress, nthreads);
 }
 
 } // namespace
@@ -300,6 +302,7 @@ private:
     std::shared_ptr<Inkscape::Pixbuf const> image_pixbuf;
     Geom::Affine image_transform;
     Cairo::RefPtr<Cairo::ImageSurface> siox_mask;
+    int siox_nthreads = 1;
     Async::Channel::Source channel;
 
     TraceResult traceresult;
@@ -365,6 +368,7 @@ TraceFuture TraceTask::launch(std::unique_ptr<TraceTask> self)
 
     if (sioxEnabled) {
         siox_mask = rasterizeItems(imageanditems->second, image_transform, dimensions(*image_pixbuf));
+        siox_nthreads = Preferences::get()->getIntLimited("/options/threading/numthreads", std::thread::hardware_concurrency(), 1, 256);
     }
 
     if (type == Type::Trace) msgStack->flash(Inkscape::NORMAL_MESSAGE, _("Trace: Starting trace..."));
@@ -408,7 +412,7 @@ void TraceTask::do_async_work(std::unique_ptr<TraceTask> self)
 
         // If SIOX has been enabled, run SIOX processing.
         if (sioxEnabled) {
-            gdkpixbuf = sioxProcessImage(gdkpixbuf, siox_mask, *sub_siox);
+            gdkpixbuf = sioxProcessImage(gdkpixbuf, siox_mask, *sub_siox, siox_nthreads);
             siox_mask.clear();
             sub_siox->report_or_throw(1.0);
         }
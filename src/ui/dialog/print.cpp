@@ -24,6 +24,7 @@
 #include "extension/internal/cairo-render-context.h"
 #include "extension/internal/cairo-renderer.h"
 #include "document.h"
+#include "object/sp-image.h"
 #include "object/sp-page.h"
 
 #include "util/units.h"
@@ -155,6 +156,10 @@ void Print::draw_page(const Glib::RefPtr<Gtk::PrintContext>& context, int page_n
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     //printf("%s %d\n",__FUNCTION__, page_nr);
 
+    // The page is rendered straight from the document, which must have all its images.
+    sp_image_finish_decoding(_workaround._doc);
+    _workaround._doc->ensureUpToDate();
+
     auto &pm = _workaround._doc->getPageManager();
     auto page = pm.getPage(page_nr); // nullptr when no pages.
 
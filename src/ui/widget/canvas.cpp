@@ -16,9 +16,11 @@
 
 #include <algorithm> // Sort
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <iostream> // Logging
 #include <mutex>
+#include <optional>
 #include <set> // Coarsener
 #include <stdexcept>
 #include <thread>
@@ -171,23 +173,34 @@ struct RedrawData
     bool debug_show_redraw;
 
     // State
-    std::mutex mutex;
-    gint64 start_time;
+    std::mutex mutex; // Guards the updater and moving on to the next redraw cycle.
+    std::atomic<gint64> start_time;
     int numactive;
-    int phase;
+    std::atomic<int> phase;
+    bool finished;
     Geom::OptIntRect vis_store;
 
+    // Describe the current redraw cycle. Only changed while no rectangles are outstanding.
     Geom::IntRect bounds;
     Cairo::RefPtr<Cairo::Region> clean;
     bool interruptible;
     bool preemptible;
-    std::vector<Geom::IntRect> rects;
     int effective_tile_size;
 
+    // Rectangles to paint, in one heap per render thread. Threads take from their own heap first,
+    // then steal from the others, so that they rarely wait for each other.
+    struct RectQueue
+    {
+        std::mutex mutex;
+        std::vector<Geom::IntRect> rects;
+    };
+    std::vector<RectQueue> queues;
+    std::atomic<int> outstanding = 0; // Rectangles in the queues or being split, not yet marked clean.
+
     // Results
     std::mutex tiles_mutex;
     std::vector<Tile> tiles;
-    bool timeoutflag;
+    std::atomic<bool> timeoutflag;
 
     // Return comparison object for sorting rectangles by distance from mouse point.
     auto getcmp() const
@@ -196,6 +209,17 @@ struct RedrawData
             return a.distanceSq(mouse_loc) > b.distanceSq(mouse_loc);
         };
     }
+
+    // Lock a mutex of the render threads. With framecheck on, the time spent waiting for it is logged.
+    auto lock(std::mutex &m, int subtype) const
+    {
+        auto lock = std::unique_lock(m, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            auto fc = debug_framecheck ? FrameCheck::Event("render_lock_wait", subtype) : FrameCheck::Event();
+            lock.lock();
+        }
+        return lock;
+    }
 };
 
 } // namespace
@@ -231,6 +255,8 @@ public:
     // Invalidation
     std::unique_ptr<Updater> updater; // Tracks the unclean region and decides how to redraw it.
     Cairo::RefPtr<Cairo::Region> invalidated; // Buffers invalidations while the updater is in use by the background process.
+    bool store_restored = false; // Whether the store was restored from the zoom cache since the last update.
+    bool zooming = false; // Set while the canvas items only follow a change of affine.
 
     // Graphics state; holds all the graphics resources, including the drawn content.
     std::unique_ptr<Graphics> graphics;
@@ -289,6 +315,7 @@ public:
     bool end_redraw(); // returns true to indicate further redraw cycles required
     void process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible = true, bool preemptible = true);
     void render_tile(int debug_id);
+    std::optional<Geom::IntRect> take_rect(int debug_id);
     void paint_rect(Geom::IntRect const &rect);
     void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass);
     void paint_error_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface);
@@ -612,10 +639,15 @@ void CanvasPrivate::launch_redraw()
     if (q->_need_update || affine_changed) {
         FrameCheck::Event fc;
         if (prefs.debug_framecheck) fc = FrameCheck::Event("update");
-        q->_need_update = false;
         canvasitem_ctx->setAffine(stores.store().affine);
+        // Items redraw their old and new areas when only the affine changes. This is no reason to
+        // drop the zoom cache, and a restored store already shows them as they are at this zoom.
+        zooming = !q->_need_update;
+        q->_need_update = false;
         canvasitem_ctx->root()->update(affine_changed);
+        zooming = false;
     }
+    store_restored = false;
 
     // Update strategy.
     auto const strategy = pref_to_updater(prefs.update_strategy);
@@ -734,6 +766,15 @@ void CanvasPrivate::handle_stores_action(Stores::Action action)
             if (prefs.debug_show_unclean) q->queue_draw();
             break;
 
+        case Stores::Action::Restored:
+            // Only what the cached store has not drawn needs redrawing.
+            updater->reset();
+            updater->clean_region = stores.store().drawn->copy();
+            store_restored = true;
+
+            if (prefs.debug_show_unclean) q->queue_draw();
+            break;
+
         case Stores::Action::Shifted:
             invalidated->intersect(geom_to_cairo(stores.store().rect));
             updater->intersect(stores.store().rect);
@@ -1555,7 +1596,13 @@ void Canvas::redraw_all()
         // We need to ignore their requests!
         return;
     }
+    if (d->zooming && d->store_restored) {
+        return;
+    }
     d->invalidated->do_union(geom_to_cairo(d->stores.store().rect));
+    if (!d->zooming) {
+        d->stores.mark_changed();
+    }
     d->schedule_redraw();
     if (d->prefs.debug_show_unclean) queue_draw();
 }
@@ -1581,7 +1628,7 @@ void Canvas::redraw_area(int x0, int y0, int x1, int y1)
     x1 = std::clamp(x1, min_coord, max_coord);
     y1 = std::clamp(y1, min_coord, max_coord);
 
-    if (x0 >= x1 || y0 >= y1) {
+    if (x0 >= x1 || y0 >= y1 || (d->zooming && d->store_restored)) {
         return;
     }
 
@@ -1592,6 +1639,9 @@ void Canvas::redraw_area(int x0, int y0, int x1, int y1)
 
     auto const rect = Geom::IntRect(x0, y0, x1, y1);
     d->invalidated->do_union(geom_to_cairo(rect));
+    if (!d->zooming) {
+        d->stores.mark_changed();
+    }
     d->schedule_redraw();
     if (d->prefs.debug_show_unclean) queue_draw();
 }
@@ -2085,7 +2135,11 @@ void CanvasPrivate::init_tiler()
     // Begin processing redraws.
     rd.start_time = g_get_monotonic_time();
     rd.phase = 0;
+    rd.finished = false;
     rd.vis_store = (rd.visible & rd.store.rect).regularized();
+    if (rd.queues.size() != (size_t)rd.numthreads) {
+        rd.queues = std::vector<RedrawData::RectQueue>(rd.numthreads);
+    }
 
     if (!init_redraw()) {
         sync.signalExit();
@@ -2106,7 +2160,7 @@ void CanvasPrivate::init_tiler()
 
 bool CanvasPrivate::init_redraw()
 {
-    assert(rd.rects.empty());
+    assert(rd.outstanding == 0);
 
     switch (rd.phase) {
         case 0:
@@ -2165,7 +2219,9 @@ bool CanvasPrivate::init_redraw()
 void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible, bool preemptible)
 {
     rd.bounds = bounds;
-    rd.clean = std::move(clean);
+    // Render threads read the clean region without a lock, so they mustn't share the updater's,
+    // which mark_clean() changes under their feet.
+    rd.clean = clean->copy();
     rd.interruptible = interruptible;
     rd.preemptible = preemptible;
 
@@ -2177,25 +2233,54 @@ void CanvasPrivate::process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Ca
     region->subtract(rd.clean);
 
     // Get the list of rectangles to paint, coarsened to avoid fragmentation.
-    rd.rects = coarsen(region,
-                       std::min<int>(rd.coarsener_min_size, rd.tile_size / 2),
-                       std::min<int>(rd.coarsener_glue_size, rd.tile_size / 2),
-                       rd.coarsener_min_fullness);
-
-    // Put the rectangles into a heap sorted by distance from mouse.
-    std::make_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
+    auto rects = coarsen(region,
+                         std::min<int>(rd.coarsener_min_size, rd.tile_size / 2),
+                         std::min<int>(rd.coarsener_glue_size, rd.tile_size / 2),
+                         rd.coarsener_min_fullness);
 
     // Adjust the effective tile size proportional to the painting area.
     double adjust = (double)cairo_to_geom(region->get_extents()).maxExtent() / rd.visible.maxExtent();
     adjust = std::clamp(adjust, 0.3, 1.0);
     rd.effective_tile_size = rd.tile_size * adjust;
+
+    // Deal the rectangles out to the render threads closest to the mouse first, so that every
+    // thread starts near the mouse, and put them into heaps sorted by distance from the mouse.
+    // This must come last, as other render threads may start taking them straight away.
+    auto const cmp = rd.getcmp();
+    std::sort(rects.begin(), rects.end(), [&] (auto const &a, auto const &b) { return cmp(b, a); });
+    rd.outstanding += (int)rects.size();
+    int const nqueues = rd.queues.size();
+    for (int i = 0; i < nqueues; i++) {
+        auto &queue = rd.queues[i];
+        auto lock = rd.lock(queue.mutex, 1);
+        for (int j = i; j < (int)rects.size(); j += nqueues) {
+            queue.rects.emplace_back(rects[j]);
+        }
+        std::make_heap(queue.rects.begin(), queue.rects.end(), cmp);
+    }
+}
+
+// Take the rectangle closest to the mouse from the queue of this render thread, or if it is
+// empty, from the queue of another one.
+std::optional<Geom::IntRect> CanvasPrivate::take_rect(int debug_id)
+{
+    int const nqueues = rd.queues.size();
+    for (int i = 0; i < nqueues; i++) {
+        auto &queue = rd.queues[(debug_id + i) % nqueues];
+        auto lock = rd.lock(queue.mutex, 1);
+        if (!queue.rects.empty()) {
+            std::pop_heap(queue.rects.begin(), queue.rects.end(), rd.getcmp());
+            auto rect = queue.rects.back();
+            queue.rects.pop_back();
+            return rect;
+        }
+    }
+    return {};
 }
 
 // Process rectangles until none left or timed out.
 void CanvasPrivate::render_tile(int debug_id)
 {
-    rd.mutex.lock();
-
     std::string fc_str;
     FrameCheck::Event fc;
     if (rd.debug_framecheck) {
@@ -2203,18 +2288,9 @@ void CanvasPrivate::render_tile(int debug_id)
         fc = FrameCheck::Event(fc_str.c_str());
     }
 
-    while (true) {
-        // If we've run out of rects, try to start a new redraw cycle.
-        if (rd.rects.empty()) {
-            if (end_redraw()) {
-                // More redraw cycles to do.
-                continue;
-            } else {
-                // All finished.
-                break;
-            }
-        }
+    auto &own_queue = rd.queues[debug_id];
 
+    while (true) {
         // Check for cancellation.
         auto const flags = abort_flags.load(std::memory_order_relaxed);
         bool const soft = flags & (int)AbortFlags::Soft;
@@ -2224,25 +2300,48 @@ void CanvasPrivate::render_tile(int debug_id)
         }
 
         // Extract the closest rectangle to the mouse.
-        std::pop_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
-        auto rect = rd.rects.back();
-        rd.rects.pop_back();
+        auto const taken = take_rect(debug_id);
+
+        // If we've run out of rects, try to start a new redraw cycle.
+        if (!taken) {
+            if (rd.outstanding > 0) {
+                // Another thread is about to queue the halves of the rectangle it is splitting.
+                std::this_thread::yield();
+                continue;
+            }
+            auto lock = rd.lock(rd.mutex, 0);
+            if (rd.finished) {
+                break;
+            }
+            if (rd.outstanding == 0 && !end_redraw()) {
+                // All finished.
+                rd.finished = true;
+                break;
+            }
+            // More redraw cycles to do.
+            continue;
+        }
+        auto rect = *taken;
 
         // Cull empty rectangles.
         if (rect.hasZeroArea()) {
+            rd.outstanding--;
             continue;
         }
 
         // Cull rectangles that lie entirely inside the clean region.
         // (These can be generated by coarsening; they must be discarded to avoid getting stuck re-rendering the same rectangles.)
         if (rd.clean->contains_rectangle(geom_to_cairo(rect)) == Cairo::REGION_OVERLAP_IN) {
+            rd.outstanding--;
             continue;
         }
 
-        // Lambda to add a rectangle to the heap.
+        // Lambda to add a rectangle to the heap of this thread.
         auto add_rect = [&] (Geom::IntRect const &rect) {
-            rd.rects.emplace_back(rect);
-            std::push_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
+            rd.outstanding++;
+            auto lock = rd.lock(own_queue.mutex, 1);
+            own_queue.rects.emplace_back(rect);
+            std::push_heap(own_queue.rects.begin(), own_queue.rects.end(), rd.getcmp());
         };
 
         // If the rectangle needs bisecting, bisect it and put it back on the heap.
@@ -2250,6 +2349,7 @@ void CanvasPrivate::render_tile(int debug_id)
             int mid = rect[*axis].middle();
             auto lo = rect; lo[*axis].setMax(mid); add_rect(lo);
             auto hi = rect; hi[*axis].setMin(mid); add_rect(hi);
+            rd.outstanding--;
             continue;
         }
 
@@ -2266,18 +2366,21 @@ void CanvasPrivate::render_tile(int debug_id)
             }
         }
 
-        // Mark the rectangle as clean.
-        updater->mark_clean(rect);
+        // Read this before the next redraw cycle can start and change it.
+        bool const interruptible = rd.interruptible;
 
-        rd.mutex.unlock();
+        // Mark the rectangle as clean.
+        {
+            auto lock = rd.lock(rd.mutex, 0);
+            updater->mark_clean(rect);
+        }
+        rd.outstanding--;
 
         // Paint the rectangle.
         paint_rect(rect);
 
-        rd.mutex.lock();
-
         // Check for timeout.
-        if (rd.interruptible) {
+        if (interruptible) {
             auto now = g_get_monotonic_time();
             auto elapsed = now - rd.start_time;
             if (elapsed > rd.render_time_limit * 1000) {
@@ -2292,13 +2395,16 @@ void CanvasPrivate::render_tile(int debug_id)
         fc.subtype = 1;
     }
 
+    auto lock = rd.lock(rd.mutex, 0);
     rd.numactive--;
     bool const done = rd.numactive == 0;
-
-    rd.mutex.unlock();
+    lock.unlock();
 
     if (done) {
-        rd.rects.clear();
+        for (auto &queue : rd.queues) {
+            queue.rects.clear();
+        }
+        rd.outstanding = 0;
         sync.signalExit();
     }
 }
@@ -146,6 +146,26 @@ void CairoGraphics::swap_stores()
     std::swap(store, snapshot);
 }
 
+void CairoGraphics::cache_snapshot(int slot)
+{
+    if ((size_t)slot >= cache.size()) {
+        cache.resize(slot + 1);
+    }
+    std::swap(snapshot, cache[slot]);
+}
+
+void CairoGraphics::restore_store(int slot)
+{
+    std::swap(store, cache[slot]);
+}
+
+void CairoGraphics::trim_cache(int size)
+{
+    if ((size_t)size < cache.size()) {
+        cache.resize(size);
+    }
+}
+
 void CairoGraphics::fast_snapshot_combine()
 {
     auto copy = [&, this] (Cairo::RefPtr<Cairo::ImageSurface> const &from,
@@ -36,6 +36,9 @@ public:
     void fast_snapshot_combine() override;
     void snapshot_combine(Fragment const &dest) override;
     void invalidate_snapshot() override {}
+    void cache_snapshot(int slot) override;
+    void restore_store(int slot) override;
+    void trim_cache(int size) override;
 
     bool is_opengl() const override { return false; }
     void invalidated_glstate() override {}
@@ -49,6 +52,7 @@ public:
 private:
     // Drawn content.
     CairoFragment store, snapshot;
+    std::vector<CairoFragment> cache; // Stores of earlier zoom levels.
 
     // Dependency objects in canvas.
     Prefs const &prefs;
@@ -572,6 +572,30 @@ void GLGraphics::invalidate_snapshot()
     if (snapshot.outline_texture) snapshot.outline_texture.invalidate();
 }
 
+void GLGraphics::cache_snapshot(int slot)
+{
+    if ((size_t)slot >= cache.size()) {
+        cache.resize(slot + 1);
+    }
+    std::swap(snapshot, cache[slot]);
+}
+
+void GLGraphics::restore_store(int slot)
+{
+    std::swap(store, cache[slot]);
+    // The framebuffer still has the old store textures attached.
+    state = State::None;
+}
+
+void GLGraphics::trim_cache(int size)
+{
+    // The stores are told about changes to the drawing when the context may not be current.
+    while (cache.size() > (size_t)size) {
+        cache_junk.push_back(std::move(cache.back()));
+        cache.pop_back();
+    }
+}
+
 void GLGraphics::setup_tiles_pipeline()
 {
     if (state == State::Tiles) return;
@@ -671,6 +695,8 @@ void GLGraphics::setup_widget_pipeline(Fragment const &view)
 
 void GLGraphics::paint_widget(Fragment const &view, PaintArgs const &a, Cairo::RefPtr<Cairo::Context> const&)
 {
+    cache_junk.clear();
+
     // If in decoupled mode, create the vertex data describing the drawn region of the store.
     VAO clean_vao;
     int clean_numrects;
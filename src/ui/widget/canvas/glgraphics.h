@@ -82,6 +82,9 @@ public:
     void fast_snapshot_combine() override;
     void snapshot_combine(Fragment const &dest) override;
     void invalidate_snapshot() override;
+    void cache_snapshot(int slot) override;
+    void restore_store(int slot) override;
+    void trim_cache(int size) override;
 
     bool is_opengl() const override { return true; }
     void invalidated_glstate() override { state = State::None; }
@@ -94,6 +97,8 @@ public:
 private:
     // Drawn content.
     GLFragment store, snapshot;
+    std::vector<GLFragment> cache; // Stores of earlier zoom levels.
+    std::vector<GLFragment> cache_junk; // Released from the cache, deleted with the context current.
 
     // OpenGL objects.
     VAO rect; // Rectangle vertex data.
@@ -57,6 +57,9 @@ public:
     virtual void fast_snapshot_combine() = 0; ///< Paste the store onto the snapshot.
     virtual void snapshot_combine(Fragment const &dest) = 0; ///< Paste the snapshot followed by the store onto a new snapshot at \a dest.
     virtual void invalidate_snapshot() = 0; ///< Indicate that the content in the snapshot store is not going to be used again.
+    virtual void cache_snapshot(int slot) = 0; ///< Exchange the snapshot with slot \a slot of the zoom cache, creating it if necessary.
+    virtual void restore_store(int slot) = 0; ///< Exchange the store with slot \a slot of the zoom cache.
+    virtual void trim_cache(int size) = 0; ///< Release the slots of the zoom cache from \a size on.
 
     // Misc.
     virtual bool is_opengl() const = 0; ///< Whether this is an OpenGL backend.
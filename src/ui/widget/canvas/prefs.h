@@ -43,6 +43,7 @@ public:
     Pref<int>    coarsener_min_size       = { "/options/rendering/coarsener_min_size", 200, 0, 1000 };
     Pref<int>    coarsener_glue_size      = { "/options/rendering/coarsener_glue_size", 80, 0, 1000 };
     Pref<double> coarsener_min_fullness   = { "/options/rendering/coarsener_min_fullness", 0.3, 0.0, 1.0 };
+    Pref<int>    zoom_cache_size          = { "/options/rendering/zoom_cache_size", 4, 0, 16 };
 
     // Debug switches
     Pref<bool>   debug_framecheck         = { "/options/rendering/debug_framecheck" };
@@ -72,6 +73,7 @@ private:
         coarsener_min_size.set_enabled(on);
         coarsener_glue_size.set_enabled(on);
         coarsener_min_fullness.set_enabled(on);
+        zoom_cache_size.set_enabled(on);
         debug_framecheck.set_enabled(on);
         debug_logging.set_enabled(on);
         debug_delay_redraw.set_enabled(on);
@@ -92,6 +92,12 @@ auto region_affine_approxinwards(Cairo::RefPtr<Cairo::Region> const &reg, Geom::
     return regdst;
 }
 
+// Determine whether two affines are the same zoom level, up to rounding errors.
+bool same_zoom(Geom::Affine const &a, Geom::Affine const &b)
+{
+    return Geom::are_near(a, b, 1e-6 * std::sqrt(std::abs(b.det())));
+}
+
 } // namespace
 
 Geom::IntRect Stores::centered(Fragment const &view) const
@@ -106,6 +112,7 @@ void Stores::recreate_store(Fragment const &view)
     _store.affine = view.affine;
     _store.rect = centered(view);
     _store.drawn = Cairo::Region::create();
+    _store_cacheable = true;
     // Tell the graphics to create a blank new store.
     _graphics->recreate_store(_store.rect.dimensions());
 }
@@ -122,20 +129,85 @@ void Stores::shift_store(Fragment const &view)
     _store.drawn->intersect(geom_to_cairo(_store.rect));
 };
 
-void Stores::take_snapshot(Fragment const &view)
+// Start a new store at the view's affine. If the zoom cache has a store at this affine which
+// covers the view, carry on from that instead of a blank store.
+// (It can't be shifted here, as shifting uses the snapshot surface, which is in use.)
+auto Stores::new_store(Fragment const &view) -> Action
+{
+    auto const wanted = expandedBy(view.rect, _prefs.prerender);
+    auto const found = std::find_if(_cache.begin(), _cache.end(), [&] (auto const &entry) {
+        return entry && same_zoom(entry->store.affine, view.affine) && entry->store.rect.contains(wanted);
+    });
+    if (found == _cache.end()) {
+        recreate_store(view);
+        return Action::Recreated;
+    }
+
+    // Swap the cached store in, handing its slot the surface of the store that was going to be reset.
+    _store = std::move((*found)->store);
+    _store.affine = view.affine;
+    _store_cacheable = true;
+    found->reset();
+    _graphics->restore_store(found - _cache.begin());
+    if (_prefs.debug_logging) std::cout << "Restore store from zoom cache" << std::endl;
+    return Action::Restored;
+}
+
+// Move the snapshot into the zoom cache if it is a whole zoom level that is still up to date,
+// rather than let it be overwritten.
+void Stores::cache_snapshot()
+{
+    auto level = std::move(_snapshot_level);
+    _snapshot_level.reset();
+
+    _cache.resize(_prefs.zoom_cache_size);
+    _graphics->trim_cache(_cache.size());
+    if (!level || _cache.empty() || level->drawn->empty()) {
+        return;
+    }
+
+    // Replace the entry for the same zoom level, an empty slot, or else the least recently used.
+    auto slot = std::find_if(_cache.begin(), _cache.end(), [&] (auto const &entry) {
+        return entry && same_zoom(entry->store.affine, level->affine);
+    });
+    if (slot == _cache.end()) {
+        slot = std::find(_cache.begin(), _cache.end(), std::nullopt);
+    }
+    if (slot == _cache.end()) {
+        slot = std::min_element(_cache.begin(), _cache.end(), [] (auto const &a, auto const &b) {
+            return a->last_used < b->last_used;
+        });
+    }
+
+    _graphics->cache_snapshot(slot - _cache.begin());
+    *slot = CachedStore{ std::move(*level), ++_cache_clock };
+    if (_prefs.debug_logging) std::cout << "Keep snapshot in zoom cache" << std::endl;
+}
+
+auto Stores::take_snapshot(Fragment const &view) -> Action
 {
+    // Keep the old snapshot in the zoom cache if possible, instead of re-using it for the store.
+    cache_snapshot();
     // Copy the store to the snapshot, leaving us temporarily in an invalid state.
     _snapshot = std::move(_store);
     // Tell the graphics to do the same, except swapping them so we can re-use the old snapshot store.
     _graphics->swap_stores();
+    // Remember the snapshot as it is, for the zoom cache.
+    if (_store_cacheable) {
+        _snapshot_level = Store{ { _snapshot.affine, _snapshot.rect }, _snapshot.drawn->copy() };
+    }
     // Reset the store.
-    recreate_store(view);
+    auto const action = new_store(view);
     // Transform the snapshot's drawn region to the new store's affine.
     _snapshot.drawn = shrink_region(region_affine_approxinwards(_snapshot.drawn, _snapshot.affine.inverse() * _store.affine, _store.rect), 4, -2);
+    return action;
 }
 
-void Stores::snapshot_combine(Fragment const &view)
+auto Stores::snapshot_combine(Fragment const &view) -> Action
 {
+    // The snapshot will be drawn over, so it can't go into the zoom cache any more.
+    _snapshot_level.reset();
+
     // Add the drawn region to the snapshot drawn region (they both exist in store space, so this is valid), and save its affine.
     _snapshot.drawn->do_union(_store.drawn);
     auto old_store_affine = _store.affine;
@@ -240,10 +312,11 @@ void Stores::snapshot_combine(Fragment const &view)
     }
 
     // Start drawing again on a new blank store aligned to the screen.
-    recreate_store(view);
+    auto const action = new_store(view);
     // Transform the snapshot clean region to the new store.
     // Todo: Should really clip this to the new snapshot rect, only we can't because it's generally not aligned with the store's affine.
     _snapshot.drawn = shrink_region(region_affine_approxinwards(_snapshot.drawn, old_store_affine.inverse() * _store.affine, _store.rect), 4, -2);
+    return action;
 };
 
 void Stores::reset()
@@ -251,6 +324,17 @@ void Stores::reset()
     _mode = Mode::None;
     _store.drawn.clear();
     _snapshot.drawn.clear();
+    _cache.clear();
+    _graphics->trim_cache(0);
+    _snapshot_level.reset();
+}
+
+void Stores::mark_changed()
+{
+    _cache.clear();
+    _graphics->trim_cache(0);
+    _snapshot_level.reset();
+    _store_cacheable = false;
 }
 
 // Handle transitions and actions in response to viewport changes.
@@ -271,11 +355,10 @@ auto Stores::update(Fragment const &view) -> Action
             // Enter decoupled mode if the affine has changed from what the store was drawn at.
             if (view.affine != _store.affine) {
                 // Snapshot and reset the store.
-                take_snapshot(view);
+                result = take_snapshot(view);
                 // Enter decoupled mode.
                 _mode = Mode::Decoupled;
                 if (_prefs.debug_logging) std::cout << "Enter decoupled mode" << std::endl;
-                result = Action::Recreated;
             } else {
                 // Determine whether the view has moved sufficiently far that we need to shift the store.
                 if (!_store.rect.contains(expandedBy(view.rect, _prefs.prerender))) {
@@ -329,8 +412,7 @@ auto Stores::update(Fragment const &view) -> Action
 
             if (check_restart_redraw()) {
                 // Re-use as much content as possible from the store and the snapshot, and set as the new snapshot.
-                snapshot_combine(view);
-                return Action::Recreated;
+                return snapshot_combine(view);
             }
 
             return Action::None;
@@ -354,13 +436,14 @@ auto Stores::finished_draw(Fragment const &view) -> Action
             if (_prefs.debug_logging) std::cout << "Exit decoupled mode" << std::endl;
             // Exit decoupled mode.
             _mode = Mode::Normal;
+            cache_snapshot();
             _graphics->invalidate_snapshot();
         } else {
             // Content is rendered at the wrong affine - take a new snapshot and continue idle process to continue rendering at the new affine.
             // Snapshot and reset the backing store.
-            take_snapshot(view);
+            auto const action = take_snapshot(view);
             if (_prefs.debug_logging) std::cout << "Remain in decoupled mode" << std::endl;
-            return Action::Recreated;
+            return action;
         }
     }
 
@@ -10,6 +10,9 @@
 #ifndef INKSCAPE_UI_WIDGET_CANVAS_STORES_H
 #define INKSCAPE_UI_WIDGET_CANVAS_STORES_H
 
+#include <optional>
+#include <vector>
+
 #include "fragment.h"
 #include "util.h"
 #include "ui/util.h"
@@ -34,7 +37,8 @@ public:
     {
         None,      /// The backing store was not changed.
         Recreated, /// The backing store was completely recreated.
-        Shifted    /// The backing store was shifted into a new rectangle.
+        Shifted,   /// The backing store was shifted into a new rectangle.
+        Restored   /// The backing store was taken from the zoom cache, and its drawn region is still up to date.
     };
     
     struct Store : Fragment
@@ -67,6 +71,9 @@ public:
     /// Record a rectangle as being drawn to the store.
     void mark_drawn(Geom::IntRect const &rect) { _store.drawn->do_union(geom_to_cairo(rect)); }
 
+    /// Record that drawn content has gone out of date, so none of it may be kept in the zoom cache.
+    void mark_changed();
+
     // Getters.
     Store const &store() const { return _store; }
     Store const &snapshot() const { return _snapshot; }
@@ -77,6 +84,18 @@ private:
     Mode _mode;
     Store _store, _snapshot;
 
+    // The zoom cache, holding the stores of recently left zoom levels so that going back to them
+    // is instant. The slots match those of the graphics.
+    struct CachedStore
+    {
+        Store store;
+        unsigned last_used;
+    };
+    std::vector<std::optional<CachedStore>> _cache;
+    unsigned _cache_clock = 0;
+    bool _store_cacheable = false; // Whether everything drawn to the store is up to date.
+    std::optional<Store> _snapshot_level; // The snapshot in its own space, if it is a cacheable store.
+
     // The graphics object that executes the operations on the stores.
     Graphics *_graphics;
 
@@ -87,8 +106,10 @@ private:
     Geom::IntRect centered(Fragment const &view) const;
     void recreate_store(Fragment const &view);
     void shift_store(Fragment const &view);
-    void take_snapshot(Fragment const &view);
-    void snapshot_combine(Fragment const &view);
+    Action new_store(Fragment const &view);
+    void cache_snapshot();
+    Action take_snapshot(Fragment const &view);
+    Action snapshot_combine(Fragment const &view);
 };
 
 } // namespace Inkscape::UI::Widget
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Compile-time perfect hash over a fixed set of string keys.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#ifndef INKSCAPE_UTIL_PERFECT_HASH_H
+#define INKSCAPE_UTIL_PERFECT_HASH_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Inkscape::Util {
+
+/**
+ * A PerfectHash<N> maps each of N distinct string keys, known at compile time, to its index in
+ * the key array, using a single hash of the input and a single string comparison.
+ *
+ * It is built by the "hash, displace" method: keys are first distributed into buckets by a
+ * primary hash; then, largest buckets first, a per-bucket seed is searched for that sends all
+ * keys in the bucket to distinct free slots. Lookup of a key not in the set costs the same as a
+ * successful lookup, and returns -1.
+ *
+ * Construction is constexpr, so a table declared as
+ *
+ *     static constexpr auto table = PerfectHash<N>(keys);
+ *
+ * is computed entirely by the compiler.
+ */
+template <std::size_t N>
+class PerfectHash
+{
+public:
+    /// Number of slots. Kept at a load factor of about 1/2 so that the seed search is short.
+    static constexpr std::size_t slot_count = std::bit_ceil(2 * N);
+    /// Number of buckets, averaging about four keys each.
+    static constexpr std::size_t bucket_count = std::max<std::size_t>(1, std::bit_ceil(N / 4));
+
+    constexpr explicit PerfectHash(std::array<std::string_view, N> const &keys)
+        : _keys(keys)
+    {
+        std::array<std::uint64_t, N> hashes{};
+        std::array<std::size_t, bucket_count> sizes{};
+        for (std::size_t i = 0; i < N; i++) {
+            hashes[i] = _hash(keys[i]);
+            sizes[hashes[i] % bucket_count]++;
+        }
+
+        std::array<std::size_t, bucket_count> order{};
+        for (std::size_t b = 0; b < bucket_count; b++) {
+            order[b] = b;
+        }
+        std::sort(order.begin(), order.end(), [&] (std::size_t a, std::size_t b) {
+            return sizes[a] > sizes[b];
+        });
+
+        _slots.fill(-1);
+        std::array<std::size_t, N> members{};
+        std::array<std::size_t, N> taken{};
+
+        for (auto const b : order) {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < N; i++) {
+                if (hashes[i] % bucket_count == b) {
+                    members[count++] = i;
+                }
+            }
+            if (count == 0) {
+                break; // Buckets are sorted by size, so the rest are empty too.
+            }
+
+            for (std::uint32_t seed = 1; ; seed++) {
+                bool ok = true;
+                for (std::size_t j = 0; j < count && ok; j++) {
+                    auto const slot = _slot(hashes[members[j]], seed);
+                    ok = _slots[slot] == -1 && std::find(taken.begin(), taken.begin() + j, slot) == taken.begin() + j;
+                    taken[j] = slot;
+                }
+                if (ok) {
+                    _seeds[b] = seed;
+                    for (std::size_t j = 0; j < count; j++) {
+                        _slots[taken[j]] = static_cast<int>(members[j]);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    /// Return the index of @a key in the key array, or -1 if it is not one of the keys.
+    constexpr int find(std::string_view key) const
+    {
+        auto const h = _hash(key);
+        int const index = _slots[_slot(h, _seeds[h % bucket_count])];
+        return index >= 0 && _keys[index] == key ? index : -1;
+    }
+
+private:
+    std::array<std::string_view, N> _keys;
+    std::array<std::uint32_t, bucket_count> _seeds{};
+    std::array<int, slot_count> _slots{};
+
+    /// FNV-1a.
+    static constexpr std::uint64_t _hash(std::string_view s)
+    {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        for (char c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    /// Secondary hash of a key's primary hash and its bucket's seed (splitmix64 finaliser).
+    static constexpr std::size_t _slot(std::uint64_t h, std::uint32_t seed)
+    {
+        h ^= seed * 0x9e3779b97f4a7c15ull;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        h ^= h >> 31;
+        return h % slot_count;
+    }
+};
+
+} // namespace Inkscape::Util
+
+#endif // INKSCAPE_UTIL_PERFECT_HASH_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim:filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99:
@@ -17,6 +17,8 @@
 
 #include "display/cairo-utils.h"
 #include "display/drawing-context.h"
+#include "document.h"
+#include "object/sp-image.h"
 
 namespace Inkscape {
 namespace UI {
@@ -66,6 +68,10 @@ render_preview(SPDocument *doc, std::shared_ptr<Inkscape::Drawing> drawing, uint
         cr->fill();
     }
 
+    // The preview is taken straight away, so it can't wait for images still being decoded.
+    sp_image_finish_decoding(doc);
+    doc->ensureUpToDate();
+
     // Resize the contents to the available space with a scale factor.
     drawing->root()->setTransform(Geom::Scale(sf));
     drawing->update();
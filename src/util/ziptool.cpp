@@ -38,6 +38,12 @@
  */
 
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstdarg>
 #include <ctime>
@@ -45,6 +51,8 @@
 #include <string>
 #include <utility>
 
+#include <zlib.h>
+
 #include "ziptool.h"
 
 
@@ -180,11 +188,21 @@ void Crc32::update(char *str)
 
 void Crc32::update(const std::vector<unsigned char> &buf)
 {
-    std::vector<unsigned char>::const_iterator iter;
-    for (iter=buf.begin() ; iter!=buf.end() ; ++iter)
+    update(buf.data(), buf.size());
+}
+
+/**
+ * Update with a whole block at once, which zlib does much faster
+ * than going through the bytes one by one.
+ */
+void Crc32::update(const unsigned char *buf, size_t size)
+{
+    while (size > 0)
         {
-        unsigned char ch = *iter;
-        update(ch);
+        uInt len = (uInt)std::min<size_t>(size, UINT_MAX);
+        value = ::crc32(value & 0xffffffffL, buf, len);
+        buf  += len;
+        size -= len;
         }
 }
 
@@ -1410,7 +1428,7 @@ bool Deflater::compress()
             window.push_back(*iter);
             ++iter;
             }
-        if (window.size() >= 32768)
+        if (iter != uncompressed.end())
             putBits(0x00, 1); //0  -- more blocks
         else
             putBits(0x01, 1); //1  -- last block
@@ -1426,6 +1444,129 @@ bool Deflater::compress()
 
 
 
+//########################################################################
+//#  Z L I B
+//########################################################################
+
+#ifdef WITH_INTERNAL_DEFLATE
+static DeflateBackend deflateBackend = DeflateBackend::Internal;
+#else
+static DeflateBackend deflateBackend = DeflateBackend::Zlib;
+#endif
+
+void setDeflateBackend(DeflateBackend backend)
+{
+    deflateBackend = backend;
+}
+
+DeflateBackend getDeflateBackend()
+{
+    return deflateBackend;
+}
+
+/**
+ * Raw deflate (no zlib or gzip wrapper) of a whole buffer with zlib.
+ */
+static bool zlibDeflate(std::vector<unsigned char> &dest,
+                        const unsigned char *src, size_t size)
+{
+    z_stream strm = {};
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    dest.resize(size < UINT_MAX ? deflateBound(&strm, size) : size + size / 1000 + 64);
+    size_t outPos = 0;
+    int ret = Z_OK;
+    while (ret == Z_OK)
+        {
+        if (outPos == dest.size())
+            dest.resize(dest.size() * 2);
+        uInt inLen  = (uInt)std::min<size_t>(size, UINT_MAX);
+        uInt outLen = (uInt)std::min<size_t>(dest.size() - outPos, UINT_MAX);
+        strm.next_in   = const_cast<unsigned char *>(src);
+        strm.avail_in  = inLen;
+        strm.next_out  = dest.data() + outPos;
+        strm.avail_out = outLen;
+        ret = deflate(&strm, size == inLen ? Z_FINISH : Z_NO_FLUSH);
+        src    += inLen - strm.avail_in;
+        size   -= inLen - strm.avail_in;
+        outPos += outLen - strm.avail_out;
+        if (ret == Z_BUF_ERROR)
+            ret = Z_OK; // no progress possible, more output space needed
+        }
+    deflateEnd(&strm);
+    dest.resize(outPos);
+    return ret == Z_STREAM_END;
+}
+
+/**
+ * Raw inflate of a whole buffer with zlib.  sizeHint is the expected
+ * uncompressed size, if known, so that the output is allocated only once.
+ */
+static bool zlibInflate(std::vector<unsigned char> &dest,
+                        const unsigned char *src, size_t size,
+                        size_t sizeHint)
+{
+    z_stream strm = {};
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+        return false;
+
+    // The hint comes from the file, so don't trust it beyond deflate's maximum ratio of 1032:1.
+    sizeHint = std::min<size_t>(sizeHint, size * 1032);
+    dest.resize(std::max<size_t>(sizeHint, 1024));
+    size_t outPos = 0;
+    int ret = Z_OK;
+    while (ret == Z_OK)
+        {
+        if (outPos == dest.size())
+            dest.resize(dest.size() * 2);
+        uInt inLen  = (uInt)std::min<size_t>(size, UINT_MAX);
+        uInt outLen = (uInt)std::min<size_t>(dest.size() - outPos, UINT_MAX);
+        strm.next_in   = const_cast<unsigned char *>(src);
+        strm.avail_in  = inLen;
+        strm.next_out  = dest.data() + outPos;
+        strm.avail_out = outLen;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        src    += inLen - strm.avail_in;
+        size   -= inLen - strm.avail_in;
+        outPos += outLen - strm.avail_out;
+        if (ret == Z_BUF_ERROR && strm.avail_out == 0)
+            ret = Z_OK; // more output space needed
+        }
+    inflateEnd(&strm);
+    dest.resize(outPos);
+    return ret == Z_STREAM_END;
+}
+
+/**
+ * Raw deflate of a buffer, with the selected backend.
+ */
+static bool deflateData(std::vector<unsigned char> &dest,
+                        const std::vector<unsigned char> &src)
+{
+    if (deflateBackend == DeflateBackend::Zlib)
+        return zlibDeflate(dest, src.data(), src.size());
+    Deflater deflater;
+    return deflater.deflate(dest, src);
+}
+
+/**
+ * Raw inflate of a buffer, with the selected backend.
+ */
+static bool inflateData(std::vector<unsigned char> &dest,
+                        const unsigned char *src, size_t size,
+                        size_t sizeHint = 0)
+{
+    if (deflateBackend == DeflateBackend::Zlib)
+        return zlibInflate(dest, src, size, sizeHint);
+    std::vector<unsigned char> source(src, src + size);
+    Inflater inflater;
+    return inflater.inflate(dest, source);
+}
+
+
+
 //########################################################################
 //#  G Z I P    F I L E
 //########################################################################
@@ -1539,13 +1680,10 @@ bool GzipFile::loadFile(const std::string &fName)
         error("Cannot open file %s", fName.c_str());
         return false;
         }
-    while (true)
-        {
-        int ch = fgetc(f);
-        if (ch < 0)
-            break;
-        data.push_back(ch);
-        }
+    unsigned char buf[65536];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + len);
     fclose(f);
     setFileName(fName);
     return true;
@@ -1610,18 +1748,11 @@ bool GzipFile::write()
 
     //compress
     std::vector<unsigned char> compBuf;
-    Deflater deflater;
-    if (!deflater.deflate(compBuf, data))
+    if (!deflateData(compBuf, data))
         {
         return false;
         }
-
-    std::vector<unsigned char>::iterator iter;
-    for (iter=compBuf.begin() ; iter!=compBuf.end() ; ++iter)
-        {
-        unsigned char ch = *iter;
-        putByte(ch);
-        }
+    fileBuf.insert(fileBuf.end(), compBuf.begin(), compBuf.end());
 
     Crc32 crcEngine;
     crcEngine.update(data);
@@ -1657,14 +1788,10 @@ bool GzipFile::writeFile(const std::string &fileName)
     FILE *f = fopen(fileName.c_str(), "wb");
     if (!f)
         return false;
-    std::vector<unsigned char>::iterator iter;
-    for (iter=fileBuf.begin() ; iter!=fileBuf.end() ; ++iter)
-        {
-        unsigned char ch = *iter;
-        fputc(ch, f);
-        }
-    fclose(f);
-    return true;
+    bool ok = fwrite(fileBuf.data(), 1, fileBuf.size(), f) == fileBuf.size();
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
 }
 
 
@@ -1808,20 +1935,19 @@ bool GzipFile::read()
 
     //read remainder of stream
     //compressed data runs up until 8 bytes before end of buffer
-    std::vector<unsigned char> compBuf;
-    while (fileBufPos < fileBuf.size() - 8)
+    if (fileBuf.size() < fileBufPos + 8)
         {
-        if (!getByte(&ch))
-            return false;
-        compBuf.push_back(ch);
+        error("unexpected end of data");
+        return false;
         }
+    unsigned long compSize = fileBuf.size() - 8 - fileBufPos;
     //uncompress
     data.clear();
-    Inflater inflater;
-    if (!inflater.inflate(data, compBuf))
+    if (!inflateData(data, fileBuf.data() + fileBufPos, compSize))
         {
         return false;
         }
+    fileBufPos += compSize;
 
     //Get the CRC and compare
     Crc32 crcEngine;
@@ -1874,13 +2000,10 @@ bool GzipFile::readFile(const std::string &fileName)
     FILE *f = fopen(fileName.c_str(), "rb");
     if (!f)
         return false;
-    while (true)
-        {
-        int ch = fgetc(f);
-        if (ch < 0)
-            break;
-        fileBuf.push_back(ch);
-        }
+    unsigned char buf[65536];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        fileBuf.insert(fileBuf.end(), buf, buf + len);
     fclose(f);
     if (!read())
         return false;
@@ -2032,9 +2155,7 @@ void ZipEntry::setUncompressedData(const std::vector<unsigned char> &val)
 
 void ZipEntry::setUncompressedData(const std::string &s)
 {
-    uncompressedData.clear();
-    uncompressedData.reserve(s.size());
-    uncompressedData.insert(uncompressedData.begin(), s.begin(), s.end());
+    uncompressedData.assign(s.begin(), s.end());
 }
 
 /**
@@ -2067,30 +2188,18 @@ void ZipEntry::write(unsigned char ch)
 void ZipEntry::finish()
 {
     Crc32 c32;
-    std::vector<unsigned char>::iterator iter;
-    for (iter = uncompressedData.begin() ;
-           iter!= uncompressedData.end() ; ++iter)
-        {
-        unsigned char ch = *iter;
-        c32.update(ch);
-        }
+    c32.update(uncompressedData);
     crc = c32.getValue();
     switch (compressionMethod)
         {
         case 0: //none
             {
-            for (iter = uncompressedData.begin() ;
-               iter!= uncompressedData.end() ; ++iter)
-                {
-                unsigned char ch = *iter;
-                compressedData.push_back(ch);
-                }
+            compressedData = uncompressedData;
             break;
             }
         case 8: //deflate
             {
-            Deflater deflater;
-            if (!deflater.deflate(compressedData, uncompressedData))
+            if (!deflateData(compressedData, uncompressedData))
                 {
                 //some error
                 }
@@ -2122,13 +2231,10 @@ bool ZipEntry::readFile(const std::string &fileNameArg,
         {
         return false;
         }
-    while (true)
-        {
-        int ch = fgetc(f);
-        if (ch < 0)
-            break;
-        uncompressedData.push_back((unsigned char)ch);
-        }
+    unsigned char buf[65536];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        uncompressedData.insert(uncompressedData.end(), buf, buf + len);
     fclose(f);
     finish();
     return true;
@@ -2164,6 +2270,8 @@ ZipFile::ZipFile() :
     entries(),
     fileBuf(),
     fileBufPos(0),
+    outFile(nullptr),
+    outFlushed(0),
     comment()
 {
 }
@@ -2311,7 +2419,7 @@ bool ZipFile::writeFileData()
     for (iter = entries.begin() ; iter != entries.end() ; ++iter)
         {
         ZipEntry *entry = *iter;
-        entry->setPosition(fileBuf.size());
+        entry->setPosition(getOutputPosition());
         //##### HEADER
         std::string fname = entry->getFileName();
         putLong(0x04034b50L);
@@ -2337,12 +2445,17 @@ bool ZipFile::writeFileData()
 
         //##### DATA
         std::vector<unsigned char> &buf = entry->getCompressedData();
-        std::vector<unsigned char>::iterator iter;
-        for (iter = buf.begin() ; iter != buf.end() ; ++iter)
+        if (outFile)
             {
-            unsigned char ch = (unsigned char) *iter;
-            putByte(ch);
+            //write it straight out rather than copying it into the archive buffer
+            if (!flushOutput())
+                return false;
+            if (fwrite(buf.data(), 1, buf.size(), outFile) != buf.size())
+                return false;
+            outFlushed += buf.size();
             }
+        else
+            fileBuf.insert(fileBuf.end(), buf.begin(), buf.end());
         }
     return true;
 }
@@ -2352,7 +2465,7 @@ bool ZipFile::writeFileData()
  */
 bool ZipFile::writeCentralDirectory()
 {
-    unsigned long cdPosition = fileBuf.size();
+    unsigned long cdPosition = getOutputPosition();
     std::vector<ZipEntry *>::iterator iter;
     for (iter = entries.begin() ; iter != entries.end() ; ++iter)
         {
@@ -2387,7 +2500,7 @@ bool ZipFile::writeCentralDirectory()
         for (char i : ecomment)
             putByte((unsigned char)i);
         }
-    unsigned long cdSize = fileBuf.size() - cdPosition;
+    unsigned long cdSize = getOutputPosition() - cdPosition;
 
     putLong(0x06054b50L);
     putInt(0);//number of this disk
@@ -2410,6 +2523,7 @@ bool ZipFile::writeCentralDirectory()
 bool ZipFile::write()
 {
     fileBuf.clear();
+    outFlushed = 0;
     if (!writeFileData())
         return false;
     if (!writeCentralDirectory())
@@ -2436,18 +2550,38 @@ bool ZipFile::writeBuffer(std::vector<unsigned char> &outBuf)
  */
 bool ZipFile::writeFile(const std::string &fileName)
 {
-    if (!write())
+    outFile = fopen(fileName.c_str(), "wb");
+    if (!outFile)
         return false;
-    FILE *f = fopen(fileName.c_str(), "wb");
-    if (!f)
+    //the entries go to the file one by one, the archive is never
+    //assembled in memory
+    bool ok = write() && flushOutput();
+    if (fclose(outFile) != 0)
+        ok = false;
+    outFile = nullptr;
+    outFlushed = 0;
+    return ok;
+}
+
+/**
+ * Current offset in the archive being written.
+ */
+unsigned long ZipFile::getOutputPosition()
+{
+    return outFlushed + fileBuf.size();
+}
+
+/**
+ * When writing to a file, write out what is in the buffer.
+ */
+bool ZipFile::flushOutput()
+{
+    if (!outFile || fileBuf.empty())
+        return true;
+    if (fwrite(fileBuf.data(), 1, fileBuf.size(), outFile) != fileBuf.size())
         return false;
-    std::vector<unsigned char>::iterator iter;
-    for (iter=fileBuf.begin() ; iter!=fileBuf.end() ; ++iter)
-        {
-        unsigned char ch = *iter;
-        fputc(ch, f);
-        }
-    fclose(f);
+    outFlushed += fileBuf.size();
+    fileBuf.clear();
     return true;
 }
 
@@ -2639,23 +2773,17 @@ bool ZipFile::readFileData()
             }
         else
             {
-            for (unsigned long bnr = 0 ; bnr < compressedSize ; bnr++)
+            unsigned long available = fileBuf.size() - fileBufPos;
+            if (compressedSize > available)
                 {
-                unsigned char ch;
-                if (!getByte(&ch))
-                    {
-                    error("premature end of data");
-                    break;
-                    }
-                compBuf.push_back(ch);
+                error("premature end of data");
+                compressedSize = available;
                 }
+            compBuf.assign(fileBuf.begin() + fileBufPos,
+                           fileBuf.begin() + fileBufPos + compressedSize);
+            fileBufPos += compressedSize;
             }
 
-        printf("### data: ");
-        for (int i=0 ; i<10 ; i++)
-            printf("%02x ", compBuf[i] & 0xff);
-        printf("\n");
-
         if (gpBitFlag & 0x8)//only if bit 3 set
             {
             /* this cookie was read in the loop above
@@ -2694,8 +2822,8 @@ bool ZipFile::readFileData()
             {
             case 8: //deflate
                 {
-                Inflater inflater;
-                if (!inflater.inflate(uncompBuf, compBuf))
+                if (!inflateData(uncompBuf, compBuf.data(), compBuf.size(),
+                                 uncompressedSize))
                     {
                     return false;
                     }
@@ -3015,13 +3143,10 @@ bool ZipFile::readFile(const std::string &fileName)
     FILE *f = fopen(fileName.c_str(), "rb");
     if (!f)
         return false;
-    while (true)
-        {
-        int ch = fgetc(f);
-        if (ch < 0)
-            break;
-        fileBuf.push_back(ch);
-        }
+    unsigned char buf[65536];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        fileBuf.insert(fileBuf.end(), buf, buf + len);
     fclose(f);
     if (!read())
         return false;
@@ -41,6 +41,8 @@
 
 
 
+#include <cstddef>
+#include <cstdio>
 #include <vector>
 #include <string>
 
@@ -92,6 +94,8 @@ public:
 
     void update(const std::vector<unsigned char> &buf);
 
+    void update(const unsigned char *buf, size_t size);
+
     unsigned long getValue();
 
 private:
@@ -105,6 +109,28 @@ private:
 
 
 
+//########################################################################
+//#  D E F L A T E    B A C K E N D
+//########################################################################
+
+/**
+ * The deflate code used by GzipFile and ZipFile.  Zlib is the default;
+ * building with WITH_INTERNAL_DEFLATE selects the original code in
+ * ziptool.cpp, which is much slower.  Both produce standard deflate
+ * streams, so either can read what the other wrote.
+ */
+enum class DeflateBackend
+{
+    Internal,
+    Zlib
+};
+
+void setDeflateBackend(DeflateBackend backend);
+
+DeflateBackend getDeflateBackend();
+
+
+
 //########################################################################
 //#  G Z I P    S T R E A M S
 //########################################################################
@@ -552,12 +578,25 @@ private:
      */
     bool readCentralDirectory();
 
+    /**
+     *
+     */
+    unsigned long getOutputPosition();
+
+    /**
+     *
+     */
+    bool flushOutput();
+
 
     std::vector<ZipEntry *> entries;
 
     std::vector<unsigned char> fileBuf;
     unsigned long fileBufPos;
 
+    FILE *outFile;             //set while writeFile() streams to a file
+    unsigned long outFlushed;  //bytes already written to outFile
+
     std::string comment;
 };
 
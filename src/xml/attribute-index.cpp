@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Hash index over the attribute list of an XML node
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "xml/attribute-index.h"
+
+#include <bit>
+
+#include "inkgc/gc-core.h"
+#include "xml/attribute-record.h"
+
+namespace Inkscape {
+namespace XML {
+
+namespace {
+
+/// Fibonacci hashing; quarks are small consecutive integers.
+inline unsigned slot_for(GQuark key, unsigned mask)
+{
+    return (key * 2654435761u) & mask;
+}
+
+}
+
+int AttributeIndex::find(AttributeVector const &attributes, GQuark key)
+{
+    if (attributes.size() < MIN_SIZE) {
+        for (std::size_t i = 0; i < attributes.size(); i++) {
+            if (attributes[i].key == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    if (_size != attributes.size()) {
+        _rebuild(attributes);
+    }
+
+    for (unsigned i = slot_for(key, _mask); _slots[i].key; i = (i + 1) & _mask) {
+        if (_slots[i].key == key) {
+            return _slots[i].position;
+        }
+    }
+    return -1;
+}
+
+void AttributeIndex::appended(AttributeVector const &attributes)
+{
+    if (!_size || _size + 1 != attributes.size()) {
+        return; // Not built, or out of date anyway; find() will rebuild.
+    }
+    if (2 * attributes.size() > _mask + 1) {
+        _rebuild(attributes);
+        return;
+    }
+    _insert(attributes.back().key, _size);
+    _size++;
+}
+
+void AttributeIndex::_rebuild(AttributeVector const &attributes)
+{
+    // Keep the load factor at or below 1/2, with room to append.
+    unsigned const capacity = std::bit_ceil(4 * static_cast<unsigned>(attributes.size()));
+    if (capacity != _mask + 1 || !_slots) {
+        _slots = new (Inkscape::GC::ATOMIC) Slot[capacity];
+        _mask = capacity - 1;
+    }
+    for (unsigned i = 0; i <= _mask; i++) {
+        _slots[i] = {0, 0};
+    }
+    for (unsigned i = 0; i < attributes.size(); i++) {
+        _insert(attributes[i].key, i);
+    }
+    _size = attributes.size();
+}
+
+void AttributeIndex::_insert(GQuark key, unsigned position)
+{
+    unsigned i = slot_for(key, _mask);
+    while (_slots[i].key) {
+        i = (i + 1) & _mask;
+    }
+    _slots[i] = {key, position};
+}
+
+}
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
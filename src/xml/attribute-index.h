@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Hash index over the attribute list of an XML node
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_ATTRIBUTE_INDEX_H
+#define SEEN_INKSCAPE_XML_ATTRIBUTE_INDEX_H
+
+#include <cstddef>
+#include <glib.h>
+
+#include "xml/node.h"
+
+namespace Inkscape {
+namespace XML {
+
+/**
+ * @brief Quark to position map for nodes carrying many attributes
+ *
+ * Most elements have a handful of attributes, which are found fastest by scanning the list.
+ * Elements such as sodipodi:namedview, or elements with many inkscape:* or data-* attributes,
+ * get an open-addressed hash table instead. It is built lazily on the first lookup and kept up
+ * to date on append; any other change to the list invalidates it.
+ *
+ * The table lives in atomic collected memory, since nodes are never destroyed explicitly.
+ */
+class AttributeIndex {
+public:
+    /// Lists shorter than this are scanned linearly.
+    static constexpr std::size_t MIN_SIZE = 16;
+
+    /// Return the position of @a key in @a attributes, or -1 if it is not there.
+    int find(AttributeVector const &attributes, GQuark key);
+
+    /// Record that a record was just appended to @a attributes.
+    void appended(AttributeVector const &attributes);
+
+    /// Record that positions in the list have changed.
+    void invalidate() { _size = 0; }
+
+private:
+    struct Slot {
+        GQuark key;
+        unsigned position;
+    };
+
+    Slot *_slots = nullptr;
+    unsigned _mask = 0;
+    unsigned _size = 0; ///< Number of records indexed; 0 if the index is not valid.
+
+    void _rebuild(AttributeVector const &attributes);
+    void _insert(GQuark key, unsigned position);
+};
+
+}
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
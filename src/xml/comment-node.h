@@ -37,7 +37,7 @@ struct CommentNode : public SimpleNode {
     Inkscape::XML::NodeType type() const override { return Inkscape::XML::NodeType::COMMENT_NODE; }
 
 protected:
-    SimpleNode *_duplicate(Document* doc) const override { return new CommentNode(*this, doc); }
+    SimpleNode *_duplicate(Document* doc) const override { return _create<CommentNode>(doc, *this, doc); }
 };
 
 }
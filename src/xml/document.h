@@ -96,6 +96,17 @@ public:
     virtual Node *createPI(char const *target, char const *content)=0;
     /*@}*/
 
+    /**
+     * @brief Get the arena this document's nodes are allocated from
+     *
+     * If the document has an arena, its nodes, their attribute lists and attribute values are
+     * carved out of a few large blocks that the collector reclaims together with the document,
+     * instead of being allocated one by one.
+     *
+     * @return The arena, or NULL if nodes are allocated individually
+     */
+    virtual Inkscape::GC::Arena *arena()=0;
+
     /**
      * @brief Get the event logger for this document
      *
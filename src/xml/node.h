@@ -16,9 +16,11 @@
 #include <vector>
 
 #include <2geom/point.h>
+#include <boost/container/small_vector.hpp>
 
 #include "gc-anchored.h"
 #include "inkgc/gc-alloc.h"
+#include "inkgc/gc-arena.h"
 #include "node-iterators.h"
 #include "util/const_char_ptr.h"
 
@@ -31,7 +33,11 @@ class AttributeRecord;
 struct Document;
 class NodeObserver;
 
-using AttributeVector = std::vector<AttributeRecord, Inkscape::GC::Alloc<AttributeRecord>>;
+/**
+ * Attribute list of a node. Most SVG elements carry a handful of attributes, which are kept
+ * inline in the node; longer lists spill to the document's arena or the collector.
+ */
+using AttributeVector = boost::container::small_vector<AttributeRecord, 6, Inkscape::GC::ArenaAlloc<AttributeRecord>>;
 
 /**
  * @brief Enumeration containing all supported node types.
@@ -147,6 +153,16 @@ public:
      */
     virtual char const *attribute(char const *key) const = 0;
 
+    /**
+     * @brief Get the string representation of a node's attribute, by its GQuark code
+     *
+     * Same as attribute(), but for callers that already hold the interned name; this
+     * avoids converting it back to a string and re-interning it.
+     *
+     * @param code GQuark code corresponding to the name of the node's attribute
+     */
+    virtual char const *attributeByCode(int code) const = 0;
+
     /**
      * @brief Get a list of the node's attributes
      *
@@ -47,7 +47,7 @@ using Inkscape::XML::AttributeRecord;
 using Inkscape::XML::AttributeVector;
 using Inkscape::XML::rebase_href_attrs;
 
-Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns);
+Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns, bool use_arena = false);
 static Node *sp_repr_svg_read_node (Document *xml_doc, xmlNodePtr node, const gchar *default_ns, std::map<std::string, std::string> &prefix_map);
 static gint sp_repr_qualified_name (gchar *p, gint len, xmlNsPtr ns, const xmlChar *name, const gchar *default_ns, std::map<std::string, std::string> &prefix_map);
 static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
@@ -270,8 +270,10 @@ int XmlSource::close()
  * \param default_ns Default namespace for the document, can be nullptr.
  *
  * \param xinclude Process XInclude directives, which is off by default for security.
+ *
+ * \param use_arena Allocate the document's nodes from a per-document arena.
  */
-Document *sp_repr_read_file (const gchar * filename, const gchar *default_ns, bool xinclude)
+Document *sp_repr_read_file (const gchar * filename, const gchar *default_ns, bool xinclude, bool use_arena)
 {
     xmlDocPtr doc = nullptr;
     Document * rdoc = nullptr;
@@ -304,7 +306,7 @@ Document *sp_repr_read_file (const gchar * filename, const gchar *default_ns, bo
         if (xinclude && doc && doc->properties && xmlXIncludeProcessFlags(doc, XML_PARSE_NOXINCNODE) < 0) {
             g_warning("XInclude processing failed for %s", filename);
         }
-        rdoc = sp_repr_do_read(doc, default_ns);
+        rdoc = sp_repr_do_read(doc, default_ns, use_arena);
     }
 
     if (doc) {
@@ -433,7 +435,7 @@ void repair_namespace(Node *repr, const gchar *prefix) {
 /**
  * Reads in a XML file to create a Document
  */
-Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns)
+Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns, bool use_arena)
 {
     if (doc == nullptr) {
         return nullptr;
@@ -445,7 +447,7 @@ Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns)
 
     std::map<std::string, std::string> prefix_map;
 
-    Document *rdoc = new Inkscape::XML::SimpleDocument();
+    Document *rdoc = new Inkscape::XML::SimpleDocument(use_arena);
 
     Node *root=nullptr;
     for ( node = doc->children ; node != nullptr ; node = node->next ) {
@@ -49,23 +49,23 @@ Inkscape::XML::Event *SimpleDocument::commitUndoable() {
 }
 
 Node *SimpleDocument::createElement(char const *name) {
-    return new ElementNode(g_quark_from_string(name), this);
+    return _create<ElementNode>(this, g_quark_from_string(name), this);
 }
 
 Node *SimpleDocument::createTextNode(char const *content) {
-    return new TextNode(Util::share_string(content), this);
+    return _create<TextNode>(this, Util::share_string(content), this);
 }
 
 Node *SimpleDocument::createTextNode(char const *content, bool const is_CData) {
-    return new TextNode(Util::share_string(content), this, is_CData);
+    return _create<TextNode>(this, Util::share_string(content), this, is_CData);
 }
 
 Node *SimpleDocument::createComment(char const *content) {
-    return new CommentNode(Util::share_string(content), this);
+    return _create<CommentNode>(this, Util::share_string(content), this);
 }
 
 Node *SimpleDocument::createPI(char const *target, char const *content) {
-    return new PINode(g_quark_from_string(target), Util::share_string(content), this);
+    return _create<PINode>(this, g_quark_from_string(target), Util::share_string(content), this);
 }
 
 void SimpleDocument::notifyChildAdded(Node &parent,
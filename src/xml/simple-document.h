@@ -27,9 +27,13 @@ class SimpleDocument : public SimpleNode,
                        public NodeObserver
 {
 public:
-    explicit SimpleDocument()
+    /**
+     * @param use_arena Allocate nodes of this document from a per-document GC::Arena.
+     */
+    explicit SimpleDocument(bool use_arena = false)
     : SimpleNode(g_quark_from_static_string("xml"), this),
-      _in_transaction(false) {}
+      _in_transaction(false),
+      _arena(use_arena ? new Inkscape::GC::Arena() : nullptr) {}
 
     NodeType type() const override { return Inkscape::XML::NodeType::DOCUMENT_NODE; }
 
@@ -46,6 +50,8 @@ public:
     Node *createComment(char const *content) override;
     Node *createPI(char const *target, char const *content) override;
 
+    Inkscape::GC::Arena *arena() override { return _arena; }
+
     void notifyChildAdded(Node &parent, Node &child, Node *prev) override;
 
     void notifyChildRemoved(Node &parent, Node &child, Node *prev) override;
@@ -66,7 +72,8 @@ public:
 protected:
     SimpleDocument(SimpleDocument const &doc)
     : Node(), SimpleNode(doc), Document(), NodeObserver(),
-      _in_transaction(false)
+      _in_transaction(false),
+      _arena(doc._arena ? new Inkscape::GC::Arena() : nullptr)
       {}
 
     SimpleNode *_duplicate(Document* /*doc*/) const override
@@ -78,6 +85,7 @@ protected:
 private:
     bool _in_transaction;
     LogBuilder _log_builder;
+    Inkscape::GC::Arena *_arena;
 };
 
 }
@@ -32,6 +32,7 @@
 #include "util/format.h"
 
 #include "attribute-rel-util.h"
+#include "attributes.h"
 
 namespace Inkscape {
 
@@ -214,9 +215,40 @@ SimpleNode::SimpleNode(SimpleNode const &node, Document *document)
 
     _attributes = node._attributes;
 
+    // Values shared from another document's arena would pin that whole arena.
+    if (node._document != document && node._document->arena()) {
+        for (auto &attr : _attributes) {
+            attr.value = share_string(attr.value);
+        }
+    }
+
     _observers.add(_subtree_observers);
 }
 
+void SimpleNode::_adoptArena(Inkscape::GC::Arena *arena)
+{
+    AttributeVector attributes{AttributeVector::allocator_type(Inkscape::GC::ArenaAlloc<AttributeRecord>(arena))};
+    attributes.reserve(_attributes.size());
+    for (auto const &attr : _attributes) {
+        attributes.emplace_back(attr.key, share_unsafe(arena->copy_string(attr.value, std::strlen(attr.value))));
+    }
+    _attributes = std::move(attributes);
+    _attribute_index.invalidate();
+}
+
+namespace {
+
+/// Copy an attribute value into the document's arena, or into a collected string without one.
+ptr_shared share_value(Document *document, char const *value)
+{
+    if (auto arena = document->arena()) {
+        return share_unsafe(arena->copy_string(value, std::strlen(value)));
+    }
+    return share_string(value);
+}
+
+} // namespace
+
 gchar const *SimpleNode::name() const {
     return g_quark_to_string(_name);
 }
@@ -228,16 +260,23 @@ gchar const *SimpleNode::content() const {
 gchar const *SimpleNode::attribute(gchar const *name) const {
     g_return_val_if_fail(name != nullptr, NULL);
 
-    GQuark const key = g_quark_from_string(name);
-
-    for (const auto & iter : _attributes)
-    {
-        if ( iter.key == key ) {
-            return iter.value;
-        }
+    // Known attribute names resolve to their quark without touching the global quark table;
+    // any other name that was never interned cannot be the name of an attribute. Aliases such
+    // as "href" map to another attribute, so they go by their own name.
+    auto const id = sp_attribute_lookup(name);
+    GQuark const key = id != SPAttr::INVALID && std::strcmp(sp_attribute_name(id), name) == 0
+                           ? sp_attribute_quark(id)
+                           : g_quark_try_string(name);
+    if (!key) {
+        return nullptr;
     }
 
-    return nullptr;
+    return attributeByCode(key);
+}
+
+gchar const *SimpleNode::attributeByCode(int code) const {
+    int const pos = _attribute_index.find(_attributes, static_cast<GQuark>(code));
+    return pos >= 0 ? _attributes[pos].value : ptr_shared();
 }
 
 unsigned SimpleNode::position() const {
@@ -360,30 +399,27 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
 
     GQuark const key = g_quark_from_string(name);
 
-    AttributeRecord *ref = nullptr;
-    for ( auto & existing : _attributes ) {
-        if ( existing.key == key ) {
-            ref = &existing;
-            break;
-        }
-    }
+    int const pos = _attribute_index.find(_attributes, key);
+    AttributeRecord *ref = pos >= 0 ? &_attributes[pos] : nullptr;
     Debug::EventTracker<> tracker;
 
     ptr_shared old_value=( ref ? ref->value : ptr_shared() );
 
     ptr_shared new_value=ptr_shared();
     if (cleaned_value) { // set value of attribute
-        new_value = share_string(cleaned_value);
+        new_value = share_value(_document, cleaned_value);
         tracker.set<DebugSetAttribute>(*this, key, new_value);
         if (!ref) {
-	    _attributes.emplace_back(key, new_value);
+            _attributes.emplace_back(key, new_value);
+            _attribute_index.appended(_attributes);
         } else {
             ref->value = new_value;
         }
     } else { //clearing attribute
         tracker.set<DebugClearAttribute>(*this, key);
         if (ref) {
-	    _attributes.erase(std::find(_attributes.begin(),_attributes.end(),(*ref)));
+            _attributes.erase(_attributes.begin() + pos);
+            _attribute_index.invalidate();
         }
     }
 
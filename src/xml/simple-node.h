@@ -17,9 +17,12 @@
 
 #include <cassert>
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #include "xml/node.h"
+#include "xml/document.h"
+#include "xml/attribute-index.h"
 #include "xml/attribute-record.h"
 #include "xml/composite-node-observer.h"
 
@@ -82,6 +85,7 @@ public:
     void setPosition(int pos) override;
 
     char const *attribute(char const *key) const override;
+    char const *attributeByCode(int code) const override;
     bool matchAttributeName(char const *partial_name) const override;
 
     char const *content() const override;
@@ -118,12 +122,30 @@ protected:
     SimpleNode(SimpleNode const &repr, Document *document);
 
     virtual SimpleNode *_duplicate(Document *doc) const=0;
+
+    /**
+     * Construct a node of type T for @a doc, in the document's arena if it has one.
+     * All node creation should go through here.
+     */
+    template <typename T, typename... Args>
+    static T *_create(Document *doc, Args &&...args)
+    {
+        auto arena = doc->arena();
+        if (!arena) {
+            return new T(std::forward<Args>(args)...);
+        }
+        // Nodes derive from GC::Managed, whose operator new would hide placement new.
+        T *node = ::new (arena->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        static_cast<SimpleNode *>(node)->_adoptArena(arena);
+        return node;
+    }
     void setAttributeImpl(char const *key, char const *value) override;
 
 private:
     void operator=(Node const &); // no assign
 
     void _setParent(SimpleNode *parent);
+    void _adoptArena(Inkscape::GC::Arena *arena);
     unsigned _childPosition(SimpleNode const &child) const;
 
     SimpleNode *_parent;
@@ -135,6 +157,7 @@ private:
     int _name;
 
     AttributeVector _attributes;
+    mutable AttributeIndex _attribute_index;
 
     Inkscape::Util::ptr_shared _content;
 
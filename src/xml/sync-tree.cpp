@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Bring one XML tree in line with another by applying only the differences.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "xml/sync-tree.h"
+
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <glib.h>
+
+#include "gc-anchored.h"
+#include "xml/node.h"
+
+namespace Inkscape {
+namespace XML {
+
+namespace {
+
+using Skip = std::function<bool (Node const &)>;
+
+char const *get_id(Node const &node)
+{
+    static GQuark const id_code = g_quark_from_static_string("id");
+    return node.type() == NodeType::ELEMENT_NODE ? node.attributeByCode(id_code) : nullptr;
+}
+
+/**
+ * Nodes can only be paired up if they have the same type, element name and sodipodi:type, as
+ * the latter decides which kind of object a path becomes.
+ */
+struct Kind
+{
+    std::uint64_t type_and_name;
+    std::string_view sodipodi_type;
+
+    bool operator==(Kind const &other) const = default;
+};
+
+struct KindHash
+{
+    std::size_t operator()(Kind const &kind) const
+    {
+        return std::hash<std::uint64_t>()(kind.type_and_name) * 31 + std::hash<std::string_view>()(kind.sodipodi_type);
+    }
+};
+
+Kind kind(Node const &node)
+{
+    static GQuark const sodipodi_type_code = g_quark_from_static_string("sodipodi:type");
+    auto const sodipodi_type = node.type() == NodeType::ELEMENT_NODE ? node.attributeByCode(sodipodi_type_code) : nullptr;
+    return { (std::uint64_t)node.type() << 32 | (std::uint32_t)node.code(), sodipodi_type ? sodipodi_type : "" };
+}
+
+/**
+ * Walks the two trees side by side. The same walk is done twice: once only to count the
+ * differences against a budget, and then, if they are few enough, to apply them.
+ */
+class Sync
+{
+public:
+    Sync(bool apply, std::size_t budget)
+        : _apply(apply)
+        , _budget(budget)
+    {}
+
+    bool over_budget() const { return _over_budget; }
+
+    void children(Node &target, Node const &source, Skip const &skip);
+
+private:
+    bool _apply;
+    std::size_t _budget;
+    bool _over_budget = false;
+
+    bool _spend(std::size_t changes);
+    void _node(Node &target, Node const &source);
+    void _attributes(Node &target, Node const &source);
+};
+
+bool Sync::_spend(std::size_t changes)
+{
+    if (_apply) {
+        return true;
+    }
+    if (_over_budget || changes > _budget) {
+        _over_budget = true;
+        return false;
+    }
+    _budget -= changes;
+    return true;
+}
+
+void Sync::children(Node &target, Node const &source, Skip const &skip)
+{
+    std::vector<Node *> old_nodes;
+    for (auto child = target.firstChild(); child; child = child->next()) {
+        if (!skip || !skip(*child)) {
+            old_nodes.push_back(child);
+        }
+    }
+    std::vector<Node const *> new_nodes;
+    for (auto child = source.firstChild(); child; child = child->next()) {
+        if (!skip || !skip(*child)) {
+            new_nodes.push_back(child);
+        }
+    }
+
+    // Pair up the children, first by id, then the rest in order.
+    constexpr int NONE = -1;
+    std::vector<int> match(new_nodes.size(), NONE);
+    std::vector<bool> used(old_nodes.size(), false);
+
+    std::unordered_map<std::string_view, unsigned> by_id;
+    for (unsigned i = 0; i < old_nodes.size(); i++) {
+        if (auto id = get_id(*old_nodes[i])) {
+            by_id.emplace(id, i);
+        }
+    }
+    for (unsigned i = 0; i < new_nodes.size(); i++) {
+        if (auto id = get_id(*new_nodes[i])) {
+            auto it = by_id.find(id);
+            if (it != by_id.end() && !used[it->second] && kind(*old_nodes[it->second]) == kind(*new_nodes[i])) {
+                match[i] = it->second;
+                used[it->second] = true;
+            }
+        }
+    }
+
+    std::unordered_map<Kind, std::deque<unsigned>, KindHash> unused;
+    for (unsigned i = 0; i < old_nodes.size(); i++) {
+        if (!used[i]) {
+            unused[kind(*old_nodes[i])].push_back(i);
+        }
+    }
+    for (unsigned i = 0; i < new_nodes.size(); i++) {
+        if (match[i] == NONE) {
+            auto it = unused.find(kind(*new_nodes[i]));
+            if (it != unused.end() && !it->second.empty()) {
+                match[i] = it->second.front();
+                used[match[i]] = true;
+                it->second.pop_front();
+            }
+        }
+    }
+
+    // Children without a partner go.
+    for (unsigned i = 0; i < old_nodes.size(); i++) {
+        if (!used[i]) {
+            if (!_spend(count_nodes(*old_nodes[i]))) {
+                return;
+            }
+            if (_apply) {
+                target.removeChild(old_nodes[i]);
+            }
+        }
+    }
+
+    // The partners keep their places as long as they come in increasing order; the others are
+    // moved after their predecessor, and new children are added there.
+    Node *prev = nullptr;
+    int last_kept = NONE;
+    for (unsigned i = 0; i < new_nodes.size(); i++) {
+        Node *node;
+        if (match[i] == NONE) {
+            if (!_spend(count_nodes(*new_nodes[i]))) {
+                return;
+            }
+            if (!_apply) {
+                continue;
+            }
+            node = new_nodes[i]->duplicate(target.document());
+            target.addChild(node, prev);
+            GC::release(node);
+        } else {
+            node = old_nodes[match[i]];
+            if (match[i] > last_kept) {
+                last_kept = match[i];
+            } else {
+                if (!_spend(1)) {
+                    return;
+                }
+                if (_apply) {
+                    target.changeOrder(node, prev);
+                }
+            }
+            _node(*node, *new_nodes[i]);
+            if (_over_budget) {
+                return;
+            }
+        }
+        prev = node;
+    }
+}
+
+void Sync::_node(Node &target, Node const &source)
+{
+    if (target.type() != NodeType::ELEMENT_NODE) {
+        if (g_strcmp0(target.content(), source.content()) != 0 && _spend(1) && _apply) {
+            target.setContent(source.content());
+        }
+        return;
+    }
+
+    _attributes(target, source);
+    children(target, source, {});
+}
+
+void Sync::_attributes(Node &target, Node const &source)
+{
+    for (auto const &attr : source.attributeList()) {
+        if (g_strcmp0(target.attributeByCode(attr.key), attr.value) != 0) {
+            if (!_spend(1)) {
+                return;
+            }
+            if (_apply) {
+                target.setAttribute(g_quark_to_string(attr.key), attr.value);
+            }
+        }
+    }
+
+    std::vector<GQuark> stale;
+    for (auto const &attr : target.attributeList()) {
+        if (!source.attributeByCode(attr.key)) {
+            stale.push_back(attr.key);
+        }
+    }
+    if (!_spend(stale.size())) {
+        return;
+    }
+    if (_apply) {
+        for (auto key : stale) {
+            target.removeAttribute(g_quark_to_string(key));
+        }
+    }
+}
+
+} // namespace
+
+std::size_t count_nodes(Node const &node)
+{
+    std::size_t count = 1;
+    for (auto child = node.firstChild(); child; child = child->next()) {
+        count += count_nodes(*child);
+    }
+    return count;
+}
+
+bool sync_children(Node &target, Node const &source, std::size_t max_changes, Skip const &skip)
+{
+    Sync dry_run(false, max_changes);
+    dry_run.children(target, source, skip);
+    if (dry_run.over_budget()) {
+        return false;
+    }
+
+    Sync(true, max_changes).children(target, source, skip);
+    return true;
+}
+
+}
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
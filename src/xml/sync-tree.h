@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Bring one XML tree in line with another by applying only the differences.
+ *//*
+ * Copyright (C) 2024 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_SYNC_TREE_H
+#define SEEN_INKSCAPE_XML_SYNC_TREE_H
+
+#include <cstddef>
+#include <functional>
+
+namespace Inkscape {
+namespace XML {
+
+class Node;
+
+/**
+ * Make the children of @a target (and everything below them) equal to those of @a source, by
+ * changing, adding, removing and moving only what differs. All changes go through the normal
+ * node methods, so observers see them one by one.
+ *
+ * Children are paired up by their id attribute, then by element name in order of appearance.
+ * Nodes for which @a skip returns true are left out on both sides, but only at the top level.
+ *
+ * The differences are counted before anything is changed. If there are more than
+ * @a max_changes of them (adding or removing a subtree counts each of its nodes), @a target is
+ * left alone and false is returned.
+ */
+bool sync_children(Node &target, Node const &source, std::size_t max_changes,
+                   std::function<bool (Node const &)> const &skip = {});
+
+/// Number of nodes in the subtree rooted at @a node, including @a node itself.
+std::size_t count_nodes(Node const &node);
+
+}
+}
+
+#endif // SEEN_INKSCAPE_XML_SYNC_TREE_H
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
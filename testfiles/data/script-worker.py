@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""
+A script extension worker, as described with ScriptWorker in
+src/extension/implementation/script-worker.h, for testing the protocol.
+
+Each call understands these arguments:
+  --upper         answer with the document in upper case; otherwise leave it unchanged
+  --message=TEXT  report TEXT in the chunk of messages
+  --stderr=TEXT   write TEXT to standard error, a little after the reply
+  --exit          exit without answering
+"""
+
+import sys
+import time
+
+
+def read_chunk(stream):
+    """A byte count in decimal and a newline, followed by that many bytes."""
+    line = stream.readline()
+    if not line:
+        return None
+    return stream.read(int(line))
+
+
+def write_chunk(stream, data):
+    stream.write(b"%d\n" % len(data))
+    stream.write(data)
+
+
+def main():
+    if sys.argv[1:] != ["--worker"]:
+        sys.exit("script-worker.py: only runs as a worker")
+
+    stdin = sys.stdin.buffer
+    stdout = sys.stdout.buffer
+    stderr = sys.stderr.buffer
+
+    while True:
+        line = stdin.readline()
+        if not line:
+            return  # Inkscape has closed our input.
+        args = [read_chunk(stdin).decode() for _ in range(int(line))]
+        document = read_chunk(stdin)
+
+        messages = b""
+        late_errors = b""
+        for arg in args:
+            if arg == "--exit":
+                return
+            if arg == "--upper":
+                document = document.upper()
+            elif arg.startswith("--message="):
+                messages += arg[len("--message="):].encode()
+            elif arg.startswith("--stderr="):
+                late_errors += arg[len("--stderr="):].encode()
+        if "--upper" not in args:
+            document = b""  # Unchanged
+
+        write_chunk(stdout, document)
+        write_chunk(stdout, messages)
+        stdout.flush()
+
+        # What goes to standard error before the NUL byte belongs to this call, even if it
+        # only arrives after the reply.
+        if late_errors:
+            time.sleep(0.1)
+            stderr.write(late_errors)
+        stderr.write(b"\0")
+        stderr.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -628,6 +628,21 @@ TEST(AttributesTest, NameRoundTrip)
 TEST(AttributesTest, Aliases)
 {
     EXPECT_EQ(sp_attribute_lookup("href"), SPAttr::XLINK_HREF);
+    EXPECT_EQ(sp_attribute_lookup(g_quark_from_string("href")), SPAttr::XLINK_HREF);
+}
+
+// Lookup by quark must agree with lookup by name, and reject non-attribute quarks.
+TEST(AttributesTest, QuarkRoundTrip)
+{
+    for (int i = FIRST_VALID_ID; i < (int)SPAttr::SPAttr_SIZE; ++i) {
+        auto const id = (SPAttr)i;
+        GQuark const quark = sp_attribute_quark(id);
+        EXPECT_STREQ(g_quark_to_string(quark), sp_attribute_name(id));
+        EXPECT_EQ(sp_attribute_lookup(quark), id) << "For attribute '" << sp_attribute_name(id) << "'";
+    }
+    EXPECT_EQ(sp_attribute_lookup(g_quark_from_string("not-an-attribute")), SPAttr::INVALID);
+    EXPECT_EQ(sp_attribute_lookup((gchar const *)nullptr), SPAttr::INVALID);
+    EXPECT_EQ(sp_attribute_quark(SPAttr::INVALID), 0u);
 }
 
 /* Test for any attributes that this test program doesn't know about.
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test the tracing pre-filters in trace/filterset.h
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "trace/filterset.h"
+
+#include <random>
+#include <gtest/gtest.h>
+
+using namespace Inkscape::Trace;
+
+namespace {
+
+int const gauss[5][5] = {
+    { 2,  4,  5,  4, 2 },
+    { 4,  9, 12,  9, 4 },
+    { 5, 12, 15, 12, 5 },
+    { 4,  9, 12,  9, 4 },
+    { 2,  4,  5,  4, 2 },
+};
+
+// The plain per-pixel definitions.
+
+GrayMap reference_gray_gaussian(GrayMap const &in)
+{
+    auto out = in;
+    for (int y = 2; y < in.height - 2; y++) {
+        for (int x = 2; x < in.width - 2; x++) {
+            unsigned long sum = 0;
+            for (int i = 0; i < 5; i++) {
+                for (int j = 0; j < 5; j++) {
+                    sum += in.getPixel(x + j - 2, y + i - 2) * gauss[i][j];
+                }
+            }
+            out.setPixel(x, y, std::min(sum / 159, GrayMap::WHITE));
+        }
+    }
+    return out;
+}
+
+RgbMap reference_rgb_gaussian(RgbMap const &in)
+{
+    auto out = in;
+    for (int y = 2; y < in.height - 2; y++) {
+        for (int x = 2; x < in.width - 2; x++) {
+            int r = 0, g = 0, b = 0;
+            for (int i = 0; i < 5; i++) {
+                for (int j = 0; j < 5; j++) {
+                    auto rgb = in.getPixel(x + j - 2, y + i - 2);
+                    r += rgb.r * gauss[i][j];
+                    g += rgb.g * gauss[i][j];
+                    b += rgb.b * gauss[i][j];
+                }
+            }
+            out.setPixel(x, y, { (unsigned char)(r / 159), (unsigned char)(g / 159), (unsigned char)(b / 159) });
+        }
+    }
+    return out;
+}
+
+GrayMap random_gray(int width, int height, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    auto map = GrayMap(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // Smooth areas with noise, so that the edge detector finds something.
+            map.setPixel(x, y, ((x / 7 + y / 5) % 2 ? 600 : 100) + gen() % 100);
+        }
+    }
+    return map;
+}
+
+} // namespace
+
+TEST(FiltersetTest, GrayGaussian)
+{
+    for (auto [w, h] : { std::pair{ 1, 1 }, { 4, 9 }, { 5, 5 }, { 61, 47 } }) {
+        auto const map = random_gray(w, h, w * h);
+        auto const expected = reference_gray_gaussian(map);
+        for (int nthreads : { 1, 3 }) {
+            EXPECT_EQ(grayMapGaussian(map, nthreads).pixels, expected.pixels) << w << "x" << h;
+        }
+    }
+}
+
+TEST(FiltersetTest, RgbGaussian)
+{
+    std::mt19937 gen(17);
+    for (auto [w, h] : { std::pair{ 2, 3 }, { 5, 6 }, { 53, 71 } }) {
+        auto map = RgbMap(w, h);
+        for (auto &px : map.pixels) {
+            px = { (unsigned char)gen(), (unsigned char)gen(), (unsigned char)gen() };
+        }
+        auto const expected = reference_rgb_gaussian(map);
+        for (int nthreads : { 1, 3 }) {
+            auto const result = rgbMapGaussian(map, nthreads);
+            for (std::size_t i = 0; i < map.pixels.size(); i++) {
+                ASSERT_EQ(result.pixels[i].r, expected.pixels[i].r);
+                ASSERT_EQ(result.pixels[i].g, expected.pixels[i].g);
+                ASSERT_EQ(result.pixels[i].b, expected.pixels[i].b);
+            }
+        }
+    }
+}
+
+TEST(FiltersetTest, CannyThreads)
+{
+    auto const map = random_gray(97, 120, 5);
+    auto const edges = grayMapCanny(map, 0.1, 0.65);
+
+    int nedges = 0;
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            auto v = edges.getPixel(x, y);
+            ASSERT_TRUE(v == GrayMap::BLACK || v == GrayMap::WHITE);
+            if (x == 0 || y == 0 || x == map.width - 1 || y == map.height - 1) {
+                EXPECT_EQ(v, GrayMap::WHITE);
+            }
+            nedges += v == GrayMap::BLACK;
+        }
+    }
+    EXPECT_GT(nedges, 0);
+
+    EXPECT_EQ(grayMapCanny(map, 0.1, 0.65, 4).pixels, edges.pixels);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test Inkscape::ImagePyramid
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/image-pyramid.h"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+
+using Inkscape::ImagePyramid;
+
+namespace {
+
+std::uint32_t pixel(cairo_surface_t *s, int x, int y)
+{
+    auto const row = cairo_image_surface_get_data(s) + y * cairo_image_surface_get_stride(s);
+    return reinterpret_cast<std::uint32_t const *>(row)[x];
+}
+
+void set_pixel(cairo_surface_t *s, int x, int y, std::uint32_t value)
+{
+    auto const row = cairo_image_surface_get_data(s) + y * cairo_image_surface_get_stride(s);
+    reinterpret_cast<std::uint32_t *>(row)[x] = value;
+}
+
+} // namespace
+
+TEST(ImagePyramidTest, LevelForScale)
+{
+    EXPECT_EQ(ImagePyramid::level_for_scale(2.0), 0);
+    EXPECT_EQ(ImagePyramid::level_for_scale(1.0), 0);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.6), 0);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.5), 1);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.3), 1);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.25), 2);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.01), 6);
+    EXPECT_EQ(ImagePyramid::level_for_scale(0.0), 0);
+}
+
+TEST(ImagePyramidTest, Downsample)
+{
+    auto src = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 3, 3);
+    cairo_surface_flush(src);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            set_pixel(src, x, y, 0xff000000 | (x + 3 * y) * 0x040404);
+        }
+    }
+    set_pixel(src, 1, 1, 0);
+    cairo_surface_mark_dirty(src);
+
+    auto dst = ImagePyramid::downsample(src);
+    ASSERT_EQ(cairo_image_surface_get_width(dst), 2);
+    ASSERT_EQ(cairo_image_surface_get_height(dst), 2);
+
+    // Top left block: values 0, 4, 12 and a transparent pixel.
+    EXPECT_EQ(pixel(dst, 0, 0), 0xbf040404);
+    // Right column pairs the last source column with itself: 8, 8, 20, 20.
+    EXPECT_EQ(pixel(dst, 1, 0), 0xff0e0e0e);
+    // Bottom right corner is a single source pixel.
+    EXPECT_EQ(pixel(dst, 1, 1), 0xff202020);
+
+    cairo_surface_destroy(dst);
+    cairo_surface_destroy(src);
+}
+
+TEST(ImagePyramidTest, Get)
+{
+    auto src = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 60);
+    ImagePyramid pyramid(src);
+
+    auto [full, zero] = pyramid.get(1.0);
+    EXPECT_EQ(full, src);
+    EXPECT_EQ(zero, 0);
+
+    auto [reduced, level] = pyramid.get(0.1);
+    EXPECT_EQ(level, 3);
+    EXPECT_EQ(cairo_image_surface_get_width(reduced), 13);
+    EXPECT_EQ(cairo_image_surface_get_height(reduced), 8);
+
+    // Levels stop at a single pixel.
+    auto [tiny, deepest] = pyramid.get(1e-6);
+    EXPECT_EQ(deepest, 7);
+    EXPECT_EQ(cairo_image_surface_get_width(tiny), 1);
+    EXPECT_EQ(cairo_image_surface_get_height(tiny), 1);
+
+    cairo_surface_destroy(src);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
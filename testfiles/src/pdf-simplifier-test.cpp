@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test merging paths and sharing styles in PDF import.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "extension/internal/pdfinput/svg-simplifier.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "svg/svg.h"
+#include "xml/document.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+using Inkscape::Extension::Internal::SvgSimplifier;
+
+namespace {
+
+/// No whitespace between the elements, as in imported drawings.
+std::shared_ptr<Inkscape::XML::Document> read_svg(char const *buf)
+{
+    return std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(buf, SP_SVG_NS_URI));
+}
+
+} // namespace
+
+TEST(PdfSimplifierTest, MergePaths)
+{
+    auto doc = read_svg(
+        "<svg><defs/><g>"
+        "<path style='fill:none;stroke:#000000' d='M 0,0 L 1,1'/>"
+        "<path style='fill:none;stroke:#000000' d='M 2,2 L 3,3'/>"
+        "<path style='fill:none;stroke:#000000' d='M 4,4 L 5,5'/>"
+        "<path style='fill:#ff0000' d='M 0,0 L 1,1'/>"
+        "<path style='fill:#ff0000' d='M 2,2 L 3,3'/>"
+        "<path style='fill:none;stroke:#000000;opacity:0.5' d='M 0,0 L 1,1'/>"
+        "<path style='fill:none;stroke:#000000;opacity:0.5' d='M 2,2 L 3,3'/>"
+        "<path style='fill:none;stroke:#000000;stroke-opacity:0.5' d='M 0,0 L 1,1'/>"
+        "<path style='fill:none;stroke:#000000;stroke-opacity:0.5' d='M 2,2 L 3,3'/>"
+        "<path id='a' style='fill:none;stroke:#000000' d='M 0,0 L 1,1'/>"
+        "<path id='b' style='fill:none;stroke:#000000' d='M 2,2 L 3,3'/>"
+        "</g></svg>");
+    ASSERT_TRUE(doc);
+    auto root = doc->root();
+    auto layer = root->lastChild();
+
+    auto simplifier = SvgSimplifier(root, root->firstChild(), "t-");
+    simplifier.mergeSiblingPaths(layer);
+
+    // Only the outlines without ids are merged; fills and translucent paths could render differently.
+    EXPECT_EQ(layer->childCount(), 9u);
+    EXPECT_EQ(sp_svg_read_pathv(layer->firstChild()->attribute("d")).size(), 3u);
+    EXPECT_EQ(simplifier.pathsMerged(), 2);
+    for (auto child = layer->firstChild()->next(); child; child = child->next()) {
+        EXPECT_EQ(sp_svg_read_pathv(child->attribute("d")).size(), 1u);
+    }
+}
+
+TEST(PdfSimplifierTest, ShareStyles)
+{
+    auto doc = read_svg(
+        "<svg><defs/><g>"
+        "<path style='fill:#ff0000' d='M 0,0 L 1,1'/>"
+        "<path style='fill:#ff0000' d='M 2,2 L 3,3'/>"
+        "<path style='fill:#00ff00' d='M 0,0 L 1,1'/>"
+        "<path style='fill:url(#grad)' d='M 0,0 L 1,1'/>"
+        "<path style='fill:url(#grad)' d='M 2,2 L 3,3'/>"
+        "</g><g>"
+        "<path style='fill:#ff0000' d='M 4,4 L 5,5'/>"
+        "</g></svg>");
+    ASSERT_TRUE(doc);
+    auto root = doc->root();
+    auto defs = root->firstChild();
+    auto page1 = defs->next();
+    auto page2 = page1->next();
+
+    auto simplifier = SvgSimplifier(root, defs, "t-");
+    simplifier.shareStyles(page1);
+
+    auto path = page1->firstChild();
+    EXPECT_STREQ(path->attribute("class"), "t-1");
+    EXPECT_EQ(path->attribute("style"), nullptr);
+    path = path->next();
+    EXPECT_STREQ(path->attribute("class"), "t-1");
+    // Styles used once stay inline, and so do those referring to ids.
+    path = path->next();
+    EXPECT_STREQ(path->attribute("style"), "fill:#00ff00");
+    for (path = path->next(); path; path = path->next()) {
+        EXPECT_STREQ(path->attribute("style"), "fill:url(#grad)");
+        EXPECT_EQ(path->attribute("class"), nullptr);
+    }
+
+    auto sheet = defs->next();
+    ASSERT_STREQ(sheet->name(), "svg:style");
+    ASSERT_TRUE(sheet->firstChild());
+    EXPECT_STREQ(sheet->firstChild()->content(), ".t-1{fill:#ff0000}\n");
+
+    // Later pages use the classes of earlier ones.
+    simplifier.shareStyles(page2);
+    EXPECT_STREQ(page2->firstChild()->attribute("class"), "t-1");
+    EXPECT_EQ(simplifier.stylesShared(), 3);
+    EXPECT_EQ(simplifier.styleClasses(), 1u);
+    EXPECT_EQ(sheet->childCount(), 1u);
+}
+
+TEST(PdfSimplifierTest, SimplifyLayers)
+{
+    // Layers of optional content groups, one inside another, as built for a layered page.
+    auto doc = read_svg(
+        "<svg><defs/>"
+        "<g id='layer-oc1'>"
+        "<path style='fill:none;stroke:#000000' d='M 0,0 L 1,1'/>"
+        "<path style='fill:none;stroke:#000000' d='M 2,2 L 3,3'/>"
+        "<g id='layer-oc2'>"
+        "<path style='fill:none;stroke:#0000ff' d='M 0,0 L 1,1'/>"
+        "<path style='fill:none;stroke:#0000ff' d='M 2,2 L 3,3'/>"
+        "<path style='fill:#ff0000' d='M 0,0 L 1,1'/>"
+        "<path style='fill:#ff0000' d='M 2,2 L 3,3'/>"
+        "</g>"
+        "</g>"
+        "<g id='layer-oc3'>"
+        "<path style='fill:#ff0000' d='M 4,4 L 5,5'/>"
+        "</g></svg>");
+    ASSERT_TRUE(doc);
+    auto root = doc->root();
+    auto defs = root->firstChild();
+    auto oc1 = defs->next();
+    auto oc2 = oc1->lastChild();
+    auto oc3 = oc1->next();
+
+    auto simplifier = SvgSimplifier(root, defs, "t-");
+    simplifier.simplifyLayers({oc1, oc2, oc3});
+
+    // The nested layer is only simplified once, along with the one around it.
+    EXPECT_EQ(oc1->childCount(), 2u);
+    EXPECT_EQ(oc2->childCount(), 3u);
+    EXPECT_EQ(simplifier.pathsMerged(), 2);
+    EXPECT_EQ(simplifier.pathsKept(), 2);
+    EXPECT_EQ(sp_svg_read_pathv(oc2->firstChild()->attribute("d")).size(), 2u);
+
+    // Later layers use the classes of earlier ones.
+    EXPECT_STREQ(oc2->lastChild()->attribute("class"), "t-1");
+    EXPECT_STREQ(oc3->firstChild()->attribute("class"), "t-1");
+    EXPECT_EQ(simplifier.styleClasses(), 1u);
+}
+
+TEST(PdfSimplifierTest, StyleClassLimit)
+{
+    // One more style than there can be classes, and one used more often than the others.
+    auto const count = SvgSimplifier::MAX_STYLE_CLASSES + 1;
+    std::string svg = "<svg><defs/><g>";
+    for (std::size_t i = 0; i < count; i++) {
+        auto path = "<path style='fill:#" + std::to_string(100000 + i) + "' d='M 0,0 L 1,1'/>";
+        svg += path + path;
+        if (i == count - 1) {
+            svg += path;
+        }
+    }
+    svg += "</g></svg>";
+    auto doc = read_svg(svg.c_str());
+    ASSERT_TRUE(doc);
+    auto root = doc->root();
+    auto defs = root->firstChild();
+    auto layer = defs->next();
+
+    auto simplifier = SvgSimplifier(root, defs, "t-");
+    simplifier.shareStyles(layer);
+
+    EXPECT_EQ(simplifier.styleClasses(), SvgSimplifier::MAX_STYLE_CLASSES);
+    EXPECT_EQ(simplifier.stylesShared(), static_cast<int>(2 * SvgSimplifier::MAX_STYLE_CLASSES + 1));
+    EXPECT_STREQ(layer->lastChild()->attribute("class"), "t-1");
+    // Of the styles used equally often, the last one misses out.
+    int left_inline = 0;
+    for (auto path = layer->firstChild(); path; path = path->next()) {
+        left_inline += path->attribute("style") != nullptr;
+    }
+    EXPECT_EQ(left_inline, 2);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test Inkscape::PickIndex
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/pick-index.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "display/drawing.h"
+#include "display/drawing-item.h"
+#include "object/sp-item.h"
+#include "object/sp-root.h"
+#include "xml/node.h"
+
+using Inkscape::PickIndex;
+
+TEST(PickIndexTest, MatchesLinearSearch)
+{
+    std::mt19937 gen(4321);
+    std::uniform_real_distribution<double> coord(-1000, 1000);
+    std::uniform_real_distribution<double> extent(0, 40);
+
+    std::vector<Geom::OptRect> boxes;
+    for (int i = 0; i < 5000; i++) {
+        if (i % 17 == 0) {
+            boxes.emplace_back(); // Items with nothing to pick.
+            continue;
+        }
+        Geom::Point p(coord(gen), coord(gen));
+        auto r = Geom::Rect(p, p);
+        r.expandBy(i % 101 == 0 ? 600 : extent(gen));
+        boxes.emplace_back(r);
+    }
+
+    PickIndex index(boxes);
+
+    for (int i = 0; i < 200; i++) {
+        Geom::Point p(coord(gen), coord(gen));
+        double delta = i % 2 ? 0.0 : 3.0;
+
+        std::vector<unsigned> expected;
+        auto area = Geom::Rect(p, p);
+        area.expandBy(delta);
+        for (unsigned j = 0; j < boxes.size(); j++) {
+            if (boxes[j] && boxes[j]->intersects(area)) {
+                expected.push_back(j);
+            }
+        }
+
+        EXPECT_EQ(index.query(p, delta), expected);
+    }
+}
+
+TEST(PickIndexTest, Empty)
+{
+    PickIndex index({});
+    EXPECT_TRUE(index.query(Geom::Point(0, 0), 1.0).empty());
+
+    PickIndex nothing({ Geom::OptRect(), Geom::OptRect() });
+    EXPECT_TRUE(nothing.query(Geom::Rect(-1e6, -1e6, 1e6, 1e6)).empty());
+}
+
+TEST(PickIndexTest, FollowsZOrder)
+{
+    if (!Inkscape::Application::exists()) {
+        Inkscape::Application::create(false);
+    }
+
+    // Enough overlapping rectangles for the group to be picked through the index.
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>";
+    for (unsigned i = 0; i < 2 * PickIndex::MIN_ENTRIES; i++) {
+        svg += "<rect id='r" + std::to_string(i) + "' x='10' y='10' width='50' height='50'/>";
+    }
+    svg += "</svg>";
+    auto doc = std::unique_ptr<SPDocument>(SPDocument::createNewDocFromMem(svg.c_str(), static_cast<int>(svg.size()), false));
+    ASSERT_TRUE(doc && doc->getRoot());
+    doc->ensureUpToDate();
+
+    Inkscape::Drawing drawing;
+    auto const dkey = SPItem::display_key_new(1);
+    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    drawing.update();
+
+    auto const p = Geom::Point(30, 30);
+    auto pick = [&] {
+        auto picked = drawing.pick(p, 0, 0);
+        return picked ? picked->getItem() : nullptr;
+    };
+
+    // The second pick builds the index.
+    auto const first = pick();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(pick(), first);
+
+    // Move the picked rectangle to the other end of the z-order, without updating the drawing.
+    auto repr = first->getRepr();
+    auto parent = repr->parent();
+    parent->changeOrder(repr, repr == parent->firstChild() ? parent->lastChild() : nullptr);
+
+    auto const second = pick();
+    ASSERT_TRUE(second);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(pick(), second);
+
+    doc->getRoot()->invoke_hide(dkey);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test Inkscape::Trace::rgbMapQuantize
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "trace/quantize.h"
+
+#include <random>
+#include <gtest/gtest.h>
+
+using namespace Inkscape::Trace;
+
+namespace {
+
+RgbMap random_map(int width, int height, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> channel(0, 255);
+    std::uniform_int_distribution<int> run(1, 8);
+
+    auto map = RgbMap(width, height);
+    RGB rgb{};
+    int left = 0;
+    for (auto &px : map.pixels) {
+        // Runs of equal pixels, as in real images.
+        if (left-- == 0) {
+            rgb = { (unsigned char)channel(gen), (unsigned char)channel(gen), (unsigned char)channel(gen) };
+            left = run(gen);
+        }
+        px = rgb;
+    }
+    return map;
+}
+
+int dist(RGB a, RGB b)
+{
+    return (a.r - b.r) * (a.r - b.r) + (a.g - b.g) * (a.g - b.g) + (a.b - b.b) * (a.b - b.b);
+}
+
+} // namespace
+
+TEST(QuantizeTest, PixelsGetNearestColor)
+{
+    auto const map = random_map(150, 100, 1234);
+
+    for (int ncolor : { 2, 7, 64, 256 }) {
+        auto const imap = rgbMapQuantize(map, ncolor);
+        ASSERT_GT(imap.nrColors, 0);
+        ASSERT_LE(imap.nrColors, ncolor);
+
+        for (int y = 0; y < map.height; y++) {
+            for (int x = 0; x < map.width; x++) {
+                auto const rgb = map.getPixel(x, y);
+                // The first of the nearest colors in the palette.
+                int best = 0;
+                for (int k = 1; k < imap.nrColors; k++) {
+                    if (dist(imap.clut[k], rgb) < dist(imap.clut[best], rgb)) {
+                        best = k;
+                    }
+                }
+                ASSERT_EQ(imap.getPixel(x, y), best) << "ncolor " << ncolor << " at " << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(QuantizeTest, ThreadsGiveSameResult)
+{
+    auto const map = random_map(80, 333, 99);
+
+    auto const imap = rgbMapQuantize(map, 32);
+    for (int nthreads : { 2, 5 }) {
+        auto const imap_threaded = rgbMapQuantize(map, 32, nthreads);
+        EXPECT_EQ(imap_threaded.nrColors, imap.nrColors);
+        EXPECT_EQ(imap_threaded.pixels, imap.pixels);
+    }
+}
+
+TEST(QuantizeTest, FewerColorsThanAsked)
+{
+    auto map = RgbMap(20, 20);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            map.setPixel(x, y, x < 10 ? RGB{ 200, 10, 10 } : RGB{ 10, 10, 200 });
+        }
+    }
+
+    auto const imap = rgbMapQuantize(map, 16);
+    ASSERT_EQ(imap.nrColors, 2);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            auto const c = imap.getPixelValue(x, y);
+            EXPECT_EQ(c.r, x < 10 ? 200 : 10);
+            EXPECT_EQ(c.b, x < 10 ? 10 : 200);
+        }
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
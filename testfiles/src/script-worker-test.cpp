@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test the protocol of extension workers, using the worker in testfiles/data.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "extension/implementation/script-worker.h"
+
+#include <memory>
+#include <gtest/gtest.h>
+#include <glibmm/miscutils.h>
+
+using Inkscape::Extension::Implementation::ScriptWorker;
+
+class ScriptWorkerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto const python = Glib::find_program_in_path("python3");
+        if (python.empty()) {
+            GTEST_SKIP() << "python3 not found";
+        }
+        worker = std::make_unique<ScriptWorker>(std::vector<std::string>{python, INKSCAPE_TESTS_DIR "/data/script-worker.py"},
+                                                Glib::get_current_dir());
+    }
+
+    std::unique_ptr<ScriptWorker> worker;
+};
+
+TEST_F(ScriptWorkerTest, Calls)
+{
+    auto reply = worker->call({"--upper", "--message=Done"}, "<svg/>");
+    ASSERT_TRUE(reply);
+    EXPECT_TRUE(worker->requestSent());
+    EXPECT_EQ(reply->document, "<SVG/>");
+    EXPECT_EQ(reply->messages, "Done");
+
+    // The same worker answers the following calls, and an empty document means no change.
+    reply = worker->call({}, "<svg/>");
+    ASSERT_TRUE(reply);
+    EXPECT_EQ(reply->document, "");
+    EXPECT_EQ(reply->messages, "");
+}
+
+TEST_F(ScriptWorkerTest, LateErrors)
+{
+    // Standard error written after the reply still belongs to its call.
+    auto reply = worker->call({"--stderr=Warning"}, "<svg/>");
+    ASSERT_TRUE(reply);
+    EXPECT_EQ(reply->messages, "Warning");
+
+    reply = worker->call({}, "<svg/>");
+    ASSERT_TRUE(reply);
+    EXPECT_EQ(reply->messages, "");
+}
+
+TEST_F(ScriptWorkerTest, Exit)
+{
+    // The worker got the request and may have acted on it, so it must not be run again.
+    EXPECT_FALSE(worker->call({"--exit"}, "<svg/>"));
+    EXPECT_TRUE(worker->requestSent());
+
+    // Once broken, the worker is not used any more.
+    EXPECT_FALSE(worker->call({}, "<svg/>"));
+    EXPECT_FALSE(worker->requestSent());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test Inkscape::SnapTargetIndex
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "snap-target-index.h"
+
+#include <limits>
+#include <random>
+#include <gtest/gtest.h>
+
+using Inkscape::SnapTargetIndex;
+
+TEST(SnapTargetIndexTest, MatchesLinearSearch)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> coord(-500, 500);
+    std::uniform_real_distribution<double> extent(0, 50);
+
+    SnapTargetIndex index(8.0);
+    std::vector<Geom::Rect> rects;
+    for (int i = 0; i < 2000; i++) {
+        Geom::Point p(coord(gen), coord(gen));
+        // Mix points, small boxes and a few boxes spanning many cells.
+        auto r = Geom::Rect(p, p);
+        if (i % 3 == 1) {
+            r.expandBy(extent(gen));
+        } else if (i % 97 == 0) {
+            r.expandBy(400);
+        }
+        EXPECT_EQ(index.insert(r), rects.size());
+        rects.push_back(r);
+    }
+
+    for (int q = 0; q < 200; q++) {
+        Geom::Point c(coord(gen), coord(gen));
+        auto area = Geom::Rect(c, c);
+        area.expandBy(q % 10 == 0 ? 300.0 : 4.0);
+
+        std::vector<unsigned> expected;
+        for (unsigned i = 0; i < rects.size(); i++) {
+            if (rects[i].intersects(area)) {
+                expected.push_back(i);
+            }
+        }
+        EXPECT_EQ(index.query(area), expected);
+    }
+}
+
+TEST(SnapTargetIndexTest, Bands)
+{
+    SnapTargetIndex index(2.0);
+    index.insert(Geom::Point(0, 0));
+    index.insert(Geom::Point(1000, 1));
+    index.insert(Geom::Point(5, 1000));
+    index.insert(Geom::Point(-1000, -10));
+
+    auto const inf = std::numeric_limits<double>::infinity();
+    EXPECT_EQ(index.query(Geom::Rect(-inf, -2, inf, 2)), (std::vector<unsigned>{0, 1}));
+    EXPECT_EQ(index.query(Geom::Rect(-1, -inf, 6, inf)), (std::vector<unsigned>{0, 2}));
+
+    index.clear(2.0);
+    EXPECT_TRUE(index.empty());
+    EXPECT_TRUE(index.query(Geom::Rect(-inf, -inf, inf, inf)).empty());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -14,7 +14,12 @@
 
 #include "gtest/gtest.h"
 #include "xml/repr.h"
+#include "xml/simple-document.h"
+#include "xml/event-fns.h"
+#include "xml/sync-tree.h"
 
+#include <chrono>
+#include <iostream>
 #include <list>
 
 TEST(XmlTest, nodeiter)
@@ -97,6 +102,218 @@ NODE
 )""");
 }
 
+TEST(XmlArenaTest, attributes)
+{
+    auto arenadoc = new Inkscape::XML::SimpleDocument(true);
+    ASSERT_NE(arenadoc->arena(), nullptr);
+
+    auto root = arenadoc->createElement("svg:svg");
+    arenadoc->appendChild(root);
+    for (int i = 0; i < 100; i++) {
+        auto child = arenadoc->createElement("svg:rect");
+        child->setAttribute("id", "rect" + std::to_string(i));
+        child->setAttributeInt("width", i);
+        child->setAttribute("width", nullptr);
+        child->setAttributeInt("height", i);
+        root->appendChild(child);
+        Inkscape::GC::release(child);
+    }
+    EXPECT_STREQ(root->lastChild()->attribute("id"), "rect99");
+    EXPECT_EQ(root->lastChild()->attribute("width"), nullptr);
+    EXPECT_GT(arenadoc->arena()->stats().bytes_used, 0u);
+
+    // Copies into an ordinary document must not refer to the arena.
+    auto plaindoc = new Inkscape::XML::SimpleDocument();
+    auto copy = root->duplicate(plaindoc);
+    EXPECT_EQ(copy->childCount(), 100u);
+    EXPECT_STREQ(copy->lastChild()->attribute("height"), "99");
+    EXPECT_NE(copy->lastChild()->attribute("height"), root->lastChild()->attribute("height"));
+    EXPECT_EQ(copy->lastChild()->attributeList().get_allocator().arena(), nullptr);
+
+    Inkscape::GC::release(copy);
+    Inkscape::GC::release(root);
+    Inkscape::GC::release(plaindoc);
+    Inkscape::GC::release(arenadoc);
+}
+
+TEST(XmlTest, manyAttributes)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg/>", SP_SVG_NS_URI));
+    auto root = testdoc->root();
+
+    // Enough attributes to switch from scanning to the hash index, and back.
+    for (int i = 0; i < 40; i++) {
+        root->setAttributeInt("data-a" + std::to_string(i), i);
+    }
+    for (int i = 0; i < 40; i += 2) {
+        root->removeAttribute("data-a" + std::to_string(i));
+    }
+    root->setAttribute("data-a0", "again");
+    for (int i = 1; i < 40; i += 2) {
+        EXPECT_EQ(root->getAttributeInt("data-a" + std::to_string(i)), i);
+        if (i > 1) {
+            EXPECT_EQ(root->attribute(("data-a" + std::to_string(i - 1)).c_str()), nullptr);
+        }
+    }
+    EXPECT_STREQ(root->attribute("data-a0"), "again");
+    EXPECT_EQ(root->attributeList().size(), 21u);
+}
+
+TEST(XmlTest, hrefAlias)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg xmlns:xlink='http://www.w3.org/1999/xlink'><use xlink:href='#a'/><use href='#b'/></svg>", SP_SVG_NS_URI));
+    auto first = testdoc->root()->firstChild();
+    auto second = first->next();
+
+    // "href" is an alias of xlink:href for sp_attribute_lookup(), but not for the XML layer.
+    EXPECT_STREQ(first->attribute("xlink:href"), "#a");
+    EXPECT_EQ(first->attribute("href"), nullptr);
+    EXPECT_STREQ(second->attribute("href"), "#b");
+    EXPECT_EQ(second->attribute("xlink:href"), nullptr);
+}
+
+/// Compare two trees, ignoring the order of attributes.
+static bool same_tree(Inkscape::XML::Node const &a, Inkscape::XML::Node const &b)
+{
+    if (a.code() != b.code() || g_strcmp0(a.content(), b.content()) != 0 ||
+        a.attributeList().size() != b.attributeList().size()) {
+        return false;
+    }
+    for (auto const &attr : a.attributeList()) {
+        if (g_strcmp0(b.attributeByCode(attr.key), attr.value) != 0) {
+            return false;
+        }
+    }
+    auto x = a.firstChild();
+    auto y = b.firstChild();
+    for (; x && y; x = x->next(), y = y->next()) {
+        if (!same_tree(*x, *y)) {
+            return false;
+        }
+    }
+    return !x && !y;
+}
+
+TEST(XmlSyncTest, syncChildren)
+{
+    auto target = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(R"""(
+<svg>
+  <g id="a"><rect id="r1" x="1"/><rect id="r2"/><rect/></g>
+  <text>hello</text>
+  <circle r="1"/>
+</svg>
+)""", SP_SVG_NS_URI));
+    auto source = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(R"""(
+<svg>
+  <circle r="2"/>
+  <g id="a"><rect id="r2" y="3"/><path id="p"/><rect id="r1" x="2"/></g>
+  <text>world</text>
+</svg>
+)""", SP_SVG_NS_URI));
+    ASSERT_TRUE(target && source);
+
+    auto group = target->root()->firstChild()->next();
+    ASSERT_STREQ(group->attribute("id"), "a");
+    auto r1 = group->firstChild();
+
+    // Too many changes for the budget: nothing happens.
+    EXPECT_FALSE(Inkscape::XML::sync_children(*target->root(), *source->root(), 3));
+    EXPECT_FALSE(same_tree(*target->root(), *source->root()));
+
+    EXPECT_TRUE(Inkscape::XML::sync_children(*target->root(), *source->root(), 100));
+    EXPECT_TRUE(same_tree(*target->root(), *source->root()));
+
+    // Nodes paired up by id are kept, not replaced.
+    EXPECT_EQ(r1->parent(), group);
+    EXPECT_STREQ(r1->attribute("x"), "2");
+    EXPECT_EQ(group->lastChild(), r1);
+
+    // Nothing left to do.
+    EXPECT_TRUE(Inkscape::XML::sync_children(*target->root(), *source->root(), 0));
+}
+
+TEST(XmlSyncTest, sodipodiType)
+{
+    auto target = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(
+        "<svg xmlns:sodipodi='http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd'><path id='s' sodipodi:type='star' d='M 0,0'/></svg>", SP_SVG_NS_URI));
+    auto source = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(
+        "<svg xmlns:sodipodi='http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd'><path id='s' d='M 1,1'/></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(target && source);
+
+    // A star turned into a plain path must become a new object, not keep the star.
+    auto star = target->root()->firstChild();
+    Inkscape::GC::anchor(star);
+    EXPECT_TRUE(Inkscape::XML::sync_children(*target->root(), *source->root(), 100));
+    EXPECT_TRUE(same_tree(*target->root(), *source->root()));
+    EXPECT_NE(target->root()->firstChild(), star);
+    Inkscape::GC::release(star);
+}
+
+TEST(XmlSyncTest, skip)
+{
+    auto target = std::shared_ptr<Inkscape::XML::Document>(
+        sp_repr_read_buf("<svg><namedview a='1'/><g/></svg>", SP_SVG_NS_URI));
+    auto source = std::shared_ptr<Inkscape::XML::Document>(
+        sp_repr_read_buf("<svg><path/><namedview a='2'/></svg>", SP_SVG_NS_URI));
+    auto is_namedview = [] (Inkscape::XML::Node const &node) { return !g_strcmp0(node.name(), "svg:namedview"); };
+
+    EXPECT_TRUE(Inkscape::XML::sync_children(*target->root(), *source->root(), 100, is_namedview));
+    EXPECT_EQ(target->root()->childCount(), 2u);
+    EXPECT_STREQ(target->root()->firstChild()->name(), "svg:path");
+    EXPECT_STREQ(target->root()->lastChild()->name(), "svg:namedview");
+    EXPECT_STREQ(target->root()->lastChild()->attribute("a"), "1");
+}
+
+/**
+ * Timing of document load, attribute updates and undo replay. Not run by default; use
+ * --gtest_also_run_disabled_tests --gtest_filter=XmlBenchmark.* and compare across builds.
+ */
+TEST(XmlBenchmark, DISABLED_attributes)
+{
+    using clock = std::chrono::steady_clock;
+    auto ms = [] (clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    std::string svg = "<svg xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'><g>";
+    for (int i = 0; i < 100000; i++) {
+        auto n = std::to_string(i);
+        svg += "<rect id='r" + n + "' x='" + n + "' y='1' width='2' height='3' style='fill:red'/>";
+        if (i % 100 == 0) {
+            svg += "<g id='g" + n + "'";
+            for (int j = 0; j < 40; j++) {
+                svg += " data-k" + std::to_string(j) + "='" + n + "'";
+            }
+            svg += "/>";
+        }
+    }
+    svg += "</g></svg>";
+
+    auto start = clock::now();
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(svg, SP_SVG_NS_URI));
+    std::cout << "load: " << ms(start) << " ms" << std::endl;
+
+    auto group = testdoc->root()->firstChild();
+    sp_repr_begin_transaction(testdoc.get());
+    start = clock::now();
+    for (int pass = 0; pass < 5; pass++) {
+        for (auto &child : *group) {
+            child.setAttributeInt("y", pass);
+            child.setAttribute("data-k39", child.attribute("id"));
+        }
+    }
+    std::cout << "attribute set: " << ms(start) << " ms" << std::endl;
+    auto log = sp_repr_commit_undoable(testdoc.get());
+
+    start = clock::now();
+    for (int pass = 0; pass < 5; pass++) {
+        sp_repr_undo_log(log);
+        sp_repr_replay_log(log);
+    }
+    std::cout << "undo replay: " << ms(start) << " ms" << std::endl;
+    sp_repr_free_log(log);
+}
+
 /*
   Local Variables:
   mode:c++
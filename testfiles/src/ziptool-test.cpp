@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test the zlib and built-in deflate code of ziptool against each other.
+ */
+/*
+ * Copyright (C) 2024 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "util/ziptool.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<unsigned char> random_bytes(size_t size, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::vector<unsigned char> result(size);
+    for (auto &b : result) {
+        b = gen() & 0xff;
+    }
+    return result;
+}
+
+std::vector<unsigned char> text_bytes(size_t size)
+{
+    std::string const line = "<draw:frame draw:style-name=\"gr1\" svg:width=\"10cm\" svg:height=\"5cm\"/>\n";
+    std::vector<unsigned char> result;
+    while (result.size() < size) {
+        result.insert(result.end(), line.begin(), line.end());
+    }
+    result.resize(size);
+    return result;
+}
+
+struct Sample
+{
+    std::string name;
+    std::vector<unsigned char> data;
+};
+
+std::vector<Sample> samples()
+{
+    return {
+        {"mimetype", text_bytes(39)},
+        {"content.xml", text_bytes(1024 * 1024)}, // a whole number of 32k deflate windows
+        {"Pictures/image0.png", random_bytes(200 * 1024, 1)},
+        {"Pictures/image1.png", random_bytes(70000, 2)},
+    };
+}
+
+std::vector<DeflateBackend> const backends = {DeflateBackend::Internal, DeflateBackend::Zlib};
+
+class ZipToolTest : public ::testing::Test
+{
+protected:
+    void TearDown() override { setDeflateBackend(_initial); }
+
+    DeflateBackend _initial = getDeflateBackend();
+};
+
+std::vector<unsigned char> write_zip(DeflateBackend backend)
+{
+    setDeflateBackend(backend);
+    ZipFile zf;
+    for (auto const &sample : samples()) {
+        auto ze = zf.newEntry(sample.name, "");
+        ze->setUncompressedData(sample.data);
+        ze->finish();
+    }
+    std::vector<unsigned char> buf;
+    EXPECT_TRUE(zf.writeBuffer(buf));
+    return buf;
+}
+
+} // namespace
+
+TEST_F(ZipToolTest, CrcOfBlockMatchesBytes)
+{
+    auto const data = random_bytes(100000, 3);
+
+    Crc32 bytes;
+    for (auto b : data) {
+        bytes.update(b);
+    }
+
+    Crc32 block;
+    block.update(data.data(), 50000);
+    block.update(data.data() + 50000, data.size() - 50000);
+
+    EXPECT_EQ(bytes.getValue(), block.getValue());
+}
+
+TEST_F(ZipToolTest, ZipRoundTrip)
+{
+    for (auto writer : backends) {
+        auto const buf = write_zip(writer);
+        for (auto reader : backends) {
+            setDeflateBackend(reader);
+            ZipFile zf;
+            ASSERT_TRUE(zf.readBuffer(buf));
+
+            auto const expected = samples();
+            auto &entries = zf.getEntries();
+            ASSERT_EQ(entries.size(), expected.size());
+            for (size_t i = 0; i < entries.size(); i++) {
+                EXPECT_EQ(entries[i]->getFileName(), expected[i].name);
+                EXPECT_EQ(entries[i]->getUncompressedData(), expected[i].data);
+            }
+        }
+    }
+}
+
+TEST_F(ZipToolTest, ZlibCompressesAtLeastAsWell)
+{
+    EXPECT_LE(write_zip(DeflateBackend::Zlib).size(), write_zip(DeflateBackend::Internal).size());
+}
+
+TEST_F(ZipToolTest, WriteFileMatchesWriteBuffer)
+{
+    setDeflateBackend(DeflateBackend::Zlib);
+    ZipFile zf;
+    for (auto const &sample : samples()) {
+        auto ze = zf.newEntry(sample.name, "comment");
+        ze->setUncompressedData(sample.data);
+        ze->finish();
+    }
+    zf.setComment("archive comment");
+
+    std::vector<unsigned char> buf;
+    ASSERT_TRUE(zf.writeBuffer(buf));
+
+    auto const path = (std::filesystem::temp_directory_path() / "ziptool-test.zip").string();
+    ASSERT_TRUE(zf.writeFile(path));
+    std::vector<unsigned char> file;
+    FILE *f = fopen(path.c_str(), "rb");
+    ASSERT_TRUE(f);
+    for (int ch; (ch = fgetc(f)) >= 0;) {
+        file.push_back(ch);
+    }
+    fclose(f);
+    remove(path.c_str());
+
+    EXPECT_EQ(file, buf);
+}
+
+TEST_F(ZipToolTest, GzipRoundTrip)
+{
+    auto const data = text_bytes(500000);
+    for (auto writer : backends) {
+        setDeflateBackend(writer);
+        GzipFile out;
+        out.setData(data);
+        out.setFileName("drawing.svg");
+        std::vector<unsigned char> buf;
+        ASSERT_TRUE(out.writeBuffer(buf));
+
+        for (auto reader : backends) {
+            setDeflateBackend(reader);
+            GzipFile in;
+            ASSERT_TRUE(in.readBuffer(buf));
+            EXPECT_EQ(in.getData(), data);
+            EXPECT_EQ(in.getFileName(), "drawing.svg");
+        }
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :